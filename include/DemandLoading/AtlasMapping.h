@@ -0,0 +1,48 @@
+#pragma once
+
+#include <hip/hip_runtime.h>
+#include <cmath>
+#include <cstdint>
+
+namespace hip_demand {
+
+// Where a texture packed into an atlas page lives (see LoaderOptions::atlasMaxTextureSize).
+// The page is sampled with clamp addressing; the texture's own address modes are
+// applied to its coordinates before they are mapped into its rectangle. The gutter
+// around the rectangle holds the texels those modes would fetch, so bilinear
+// filtering at the edges and the page's mip levels match a standalone texture.
+struct AtlasMapping {
+    float scaleU;           // Rectangle size in page UV; 0 = not in an atlas
+    float scaleV;
+    float offsetU;          // Page UV of the rectangle's corner
+    float offsetV;
+    float borderU;          // Border mode: how far outside [0, 1] the transparent gutter reaches
+    float borderV;
+    uint32_t addressModes;  // hipTextureAddressMode for u in bits 0-7, v in bits 8-15
+};
+
+// Fold a normalized coordinate into [0, 1] the way the address mode would.
+// Border coordinates are clamped into the gutter, which is transparent black.
+__host__ __device__ inline float applyAtlasAddressMode(float c, uint32_t mode, float border) {
+    if (mode == hipAddressModeWrap) {
+        return c - floorf(c);
+    }
+    if (mode == hipAddressModeMirror) {
+        float t = c - 2.0f * floorf(c * 0.5f);
+        return t > 1.0f ? 2.0f - t : t;
+    }
+    if (mode == hipAddressModeBorder) {
+        return fminf(fmaxf(c, -border), 1.0f + border);
+    }
+    return fminf(fmaxf(c, 0.0f), 1.0f);
+}
+
+// Texture UV to page UV; returns false (coordinates untouched) for textures outside an atlas
+__host__ __device__ inline bool mapToAtlas(const AtlasMapping& m, float& u, float& v) {
+    if (m.scaleU == 0.0f) return false;
+    u = m.offsetU + applyAtlasAddressMode(u, m.addressModes & 0xffu, m.borderU) * m.scaleU;
+    v = m.offsetV + applyAtlasAddressMode(v, (m.addressModes >> 8) & 0xffu, m.borderV) * m.scaleV;
+    return true;
+}
+
+} // namespace hip_demand
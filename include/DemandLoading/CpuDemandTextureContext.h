@@ -0,0 +1,49 @@
+#pragma once
+
+#include "DemandLoading/AtlasMapping.h"
+#include <hip/hip_runtime.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hip_demand {
+
+// One level of a host-resident texture: RGBA8, rows tightly packed
+struct CpuMipLevel {
+    const uint8_t* texels = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+// Host-resident texture built by a loader with TextureBackend::Cpu.
+// Sampling state mirrors the hipTextureDesc the GPU backend would create.
+struct CpuTexture {
+    std::vector<CpuMipLevel> levels;      // Level 0 first
+    std::unique_ptr<uint8_t[]> storage;   // Backs all levels
+    hipTextureAddressMode addressMode[2] = {hipAddressModeWrap, hipAddressModeWrap};
+    hipTextureFilterMode filterMode = hipFilterModeLinear;
+    hipTextureFilterMode mipmapFilterMode = hipFilterModeLinear;
+    bool normalizedCoords = true;
+    bool sRGB = false;
+};
+
+// Host counterpart of DeviceContext, passed to CPU render threads.
+// Valid from launchPrepare() until processRequests(); any number of threads may
+// sample concurrently in between. Requests go into a lock-free queue and are
+// deduplicated per launch, so each missing texture is queued once.
+struct CpuDemandTextureContext {
+    const uint32_t* residentFlags = nullptr;     // Bit per texture
+    const uint32_t* residentSummary = nullptr;   // Bit per residentFlags word, set if the word is nonzero
+    const CpuTexture* const* textures = nullptr;
+    uint32_t* requests = nullptr;                // Request queue
+    std::atomic<uint32_t>* requestCount = nullptr;
+    std::atomic<uint32_t>* requestOverflow = nullptr;
+    std::atomic<uint32_t>* requestedFlags = nullptr;  // Bit per texture queued this launch
+    std::atomic<uint32_t>* usedFlags = nullptr;       // Bit set when a resident texture is sampled (null = not tracked)
+    const AtlasMapping* atlas = nullptr;              // Per texture: rectangle in its atlas page (null = atlas packing off)
+    uint32_t maxTextures = 0;
+    uint32_t maxRequests = 0;
+};
+
+} // namespace hip_demand
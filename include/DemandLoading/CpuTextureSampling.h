@@ -0,0 +1,120 @@
+#pragma once
+
+#include "DemandLoading/CpuDemandTextureContext.h"
+#include <hip/hip_runtime.h>
+
+namespace hip_demand {
+
+// Host-side texture sampling with the same residency and request semantics as
+// the device functions in TextureSampling.h. Filtering follows the texture's
+// descriptor: point or bilinear within a level, point or linear between levels,
+// wrap/clamp/mirror/border addressing, sRGB decode before filtering.
+
+inline bool isTextureResident(const CpuDemandTextureContext& ctx, uint32_t texId) {
+    if (texId >= ctx.maxTextures || !ctx.residentFlags) return false;
+    const uint32_t wordIdx = texId >> 5;
+    const uint32_t bitIdx  = texId & 31u;
+    if (ctx.residentSummary && (ctx.residentSummary[wordIdx >> 5] & (1u << (wordIdx & 31u))) == 0) return false;
+    return (ctx.residentFlags[wordIdx] & (1u << bitIdx)) != 0;
+}
+
+// Queue a texture request. The per-launch requested bit lets only the first
+// thread that misses a texture take a queue slot.
+inline void recordTextureRequest(const CpuDemandTextureContext& ctx, uint32_t texId) {
+    if (!ctx.requestCount || ctx.requestOverflow->load(std::memory_order_relaxed) != 0u) return;
+
+    const uint32_t bit = 1u << (texId & 31u);
+    std::atomic<uint32_t>& word = ctx.requestedFlags[texId >> 5];
+    if ((word.load(std::memory_order_relaxed) & bit) != 0u) return;
+    if ((word.fetch_or(bit, std::memory_order_relaxed) & bit) != 0u) return;
+
+    const uint32_t idx = ctx.requestCount->fetch_add(1u, std::memory_order_relaxed);
+    if (idx < ctx.maxRequests) {
+        ctx.requests[idx] = texId;
+    } else {
+        ctx.requestOverflow->store(1u, std::memory_order_relaxed);
+    }
+}
+
+inline void markTextureUsed(const CpuDemandTextureContext& ctx, uint32_t texId) {
+    if (!ctx.usedFlags) return;
+    std::atomic<uint32_t>& word = ctx.usedFlags[texId >> 5];
+    const uint32_t bit = 1u << (texId & 31u);
+    if ((word.load(std::memory_order_relaxed) & bit) == 0u) {
+        word.fetch_or(bit, std::memory_order_relaxed);
+    }
+}
+
+// Atlas members sample their rectangle of the shared page; gradients scale with it
+inline void remapAtlasCoords(const CpuDemandTextureContext& ctx, uint32_t texId, float& u, float& v) {
+    if (ctx.atlas) mapToAtlas(ctx.atlas[texId], u, v);
+}
+
+inline void remapAtlasCoords(const CpuDemandTextureContext& ctx, uint32_t texId,
+                             float& u, float& v, float2& ddx, float2& ddy) {
+    if (ctx.atlas && mapToAtlas(ctx.atlas[texId], u, v)) {
+        const AtlasMapping& m = ctx.atlas[texId];
+        ddx.x *= m.scaleU; ddx.y *= m.scaleV;
+        ddy.x *= m.scaleU; ddy.y *= m.scaleV;
+    }
+}
+
+// Filtered lookup at a fractional mip level (clamped to the available levels)
+float4 sampleCpuTexture(const CpuTexture& tex, float u, float v, float lod);
+
+// Mip level selected by screen-space derivatives of the texture coordinates,
+// matching the GPU: log2 of the longer footprint axis in level-0 texels
+float computeCpuTextureLod(const CpuTexture& tex, float2 ddx, float2 ddy);
+
+inline bool tex2D(const CpuDemandTextureContext& ctx,
+                  uint32_t texId,
+                  float u, float v,
+                  float4& result,
+                  float4 defaultColor = make_float4(1.0f, 0.0f, 1.0f, 1.0f)) {
+    if (!isTextureResident(ctx, texId)) {
+        if (texId < ctx.maxTextures) recordTextureRequest(ctx, texId);
+        result = defaultColor;
+        return false;
+    }
+    markTextureUsed(ctx, texId);
+    remapAtlasCoords(ctx, texId, u, v);
+    result = sampleCpuTexture(*ctx.textures[texId], u, v, 0.0f);
+    return true;
+}
+
+inline bool tex2DGrad(const CpuDemandTextureContext& ctx,
+                      uint32_t texId,
+                      float u, float v,
+                      float2 ddx, float2 ddy,
+                      float4& result,
+                      float4 defaultColor = make_float4(1.0f, 0.0f, 1.0f, 1.0f)) {
+    if (!isTextureResident(ctx, texId)) {
+        if (texId < ctx.maxTextures) recordTextureRequest(ctx, texId);
+        result = defaultColor;
+        return false;
+    }
+    markTextureUsed(ctx, texId);
+    remapAtlasCoords(ctx, texId, u, v, ddx, ddy);
+    const CpuTexture& tex = *ctx.textures[texId];
+    result = sampleCpuTexture(tex, u, v, computeCpuTextureLod(tex, ddx, ddy));
+    return true;
+}
+
+inline bool tex2DLod(const CpuDemandTextureContext& ctx,
+                     uint32_t texId,
+                     float u, float v,
+                     float lod,
+                     float4& result,
+                     float4 defaultColor = make_float4(1.0f, 0.0f, 1.0f, 1.0f)) {
+    if (!isTextureResident(ctx, texId)) {
+        if (texId < ctx.maxTextures) recordTextureRequest(ctx, texId);
+        result = defaultColor;
+        return false;
+    }
+    markTextureUsed(ctx, texId);
+    remapAtlasCoords(ctx, texId, u, v);
+    result = sampleCpuTexture(*ctx.textures[texId], u, v, lod);
+    return true;
+}
+
+} // namespace hip_demand
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "DemandLoading/CpuDemandTextureContext.h"
 #include "DemandLoading/DeviceContext.h"
 #include <hip/hip_runtime.h>
 #include <string>
@@ -27,6 +28,13 @@ const char* getErrorString(LoaderError error);
 class TextureRegistry;
 class RequestBuffer;
 class ImageReader;
+class MemoryArbiter;
+
+// Where resident textures live and how they are sampled
+enum class TextureBackend {
+    Hip,  // HIP texture objects; sample with TextureSampling.h through getDeviceContext()
+    Cpu   // Host mip chains; sample with CpuTextureSampling.h through getCpuContext(). Needs no GPU.
+};
 
 // Configuration options
 struct LoaderOptions {
@@ -34,7 +42,75 @@ struct LoaderOptions {
     size_t maxTextures = 4096;
     size_t maxRequestsPerLaunch = 1024;
     bool enableEviction = true;
-    unsigned int maxThreads = 0;  // 0 = auto
+    unsigned int maxThreads = 0;  // Load worker threads, 0 = auto
+    // Sampling marks resident textures used: traces record hits as well as misses (needed by
+    // hip_demand_mrc), and eviction order follows the last frame a texture was sampled instead
+    // of the frame it loaded. Costs an atomic per first sample and one small download per frame.
+    bool trackUsage = false;
+    TextureBackend backend = TextureBackend::Hip;
+    // Request list, count and overflow flag live in host-mapped, coherent pinned memory that the
+    // kernel writes directly; processRequests reads them after one stream sync instead of copying
+    // them back in two synchronized rounds. Falls back to copies if the allocation fails.
+    bool mappedFeedback = false;
+    // Files whose reader decodes from memory (stb formats) are read ahead asynchronously, through
+    // io_uring on Linux when available, otherwise reader threads. A file's bytes are held until it
+    // is decoded, so at most ioQueueDepth files are read or waiting for a decode at once, and no
+    // read starts while the files held exceed readAheadBytes. 0 = each decoder reads its own file.
+    unsigned int ioQueueDepth = 64;
+    size_t readAheadBytes = 128ULL * 1024 * 1024;
+    bool useIoUring = true;
+    // A texture whose load failed transiently (out of memory, HIP error) is not retried for
+    // retryBackoffFrames frames, doubling with each consecutive failure up to maxRetryBackoffFrames.
+    // Missing or undecodable files fail permanently until retryFailedTextures().
+    uint32_t retryBackoffFrames = 1;
+    uint32_t maxRetryBackoffFrames = 256;
+    // Atlas packing: textures no larger than atlasMaxTextureSize in either dimension share
+    // atlasPageSize pages, which load and evict as a unit (0 = off). Sampling remaps their
+    // coordinates (see AtlasMapping.h). Each texture keeps atlasGutter texels of padding per
+    // side, and pages keep log2(atlasGutter) + 1 mip levels, as many as the gutter keeps
+    // free of bleeding. Only mipmapped, normalized-coordinate textures without a maxMipLevel
+    // are packed; pages group textures with the same filtering, sRGB setting and budget group.
+    unsigned int atlasMaxTextureSize = 0;
+    unsigned int atlasPageSize = 2048;
+    unsigned int atlasGutter = 4;
+    // Background eviction: when usage after processRequests() is above evictionHighWatermark *
+    // maxTextureMemory, a pool task evicts least recently used textures down to
+    // evictionLowWatermark * maxTextureMemory (0 = low mark equals the high mark), overlapping the
+    // next launch (CPU backend: launchPrepare() waits for it). 0 = off; eviction then only happens
+    // when a batch does not fit.
+    // idleEvictionFrames > 0 also evicts textures not sampled for that many launches, even under
+    // budget. It turns trackUsage on, since idleness is measured from the last sample.
+    float evictionHighWatermark = 0.0f;
+    float evictionLowWatermark = 0.0f;
+    uint32_t idleEvictionFrames = 0;
+    // Thrash detection: loading a texture evicted at most thrashWindowFrames launches earlier is
+    // a reload. When reloads are more than thrashReloadThreshold of the loads in a window of that
+    // many launches, later loads drop one more mip level (up to maxThrashMipBias) so the working
+    // set fits; the bias relaxes a level at a time once reloads stop and the larger textures
+    // would fit again. 0 = off. Only normalized-coordinate textures outside atlas pages shrink.
+    // Turns trackUsage on, which finds the sampled resident textures to reload at a changed bias.
+    uint32_t thrashWindowFrames = 0;
+    float thrashReloadThreshold = 0.25f;
+    uint32_t maxThrashMipBias = 2;
+    // Resolution cap for textures whose TextureDesc sets none (0 = no cap); see TextureDesc::maxResolution
+    unsigned int maxTextureResolution = 0;
+    unsigned int textureLodBias = 0;
+    // Cross-process texel cache: loaders on one node that use the same name share decoded
+    // images through a POSIX shared memory segment of sharedCacheBytes, created by the first
+    // of them, so each file level is decoded once per node. A load that finds another process
+    // decoding the same image waits for it, for at most sharedCacheClaimTimeoutMs. Empty = off.
+    // The creator reserves all sharedCacheBytes in /dev/shm up front. The segment outlives
+    // the processes so the next job starts warm; remove /dev/shm/<name> to free it, or set
+    // sharedCacheRemoveWhenUnused to unlink it when the last process using it exits cleanly.
+    std::string sharedCacheName;
+    size_t sharedCacheBytes = 1ULL << 30;
+    uint32_t sharedCacheClaimTimeoutMs = 60000;
+    bool sharedCacheRemoveWhenUnused = false;
+    // Loaders sharing a memoryArbiter split its pool by demand and priority (higher first; see
+    // MemoryArbiter.h). This loader's budget is then its share, capped by maxTextureMemory
+    // unless that is 0. Null = maxTextureMemory alone.
+    std::shared_ptr<MemoryArbiter> memoryArbiter;
+    int arbiterPriority = 0;
 };
 
 // Texture descriptor
@@ -46,6 +122,13 @@ struct TextureDesc {
     bool sRGB = false;
     bool generateMipmaps = true;  // Generate mipmaps for better quality
     unsigned int maxMipLevel = 0;  // 0 = auto-generate all levels
+    uint32_t budgetGroup = 0;     // From createBudgetGroup(); 0 = default group
+    // Top mip levels never loaded: the texture loads from level lodBias, or from the first
+    // level no larger than maxResolution on its longer side if that skips more. 0 = use
+    // LoaderOptions::textureLodBias / maxTextureResolution. Stored mips are read directly;
+    // otherwise the reader decimates. Normalized-coordinate textures only.
+    unsigned int maxResolution = 0;
+    unsigned int lodBias = 0;
 };
 
 inline bool operator==(const TextureDesc& a, const TextureDesc& b) {
@@ -56,7 +139,10 @@ inline bool operator==(const TextureDesc& a, const TextureDesc& b) {
             a.normalizedCoords == b.normalizedCoords &&
             a.sRGB == b.sRGB &&
             a.generateMipmaps == b.generateMipmaps &&
-            a.maxMipLevel == b.maxMipLevel);
+            a.maxMipLevel == b.maxMipLevel &&
+            a.budgetGroup == b.budgetGroup &&
+            a.maxResolution == b.maxResolution &&
+            a.lodBias == b.lodBias);
 }
 
 // Texture information returned after creation
@@ -69,6 +155,97 @@ struct TextureHandle {
     LoaderError error = LoaderError::Success;
 };
 
+// Size classes for latency statistics, by estimated RGBA8 bytes with mipmaps
+enum class TextureSizeClass {
+    Small = 0,   // Under 256 KB (up to ~256x256)
+    Medium,      // Under 4 MB (up to ~1K)
+    Large,       // Under 64 MB (up to ~4K)
+    Huge         // 64 MB and up
+};
+constexpr size_t kTextureSizeClassCount = 4;
+
+TextureSizeClass getTextureSizeClass(size_t estimatedBytes);
+const char* getTextureSizeClassName(TextureSizeClass sizeClass);
+
+// Percentiles of a latency histogram; values are bucket bounds within 12.5% of the exact sample
+struct LatencyPercentiles {
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// Miss-to-resident latency of textures that missed and then became resident.
+// frames counts launches rendered with the fallback color (1 = resident by the next launch);
+// millis is wall time from processRequests() seeing the miss to the texture being published.
+struct LatencyStats {
+    uint64_t count = 0;
+    LatencyPercentiles frames;
+    LatencyPercentiles millis;
+};
+
+struct LatencyReport {
+    LatencyStats all;
+    LatencyStats bySizeClass[kTextureSizeClassCount];  // Indexed by TextureSizeClass
+    uint64_t pending = 0;  // Textures missed and not resident yet (loading, failed or skipped)
+};
+
+// Timeline of one texture's latest miss. Frames are launchPrepare() counts.
+struct TextureLatency {
+    bool pending = false;     // Missed, not resident yet; the fields below describe the open miss
+    bool measured = false;    // The latest miss has completed; residentFrame and the durations are set
+    uint32_t missFrame = 0;
+    uint32_t loadStartFrame = 0;  // 0 if no load has started for this miss
+    uint32_t residentFrame = 0;
+    uint32_t frames = 0;          // Launches rendered with the fallback color
+    double queueMillis = 0.0;     // Miss to load start
+    double totalMillis = 0.0;     // Miss to resident
+};
+
+// Atlas packing (LoaderOptions::atlasMaxTextureSize). Areas are level-0 texels;
+// pages count the bounding box of what has been packed into them.
+struct AtlasStats {
+    size_t pageCount = 0;
+    size_t residentPageCount = 0;
+    size_t textureCount = 0;         // Textures packed into pages
+    size_t residentBytes = 0;        // Memory of resident pages, mip levels included
+    double packingEfficiency = 0.0;  // Texture texels / page texels
+    double gutterOverhead = 0.0;     // Gutter and alignment texels per texture texel
+    double freeSpace = 0.0;          // Fraction of page texels not covered by any rectangle
+};
+
+// Budget groups split maxTextureMemory between kinds of textures (see createBudgetGroup).
+// Group 0, "default", always exists and has no limits of its own.
+constexpr uint32_t kMaxBudgetGroups = 256;
+constexpr uint32_t kInvalidBudgetGroup = UINT32_MAX;
+
+struct BudgetGroupStats {
+    std::string name;
+    size_t minBytes = 0;
+    size_t maxBytes = 0;          // 0 = no cap
+    size_t memoryUsage = 0;
+    size_t residentCount = 0;
+    uint64_t evictionCount = 0;   // Textures of the group evicted to make room
+};
+
+// Thrash detection and the mip bias it applies (see LoaderOptions::thrashWindowFrames)
+struct ThrashStats {
+    uint32_t mipBias = 0;          // Mip levels new loads currently drop
+    uint64_t loads = 0;            // Loads of standalone textures requested by kernels
+    uint64_t reloads = 0;          // Of those, loads within thrashWindowFrames of an eviction
+    float lastReloadRate = 0.0f;   // reloads / loads over the last completed window
+};
+
+// Cross-process texel cache traffic of this loader (see LoaderOptions::sharedCacheName)
+struct SharedCacheStats {
+    bool enabled = false;      // The segment was opened
+    size_t segmentBytes = 0;
+    uint64_t hits = 0;         // Images copied from the cache instead of decoded
+    uint64_t publishes = 0;    // Images decoded here and added to the cache
+    uint64_t waits = 0;        // Loads that waited for another process's decode
+    uint64_t bypasses = 0;     // Decoded without caching: no free index slot, or too large
+};
+
 class DemandTextureLoader {
 public:
     explicit DemandTextureLoader(const LoaderOptions& options = LoaderOptions());
@@ -82,6 +259,13 @@ public:
     TextureHandle createTexture(const std::string& filename, 
                                 const TextureDesc& desc = TextureDesc());
     
+    // Create one texture per entry of a texture pack built with hip_demand_pack.
+    // The pack is opened and mapped once; entries load from the mapping without
+    // further opens. Each texture's filename is "pack#entry". Returns an empty
+    // vector (see getLastError()) if the pack cannot be opened.
+    std::vector<TextureHandle> createTexturesFromPack(const std::string& packPath,
+                                                      const TextureDesc& desc = TextureDesc());
+
     // Create a texture from memory
     TextureHandle createTextureFromMemory(const void* data, 
                                          int width, int height, int channels,
@@ -93,23 +277,95 @@ public:
     // Get device context to pass to kernel
     DeviceContext getDeviceContext() const;
 
+    // Get host context to pass to CPU render threads (TextureBackend::Cpu; empty otherwise).
+    // Render between launchPrepare() and processRequests(), the same as a kernel launch.
+    CpuDemandTextureContext getCpuContext() const;
+
     // Process texture requests after kernel launch
     // Returns number of textures loaded
     size_t processRequests(hipStream_t stream = 0);
 
     // Statistics
     size_t getResidentTextureCount() const;
+    std::vector<uint32_t> getResidentTextureIds() const;  // Ascending; cost scales with resident count
     size_t getTotalTextureMemory() const;
+    // Evicted bytes still allocated because a launch in flight may sample them; freed by the
+    // processRequests() that sees that launch finish. Not counted in getTotalTextureMemory().
+    size_t getRetiredTextureMemory() const;
     size_t getRequestCount() const;
     bool hadRequestOverflow() const;
     LoaderError getLastError() const;
 
+    // Failed loads: requests for a texture that failed permanently or is backing off are
+    // skipped without touching the file and counted as suppressed retries
+    size_t getFailedTextureCount() const;
+    uint64_t getSuppressedRetryCount() const;
+    LoaderError getTextureError(uint32_t textureId) const;  // Last load error; Success once loaded
+    void retryFailedTextures();  // Forget all failures, e.g. after assets are fixed or memory is freed
+
+    // Request-to-residency latency (see LatencyStats). Histograms accumulate from loader
+    // creation or the last resetLatencyStats(); completed misses are also written to the trace.
+    LatencyReport getLatencyReport() const;
+    TextureLatency getTextureLatency(uint32_t textureId) const;
+    void resetLatencyStats();
+
+    // Atlas pages and how well they are packed
+    AtlasStats getAtlasStats() const;
+
+    // Budget groups. Loads of a group over its maxBytes evict the group's own least
+    // recently used textures; the global budget then evicts from groups over their
+    // maximum first and never takes a group below minBytes to make room for another
+    // group. Returns the id for TextureDesc::budgetGroup, or kInvalidBudgetGroup
+    // (InvalidParameter) if the name is taken, minBytes > maxBytes or there are
+    // kMaxBudgetGroups already. Lowered limits are enforced at the next eviction.
+    uint32_t createBudgetGroup(const std::string& name, size_t minBytes, size_t maxBytes = 0);
+    bool setBudgetGroupLimits(uint32_t group, size_t minBytes, size_t maxBytes);
+    std::vector<BudgetGroupStats> getBudgetGroupStats() const;  // Indexed by group id
+
+    // Pinning. A pinned texture is never evicted to make room, so kernels that are about
+    // to sample it do not force a reload; pinning an atlas member pins its page. Pins nest:
+    // each pinTexture(id) needs an unpinTexture(id). pinTexture(id, frames) instead holds
+    // the texture for the next `frames` launches and expires on its own. Pinned textures
+    // that are not resident are loaded by the next processRequests() without waiting for
+    // a request. Pinned memory stays charged to the budget and its group, so unpinned
+    // textures compete for what is left. unloadTexture() and unloadAll() ignore pins.
+    bool pinTexture(uint32_t textureId, uint32_t frames = 0);
+    bool unpinTexture(uint32_t textureId);  // false if the texture holds no nested pin
+    bool isTexturePinned(uint32_t textureId) const;
+    size_t getPinnedTextureCount() const;
+    size_t getPinnedTextureMemory() const;  // Resident pinned bytes, atlas pages counted once
+
+    // Thrash detection. A texture loaded under a mip bias is smaller by that many levels:
+    // tex2D and tex2DGrad sample it as usual, a tex2DLod level counts from its new level 0.
+    // Once the bias relaxes, textures sampled in a frame are reloaded at the lower bias.
+    ThrashStats getThrashStats() const;
+    // Levels the resident copy dropped, resolution cap (TextureDesc::maxResolution) included
+    uint32_t getTextureMipBias(uint32_t textureId) const;
+
+    SharedCacheStats getSharedCacheStats() const;
+
     // Eviction control
     void enableEviction(bool enable);
     void setMaxTextureMemory(size_t bytes);
     size_t getMaxTextureMemory() const;
+    // Budget eviction works to: maxTextureMemory, or the arbiter's share (0 = unlimited)
+    size_t getMemoryBudget() const;
+
+    // Record a compact binary trace of requests, loads and evictions for offline
+    // replay with hip_demand_replay (see RequestTrace.h). Restarting replaces the file.
+    bool startTrace(const std::string& path);
+    void stopTrace();
+
+    // Warm start: save the resident set, then bulk-load it in a later session.
+    // Entries are matched to textures created so far by filename; memory textures are skipped.
+    bool saveResidencySnapshot(const std::string& path);
+    // Loads snapshot textures hottest first, in parallel, without exceeding maxTextureMemory
+    // or a budget group's maxBytes.
+    // Call after createTexture() and before the first launch. Returns number of textures loaded.
+    size_t warmStart(const std::string& path);
 
-    // Utility
+    // Utility. Unloading a texture packed into an atlas unloads its whole page. Between
+    // launchPrepare() and processRequests() the storage is retired, not freed (see above).
     void unloadTexture(uint32_t textureId);
     void unloadAll();
 
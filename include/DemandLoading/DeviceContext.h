@@ -1,5 +1,6 @@
 #pragma once
 
+#include "DemandLoading/AtlasMapping.h"
 #include <hip/hip_runtime.h>
 #include <cstdint>
 
@@ -9,10 +10,13 @@ namespace hip_demand {
 // This structure contains GPU-accessible data for texture sampling
 struct DeviceContext {
     uint32_t* residentFlags;      // Bit flags for texture residency
+    uint32_t* residentSummary = nullptr;  // Bit per residentFlags word, set if the word is nonzero (null = not used)
     hipTextureObject_t* textures; // Array of texture objects
     uint32_t* requests;           // Request buffer
     uint32_t* requestCount;       // Atomic counter for requests
     uint32_t* requestOverflow;    // Flag set when request buffer overflows
+    uint32_t* usedFlags = nullptr;        // Bit set when a resident texture is sampled (null = not tracked)
+    const AtlasMapping* atlas = nullptr;  // Per texture: rectangle in its atlas page (null = atlas packing off)
     uint32_t maxTextures;
     uint32_t maxRequests;
 };
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hip_demand {
+
+struct MemoryArbiterOptions {
+    size_t totalBytes = 0;  // Pool shared by the registered loaders; 0 = derive it from device memory
+    // Derive the pool from hipMemGetInfo: free device memory plus what the loaders already
+    // hold, less safetyMarginBytes, and no more than totalBytes if that is set too. The
+    // current device is queried at most every deviceQueryIntervalMs.
+    bool deriveFromFreeMemory = false;
+    size_t safetyMarginBytes = 256ULL * 1024 * 1024;
+    uint32_t deviceQueryIntervalMs = 100;
+    // Every loader keeps up to this much of its demand whatever its priority, pool permitting
+    size_t minLoaderBytes = 64ULL * 1024 * 1024;
+};
+
+struct ArbiterLoaderStats {
+    uint32_t id = 0;                // Registration order
+    int priority = 0;
+    size_t usage = 0;               // Resident bytes, with the batch then loading, at the last report
+    size_t demand = 0;              // Working set the budget is split by
+    size_t budget = 0;
+    uint64_t evictionRequests = 0;  // Times the budget was lowered below usage
+};
+
+// Splits one memory pool between the loaders registered with it (LoaderOptions::memoryArbiter).
+// Each loader reports its resident bytes and demand, the bytes of the textures it sampled
+// recently (loaded recently without trackUsage) plus those it is about to load, once per
+// processRequests(). Every report rebalances: priorities are served highest first, each
+// getting its whole demand while the pool lasts; the priority the pool runs out in splits
+// what is left in proportion to demand; pool left over once all demand is met is shared
+// evenly. A loader whose budget drops below its usage evicts down to it in the background
+// right away, or at its next launchPrepare() on the CPU backend, so a high priority loader
+// that needs memory takes it from lower priority ones within a frame, idle or not.
+class MemoryArbiter {
+public:
+    explicit MemoryArbiter(const MemoryArbiterOptions& options = MemoryArbiterOptions());
+    ~MemoryArbiter();
+
+    MemoryArbiter(const MemoryArbiter&) = delete;
+    MemoryArbiter& operator=(const MemoryArbiter&) = delete;
+
+    size_t getTotalBudget() const;  // Pool split at the last rebalance
+    std::vector<ArbiterLoaderStats> getLoaderStats() const;
+
+    // Loader side. budgetChanged(budget, evict) is called whenever another member's report,
+    // join or leave changes a member's budget, on that caller's thread and without the
+    // arbiter lock held, so it must not block; evict is set when the budget is below the
+    // member's usage. A member's own report returns its budget instead.
+    struct Member;
+    using BudgetCallback = std::function<void(size_t budget, bool evict)>;
+    std::shared_ptr<Member> join(int priority, BudgetCallback budgetChanged);
+    void leave(const std::shared_ptr<Member>& member);  // No callback runs once this returns
+    size_t report(Member& member, size_t usage, size_t demand);
+
+private:
+    size_t poolBytes();
+    void rebalance(std::vector<std::shared_ptr<Member>>& notices, const Member* reporter);
+    void notify(const std::vector<std::shared_ptr<Member>>& notices);
+
+    MemoryArbiterOptions options_;
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<Member>> members_;
+    uint32_t nextId_ = 0;
+    size_t totalBudget_ = 0;
+    size_t deviceBytes_ = 0;  // Free device memory plus member usage at the last query
+    std::chrono::steady_clock::time_point lastDeviceQuery_;
+    bool deviceQueried_ = false;
+};
+
+} // namespace hip_demand
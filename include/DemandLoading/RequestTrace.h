@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace hip_demand {
+
+// Compact binary trace of loader activity, recorded with
+// DemandTextureLoader::startTrace() and replayed offline by hip_demand_replay.
+//
+// File layout: 8-byte magic "HDTRACE\0", then a version varint, then records.
+// Each record is a type byte followed by LEB128 varints (strings are a
+// length varint plus bytes), so typical records take a few bytes.
+enum class TraceEventType : uint8_t {
+    Texture = 1,   // Texture created: id, size, estimated bytes, filename
+    Requests = 2,  // Unique texture ids sampled (if usage is tracked) or requested in one frame
+    Load = 3,      // Load finished: id, device bytes, duration, success
+    Evict = 4,     // Texture left the device: id, bytes freed
+    Budget = 5,    // maxTextureMemory at trace start and whenever it changes
+    Latency = 6    // Missed texture became resident: id, estimated bytes, miss frame, queue and total time
+};
+
+struct TraceEvent {
+    TraceEventType type = TraceEventType::Requests;
+    uint32_t frame = 0;
+    uint32_t textureId = 0;
+    uint64_t bytes = 0;       // Texture/Latency: estimated bytes; Load/Evict: device bytes; Budget: budget
+    uint32_t micros = 0;      // Load: read, decode and upload time; Latency: miss to resident
+    uint32_t missFrame = 0;   // Latency only; frame is the frame the texture became resident
+    uint32_t queueMicros = 0; // Latency only: miss to load start
+    uint32_t width = 0;       // Texture only
+    uint32_t height = 0;      // Texture only
+    uint32_t channels = 0;    // Texture only
+    bool success = true;      // Load only
+    std::string filename;     // Texture only; empty for memory textures
+    std::vector<uint32_t> textureIds;  // Requests only
+};
+
+// Appends records to a trace file. Not thread-safe; the loader serializes calls.
+class RequestTraceWriter {
+public:
+    RequestTraceWriter() = default;
+    ~RequestTraceWriter();
+
+    RequestTraceWriter(const RequestTraceWriter&) = delete;
+    RequestTraceWriter& operator=(const RequestTraceWriter&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return out_.is_open(); }
+    bool good() const { return out_.good(); }
+
+    void writeTexture(uint32_t frame, uint32_t textureId, uint32_t width, uint32_t height,
+                      uint32_t channels, uint64_t estimatedBytes, const std::string& filename);
+    void writeRequests(uint32_t frame, const std::vector<uint32_t>& textureIds);
+    void writeLoad(uint32_t frame, uint32_t textureId, uint64_t bytes, uint32_t micros, bool success);
+    void writeEvict(uint32_t frame, uint32_t textureId, uint64_t bytes);
+    void writeBudget(uint32_t frame, uint64_t maxTextureMemory);
+    void writeLatency(uint32_t frame, uint32_t textureId, uint64_t estimatedBytes, uint32_t missFrame,
+                      uint32_t queueMicros, uint32_t totalMicros);
+
+    uint64_t getEventCount() const { return eventCount_; }
+
+private:
+    void putVarint(uint64_t value);
+    void putString(const std::string& s);
+
+    std::ofstream out_;
+    uint64_t eventCount_ = 0;
+};
+
+// Reads a trace file record by record.
+class RequestTraceReader {
+public:
+    // Returns false if the file is missing or not a trace of a supported version.
+    // Version 1 traces (no Latency records) are still read.
+    bool open(const std::string& path);
+
+    // Reads the next record; returns false at end of file or on a truncated record.
+    bool next(TraceEvent& event);
+
+    // True if reading stopped on a malformed record rather than end of file.
+    bool hadError() const { return error_; }
+
+private:
+    bool getVarint(uint64_t& value);
+    bool getString(std::string& s);
+
+    std::ifstream in_;
+    bool error_ = false;
+};
+
+} // namespace hip_demand
@@ -13,10 +13,13 @@ namespace hip_demand {
 // Device-side texture sampling functions
 // These check residency and record requests if needed
 
+// The summary word (1024 textures) is checked first: with sparse residency it is
+// usually zero and stays in cache, so misses skip the larger flag array.
 __device__ __forceinline__ bool isTextureResident(const DeviceContext& ctx, uint32_t texId) {
     if (texId >= ctx.maxTextures) return false;
     const uint32_t wordIdx = texId >> 5;   // divide by 32
     const uint32_t bitIdx  = texId & 31u;  // modulo 32
+    if (ctx.residentSummary && (ctx.residentSummary[wordIdx >> 5] & (1u << (wordIdx & 31u))) == 0) return false;
     return (ctx.residentFlags[wordIdx] & (1u << bitIdx)) != 0;
 }
 
@@ -50,6 +53,31 @@ __device__ __forceinline__ void recordTextureRequest(const DeviceContext& ctx, u
 #endif
 }
 
+// Mark a resident texture as sampled this launch. Reading the word first means
+// only the first sampler of each texture pays for the atomic.
+__device__ __forceinline__ void markTextureUsed(const DeviceContext& ctx, uint32_t texId) {
+    if (!ctx.usedFlags) return;
+    uint32_t* word = &ctx.usedFlags[texId >> 5];
+    const uint32_t bit = 1u << (texId & 31u);
+    if ((*word & bit) == 0u) {
+        atomicOr(word, bit);
+    }
+}
+
+// Atlas members sample their rectangle of the shared page; gradients scale with it
+__device__ __forceinline__ void remapAtlasCoords(const DeviceContext& ctx, uint32_t texId, float& u, float& v) {
+    if (ctx.atlas) mapToAtlas(ctx.atlas[texId], u, v);
+}
+
+__device__ __forceinline__ void remapAtlasCoords(const DeviceContext& ctx, uint32_t texId,
+                                                 float& u, float& v, float2& ddx, float2& ddy) {
+    if (ctx.atlas && mapToAtlas(ctx.atlas[texId], u, v)) {
+        const AtlasMapping& m = ctx.atlas[texId];
+        ddx.x *= m.scaleU; ddx.y *= m.scaleV;
+        ddy.x *= m.scaleU; ddy.y *= m.scaleV;
+    }
+}
+
 // Main texture sampling function
 // Returns true if texture is resident and sampled successfully
 __device__ inline bool tex2D(const DeviceContext& ctx,
@@ -69,6 +97,8 @@ __device__ inline bool tex2D(const DeviceContext& ctx,
         return false;
     }
     
+    markTextureUsed(ctx, texId);
+    remapAtlasCoords(ctx, texId, u, v);
     result = ::tex2D<float4>(ctx.textures[texId], u, v);
     return true;
 }
@@ -92,6 +122,8 @@ __device__ inline bool tex2DGrad(const DeviceContext& ctx,
         return false;
     }
     
+    markTextureUsed(ctx, texId);
+    remapAtlasCoords(ctx, texId, u, v, ddx, ddy);
     result = ::tex2DGrad<float4>(ctx.textures[texId], u, v, ddx, ddy);
     return true;
 }
@@ -115,6 +147,8 @@ __device__ inline bool tex2DLod(const DeviceContext& ctx,
         return false;
     }
     
+    markTextureUsed(ctx, texId);
+    remapAtlasCoords(ctx, texId, u, v);  // Texel density is unchanged, so lod needs no adjustment
     result = ::tex2DLod<float4>(ctx.textures[texId], u, v, lod);
     return true;
 }
@@ -4,8 +4,10 @@
 /// Interface for mipmapped image loading with HIP
 
 #include <hip/hip_runtime.h>
+#include <cmath>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace hip_demand {
 
@@ -21,6 +23,26 @@ class ImageSource
     /// Open the image and read header info. Throws on error.
     virtual void open(TextureInfo* info) = 0;
 
+    /// Open using header info cached from an earlier open() of the same file,
+    /// so the file is not touched until pixels are read. The default
+    /// implementation ignores the cached info and calls open().
+    virtual void openWithInfo(const TextureInfo& cachedInfo)
+    {
+        (void)cachedInfo;
+        open(nullptr);
+    }
+
+    /// Decode from a copy of the whole file already in memory (e.g. read ahead
+    /// asynchronously) instead of reading the file. Call before open() or
+    /// openWithInfo(); the reader drops the bytes once it has decoded them.
+    /// Returns false if the reader cannot decode from memory, in which case it
+    /// reads the file itself. The default implementation returns false.
+    virtual bool setFileData(std::shared_ptr<const std::vector<char>> data)
+    {
+        (void)data;
+        return false;
+    }
+
     /// Close the image.
     virtual void close() = 0;
 
@@ -31,6 +53,7 @@ class ImageSource
     virtual const TextureInfo& getInfo() const = 0;
 
     /// Read the specified mip level into dest buffer.
+    /// Pixels are written as 8-bit unsigned, numChannels interleaved.
     /// dest must be large enough to hold the mip level data.
     /// Returns true if successful.
     virtual bool readMipLevel(char* dest, 
@@ -39,6 +62,16 @@ class ImageSource
                              unsigned int expectedHeight,
                              hipStream_t stream = 0) = 0;
 
+    /// Read a rectangle of the specified mip level into dest.
+    /// Pixels use the same layout as readMipLevel; rows are rowPitch bytes apart
+    /// (0 = width * numChannels). Returns false if the rectangle is outside the level.
+    /// The default implementation reads the whole level and copies the rectangle;
+    /// readers that can decode partially should override it.
+    virtual bool readRegion(unsigned int mipLevel,
+                            unsigned int x, unsigned int y,
+                            unsigned int width, unsigned int height,
+                            char* dest, size_t rowPitch = 0);
+
     /// Read the base color (1x1 mip level) as float4. Returns true on success.
     virtual bool readBaseColor(float4& dest) = 0;
 
@@ -56,7 +89,29 @@ inline unsigned int calculateNumMipLevels(unsigned int width, unsigned int heigh
     return 1 + static_cast<unsigned int>(std::log2f(static_cast<float>(dim)));
 }
 
-/// Factory function to create image source from file
+/// Width or height of a mip level
+inline unsigned int getMipLevelDimension(unsigned int baseDimension, unsigned int mipLevel)
+{
+    unsigned int dim = (mipLevel < 32) ? (baseDimension >> mipLevel) : 0;
+    return (dim > 0) ? dim : 1;
+}
+
+/// Check that a rectangle lies inside a mip level of the given image
+bool isValidRegion(const TextureInfo& info, unsigned int mipLevel,
+                   unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+/// Copy rows of pixels between buffers with independent row pitches
+void copyImageRows(const char* src, size_t srcRowPitch,
+                   char* dest, size_t destRowPitch,
+                   size_t rowBytes, unsigned int rows);
+
+/// 2x2 box filter from one 8-bit interleaved mip level to the next (odd edges average fewer texels)
+void downsampleImageBox(const unsigned char* src, unsigned int srcWidth, unsigned int srcHeight,
+                        unsigned char* dest, unsigned int destWidth, unsigned int destHeight,
+                        unsigned int numChannels);
+
+/// Factory function to create image source from file.
+/// Picks the best registered reader (see ImageSourceRegistry.h); returns nullptr if none matches.
 std::unique_ptr<ImageSource> createImageSource(const std::string& filename);
 
 }  // namespace hip_demand
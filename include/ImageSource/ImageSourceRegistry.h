@@ -0,0 +1,87 @@
+#pragma once
+
+/// \file ImageSourceRegistry.h
+/// Registry of ImageSource implementations keyed by file extension and magic bytes
+
+#include "ImageSource.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hip_demand {
+
+/// Factory that constructs a reader for the given file. The reader is not opened.
+using ImageSourceFactory = std::function<std::unique_ptr<ImageSource>(const std::string& filename)>;
+
+/// Describes a reader to the registry.
+struct ImageSourceReaderDesc
+{
+    /// Unique reader name, e.g. "oiio" or "stb". Registering an existing name replaces it.
+    std::string name;
+
+    /// Lower-case file extensions without the dot, e.g. {"png", "jpg"}.
+    /// The single entry "*" makes the reader a catch-all for any extension.
+    std::vector<std::string> extensions;
+
+    /// Magic byte prefixes identifying the format, e.g. std::string("\x89PNG", 4).
+    std::vector<std::string> signatures;
+
+    /// Readers with higher priority are tried first among equally good matches.
+    int priority = 0;
+
+    /// True if ImageSource::setFileData() works for untiled files, so the loader
+    /// may read them ahead asynchronously and hand the reader the bytes.
+    bool decodesFromMemory = false;
+
+    ImageSourceFactory factory;
+};
+
+/// Register (or replace) a reader. Thread-safe.
+void registerImageSource(const ImageSourceReaderDesc& desc);
+
+/// Remove a reader by name. Returns false if no such reader was registered.
+bool unregisterImageSource(const std::string& name);
+
+/// Names of all registered readers, highest priority first.
+std::vector<std::string> getRegisteredImageSources();
+
+/// Outcome of sniffing a file's leading bytes.
+struct ImageSourceSniff
+{
+    /// False if the file could not be opened at all.
+    bool readable = false;
+
+    /// Leading bytes of the file, up to the longest registered signature.
+    std::string header;
+
+    /// Name of the first reader whose signature matched, empty if none did.
+    std::string detectedBy;
+
+    /// Candidate reader names, best first.
+    std::vector<std::string> readers;
+};
+
+/// Open the file once, read its leading bytes and rank the readers that can decode it.
+/// When the header matches a registered signature, readers that declare signatures
+/// but do not match it are dropped, so known formats never go to the wrong decoder.
+/// Readers that declare no signatures stay eligible by extension.
+/// A "pack#entry" name that is not itself a file is sniffed as the texture pack it names.
+ImageSourceSniff sniffImageSource(const std::string& filename);
+
+/// Rank readers for a header that has already been read (see sniffImageSource).
+std::vector<std::string> findImageSources(const std::string& filename, const std::string& header);
+
+/// Names of the readers that can handle the file, best candidate first.
+/// Readers whose signature matches the file header come first, then readers
+/// matching the extension, then catch-all readers.
+std::vector<std::string> findImageSources(const std::string& filename);
+
+/// True if the named reader decodes untiled files from memory (see ImageSourceReaderDesc).
+bool imageSourceDecodesFromMemory(const std::string& readerName);
+
+/// Create a reader by registered name. Returns nullptr if the name is unknown.
+std::unique_ptr<ImageSource> createImageSource(const std::string& filename,
+                                               const std::string& readerName);
+
+}  // namespace hip_demand
@@ -5,6 +5,7 @@
 
 #include "ImageSource.h"
 #include "TextureInfo.h"
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -12,51 +13,94 @@ namespace hip_demand {
 
 /// Image reader using OpenImageIO
 /// Supports many formats: PNG, JPEG, TIFF, EXR, HDR, TGA, BMP, etc.
+///
+/// ImageInput handles are borrowed from a process-wide LRU cache, so the file
+/// header is parsed once and later level reads reuse the open file. Levels
+/// stored in the file (mipmapped TIFF/EXR) are read directly; missing levels
+/// are generated from the base level. readRegion() decodes only the tiles or
+/// scanlines covering the rectangle.
 class OIIOReader : public ImageSource
 {
   public:
     /// Constructor
     explicit OIIOReader(const std::string& filename);
-    
+
     /// Destructor
     ~OIIOReader() override;
 
     // ImageSource interface
     void open(TextureInfo* info) override;
+    void openWithInfo(const TextureInfo& cachedInfo) override;
     void close() override;
     bool isOpen() const override;
     const TextureInfo& getInfo() const override;
-    
+
     bool readMipLevel(char* dest,
                      unsigned int mipLevel,
                      unsigned int expectedWidth,
                      unsigned int expectedHeight,
                      hipStream_t stream = 0) override;
-    
+
+    bool readRegion(unsigned int mipLevel,
+                    unsigned int x, unsigned int y,
+                    unsigned int width, unsigned int height,
+                    char* dest, size_t rowPitch = 0) override;
+
     bool readBaseColor(float4& dest) override;
-    
+
     unsigned long long getNumBytesRead() const override;
     double getTotalReadTime() const override;
 
+    /// Cap on ImageInput handles kept open across all OIIOReaders (default 256).
+    static void setMaxOpenFiles(size_t maxOpenFiles);
+    static size_t getMaxOpenFiles();
+
+    /// Number of ImageInput handles currently open across all OIIOReaders.
+    static size_t getOpenFileCount();
+
+    /// Close the idle cached handles of a file so the next read reopens it and
+    /// parses its header again, e.g. after the file changed on disk.
+    static void invalidateFile(const std::string& filename);
+
   private:
+    using MipChain = std::vector<std::vector<unsigned char>>;
+
     std::string filename_;
     TextureInfo info_;
     bool isOpen_ = false;
-    
+    unsigned int storedMipLevels_ = 0;  // Levels present in the file (0 = unknown)
+
+    // Guards isOpen_, info_ and the mipChain_ pointer; never held during I/O.
     mutable std::mutex mutex_;
+    // Serializes generation of mipChain_ so concurrent callers decode once.
+    std::mutex generateMutex_;
+    // Guards the statistics below.
+    mutable std::mutex statsMutex_;
     unsigned long long bytesRead_ = 0;
     double totalReadTime_ = 0.0;
-    
-    // Cached image data (all mip levels)
-    std::vector<std::vector<unsigned char>> mipLevels_;
-    
-    // Load entire image with all mip levels
-    bool loadImage();
-    
+
+    // Generated mip chain (all levels), shared with in-flight readers
+    std::shared_ptr<const MipChain> mipChain_;
+
+    // Read a level stored in the file directly into dest
+    bool readStoredLevel(char* dest, unsigned int mipLevel, unsigned int width, unsigned int height,
+                         unsigned int numChannels);
+
+    // Read a rectangle of a level stored in the file. Tiled files read only the
+    // covering tiles; scanline files read only the covering rows.
+    bool readStoredRegion(unsigned int mipLevel, unsigned int x, unsigned int y,
+                          unsigned int width, unsigned int height,
+                          char* dest, size_t rowPitch, unsigned int numChannels);
+
+    // Load the base image and generate all mip levels
+    std::shared_ptr<const MipChain> getMipChain();
+
     // Generate mip level from previous level
-    void generateMipLevel(const unsigned char* srcData, int srcWidth, int srcHeight,
-                         unsigned char* dstData, int dstWidth, int dstHeight,
-                         int channels);
+    static void generateMipLevel(const unsigned char* srcData, int srcWidth, int srcHeight,
+                                 unsigned char* dstData, int dstWidth, int dstHeight,
+                                 int channels);
+
+    void addStats(unsigned long long bytes, double seconds);
 };
 
 }  // namespace hip_demand
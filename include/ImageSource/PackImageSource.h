@@ -0,0 +1,75 @@
+#pragma once
+
+/// \file PackImageSource.h
+/// Image reader for one entry of a texture pack
+
+#include "ImageSource.h"
+#include "TextureInfo.h"
+#include "TexturePack.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hip_demand {
+
+/// Image reader for a "pack#entry" filename (see TexturePack::makeEntryPath).
+/// The pack is mapped once per process and shared by all of its entries, so
+/// opening an entry performs no file I/O. Encoded entries are decoded from the
+/// mapping with stb_image; decoded entries are copied level by level from the
+/// mapping. Levels beyond those stored are generated with a box filter.
+class PackImageSource : public ImageSource
+{
+  public:
+    /// Constructor
+    explicit PackImageSource(const std::string& filename);
+
+    /// Destructor
+    ~PackImageSource() override;
+
+    // ImageSource interface
+    void open(TextureInfo* info) override;
+    void openWithInfo(const TextureInfo& cachedInfo) override;
+    void close() override;
+    bool isOpen() const override;
+    const TextureInfo& getInfo() const override;
+
+    bool readMipLevel(char* dest,
+                     unsigned int mipLevel,
+                     unsigned int expectedWidth,
+                     unsigned int expectedHeight,
+                     hipStream_t stream = 0) override;
+
+    bool readRegion(unsigned int mipLevel,
+                    unsigned int x, unsigned int y,
+                    unsigned int width, unsigned int height,
+                    char* dest, size_t rowPitch = 0) override;
+
+    bool readBaseColor(float4& dest) override;
+
+    unsigned long long getNumBytesRead() const override;
+    double getTotalReadTime() const override;
+
+  private:
+    std::string filename_;
+    TextureInfo info_;
+    bool isOpen_ = false;
+
+    mutable std::mutex mutex_;
+    unsigned long long bytesRead_ = 0;
+    double totalReadTime_ = 0.0;
+
+    std::shared_ptr<TexturePack> pack_;
+    const PackEntry* entry_ = nullptr;
+    unsigned int storedLevels_ = 0;  // Levels readable straight from the mapping
+
+    // Levels decoded or generated on demand; element i holds level storedLevels_ + i
+    std::vector<std::vector<unsigned char>> mipLevels_;
+
+    // Map the pack and find the entry; throws on error
+    void openEntry();
+
+    // Pixels of a level, decoding or generating it if needed; nullptr on error
+    const unsigned char* levelData(unsigned int mipLevel);
+};
+
+}  // namespace hip_demand
@@ -0,0 +1,75 @@
+#pragma once
+
+/// \file StbReader.h
+/// stb_image-based image reader implementation
+
+#include "ImageSource.h"
+#include "TextureInfo.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hip_demand {
+
+/// Image reader using stb_image.
+/// Supports PNG, JPEG, BMP, TGA, GIF, PSD, HDR, PIC and PNM. Pixels are
+/// delivered as 8-bit unsigned with the file's native channel count.
+/// stb decodes whole images only, so the first region read decodes the file;
+/// the decoded levels are kept and later region reads are plain copies.
+/// With setFileData() the file bytes come from memory and the file is not opened.
+class StbReader : public ImageSource
+{
+  public:
+    /// Constructor
+    explicit StbReader(const std::string& filename);
+
+    /// Destructor
+    ~StbReader() override;
+
+    // ImageSource interface
+    void open(TextureInfo* info) override;
+    void openWithInfo(const TextureInfo& cachedInfo) override;
+    bool setFileData(std::shared_ptr<const std::vector<char>> data) override;
+    void close() override;
+    bool isOpen() const override;
+    const TextureInfo& getInfo() const override;
+
+    bool readMipLevel(char* dest,
+                     unsigned int mipLevel,
+                     unsigned int expectedWidth,
+                     unsigned int expectedHeight,
+                     hipStream_t stream = 0) override;
+
+    bool readRegion(unsigned int mipLevel,
+                    unsigned int x, unsigned int y,
+                    unsigned int width, unsigned int height,
+                    char* dest, size_t rowPitch = 0) override;
+
+    bool readBaseColor(float4& dest) override;
+
+    unsigned long long getNumBytesRead() const override;
+    double getTotalReadTime() const override;
+
+  private:
+    std::string filename_;
+    TextureInfo info_;
+    bool isOpen_ = false;
+
+    mutable std::mutex mutex_;
+    unsigned long long bytesRead_ = 0;
+    double totalReadTime_ = 0.0;
+
+    // Whole file read ahead by the caller; dropped after decoding
+    std::shared_ptr<const std::vector<char>> fileData_;
+
+    // Decoded mip levels; only levels up to the finest requested one are built.
+    std::vector<std::vector<unsigned char>> mipLevels_;
+
+    // Decode the base level
+    bool loadImage();
+
+    // Build mip levels up to and including the given level
+    void buildMipLevels(unsigned int lastLevel);
+};
+
+}  // namespace hip_demand
@@ -0,0 +1,129 @@
+#pragma once
+
+/// \file TexturePack.h
+/// Texture pack: many small images in one file, served from a single mapping
+
+#include "TextureInfo.h"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hip_demand {
+
+/// How an entry's payload is stored
+enum class PackEntryKind : uint8_t
+{
+    Encoded = 0,  ///< The original file bytes (PNG, JPEG, ...), decoded on read with stb_image
+    Decoded = 1   ///< 8-bit pixels, native channel count, every mip level tightly packed, level 0 first
+};
+
+/// One image in a pack
+struct PackEntry
+{
+    std::string name;
+    uint64_t offset = 0;  ///< Payload position in the file, a multiple of kPackAlignment
+    uint64_t size = 0;    ///< Payload bytes
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int numChannels = 0;
+    unsigned int numMipLevels = 1;  ///< Levels stored (Decoded); 1 for Encoded
+    PackEntryKind kind = PackEntryKind::Encoded;
+};
+
+/// Payload alignment; keeps payloads page-aligned in the mapping
+constexpr uint64_t kPackAlignment = 4096;
+
+/// Read-only texture pack.
+///
+/// File layout (little-endian):
+///   header   8-byte magic "HDTPACK\0", u32 version, u32 entry count,
+///            u64 index offset, u64 index size, u64 file size; zero-padded to 4 KB
+///   payloads one per entry, each starting on a 4 KB boundary
+///   index    per entry: u64 offset, u64 size, u32 width, u32 height,
+///            u16 channels, u16 mip levels, u8 kind, u8 reserved, u16 name length, name bytes
+///
+/// The whole file is mapped once; entries are served straight from the mapping.
+class TexturePack
+{
+  public:
+    ~TexturePack();
+
+    TexturePack(const TexturePack&) = delete;
+    TexturePack& operator=(const TexturePack&) = delete;
+
+    /// Map a pack and parse its index. Returns nullptr (with a reason in error) if the
+    /// file is missing, truncated or not a pack.
+    static std::shared_ptr<TexturePack> open(const std::string& path, std::string* error = nullptr);
+
+    /// Like open(), but a pack that is still mapped elsewhere in the process is shared
+    /// instead of mapped again.
+    static std::shared_ptr<TexturePack> openShared(const std::string& path, std::string* error = nullptr);
+
+    const std::string& getPath() const { return path_; }
+    size_t getEntryCount() const { return entries_.size(); }
+    const PackEntry& getEntry(size_t index) const { return entries_[index]; }
+
+    /// Entry index by name, or -1
+    long long findEntry(const std::string& name) const;
+
+    /// Payload bytes of an entry, valid while the pack is alive
+    const unsigned char* getPayload(const PackEntry& entry) const { return base_ + entry.offset; }
+
+    /// Header info of an entry as an ImageSource would report it
+    static TextureInfo getTextureInfo(const PackEntry& entry);
+
+    /// "pack#entry" names one entry of a pack wherever a filename is expected
+    static std::string makeEntryPath(const std::string& packPath, const std::string& entryName);
+    static bool splitEntryPath(const std::string& entryPath, std::string& packPath, std::string& entryName);
+
+  private:
+    TexturePack() = default;
+    bool map(const std::string& path, std::string* error);
+    bool parseIndex(std::string* error);
+
+    std::string path_;
+    const unsigned char* base_ = nullptr;
+    uint64_t size_ = 0;
+    void* mapping_ = nullptr;  ///< Platform mapping handle (Windows)
+    std::vector<PackEntry> entries_;
+    std::unordered_map<std::string, size_t> byName_;
+};
+
+/// Writes a pack: add entries, then finish(). Payloads are streamed to the file
+/// as they are added; only the index is kept in memory.
+class TexturePackWriter
+{
+  public:
+    ~TexturePackWriter();
+
+    bool open(const std::string& path);
+
+    /// Store an encoded image file as is. width/height/channels come from its header.
+    bool addEncoded(const std::string& name, const void* data, size_t size,
+                    unsigned int width, unsigned int height, unsigned int numChannels);
+
+    /// Store decoded 8-bit pixels (numChannels interleaved) for levels [0, numMipLevels),
+    /// tightly packed level after level with the usual halving of each dimension.
+    bool addDecoded(const std::string& name, const void* levels, size_t size,
+                    unsigned int width, unsigned int height, unsigned int numChannels,
+                    unsigned int numMipLevels);
+
+    /// Write the index and header. Returns false if any write failed.
+    bool finish();
+
+    size_t getEntryCount() const { return entries_.size(); }
+
+  private:
+    bool addPayload(PackEntry entry, const void* data);
+
+    std::ofstream out_;
+    uint64_t position_ = 0;
+    std::vector<PackEntry> entries_;
+    std::unordered_map<std::string, size_t> names_;
+    bool failed_ = false;
+};
+
+}  // namespace hip_demand
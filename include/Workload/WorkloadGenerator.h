@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace hip_demand {
+
+// Synthetic texture corpora and access streams for load testing the loader at
+// 10k-1M textures. Everything is deterministic for a given seed.
+//
+// Typical use: generateCorpus() -> writeCorpusImages() + writeCorpusManifest(),
+// then AccessGenerator -> writeWorkloadTrace() and feed the trace to
+// hip_demand_replay / hip_demand_mrc, or create the manifest's textures in
+// order (ids then match the trace) and drive a renderer frame by frame.
+
+enum class SizeDistribution {
+    Fixed,       // Every texture is maxSize
+    LogUniform,  // Power-of-two edge, uniform over octaves in [minSize, maxSize]
+    Weighted     // Power-of-two edge, CorpusSpec::sizeWeights per octave from minSize up
+};
+
+enum class SyntheticImageFormat { PNG, TGA, BMP, JPG };
+
+struct CorpusSpec {
+    uint32_t textureCount = 10000;
+    SizeDistribution sizeDistribution = SizeDistribution::LogUniform;
+    uint32_t minSize = 64;                      // Edge length, rounded down to a power of two
+    uint32_t maxSize = 2048;
+    std::vector<double> sizeWeights;            // Weighted only; index 0 = minSize
+    double wideFraction = 0.1;                  // Fraction of textures with a 2:1 aspect ratio
+    std::vector<uint32_t> channels = {3, 4};    // Picked uniformly per texture
+    SyntheticImageFormat format = SyntheticImageFormat::PNG;
+    uint32_t filesPerClass = 0;                 // Distinct files per (size, channels) class; 0 = one per texture
+    uint32_t tilesPerAsset = 10;                // Consecutive ids grouped as one UDIM-style asset
+    std::string directory = "synthetic";
+    uint64_t seed = 1;
+};
+
+struct SyntheticTexture {
+    std::string filename;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t channels = 0;
+    uint32_t asset = 0;    // UDIM asset this texture is a tile of
+    float x = 0.0f;        // Position in the unit-square world (flythrough)
+    float y = 0.0f;
+};
+
+// Describe a corpus without touching the disk
+std::vector<SyntheticTexture> generateCorpus(const CorpusSpec& spec);
+
+// Write each distinct file of the corpus (existing files are kept).
+// Returns the number of files written; errors are reported in *error.
+size_t writeCorpusImages(const std::vector<SyntheticTexture>& corpus, SyntheticImageFormat format,
+                         unsigned int threads = 0, std::string* error = nullptr);
+
+// Text manifest, one texture per line in id order: "<width> <height> <channels> <filename>"
+bool writeCorpusManifest(const std::string& path, const std::vector<SyntheticTexture>& corpus);
+bool readCorpusManifest(const std::string& path, std::vector<SyntheticTexture>& corpus);
+
+// Device bytes the loader allocates for a texture (RGBA8 with full mip chain)
+uint64_t estimateTextureBytes(uint32_t width, uint32_t height);
+
+enum class AccessPattern {
+    Uniform,     // Every texture equally likely
+    Zipf,        // Popularity ~ 1 / rank^zipfExponent over a shuffled ranking
+    Flythrough,  // Camera moves through the world; textures near it are sampled
+    Udim         // Zipf over assets; each pick touches a contiguous run of its tiles
+};
+
+struct AccessSpec {
+    AccessPattern pattern = AccessPattern::Zipf;
+    uint32_t frames = 1000;
+    uint32_t accessesPerFrame = 256;  // Draws per frame, before deduplication
+    double zipfExponent = 1.0;
+    uint32_t shotLength = 0;          // Frames per shot; a cut reshuffles popularity or moves the camera. 0 = one shot
+    double viewRadius = 0.05;         // Flythrough: visible radius in world units
+    double cameraSpeed = 0.002;       // Flythrough: world units per frame
+    uint64_t seed = 1;
+};
+
+// Produces per-frame texture access sets for a corpus.
+class AccessGenerator {
+public:
+    AccessGenerator(const AccessSpec& spec, const std::vector<SyntheticTexture>& corpus);
+
+    // Unique, sorted texture ids accessed in the next frame; false once spec.frames frames were produced
+    bool nextFrame(std::vector<uint32_t>& ids);
+
+    uint32_t getFrame() const { return frame_; }
+
+private:
+    void startShot();
+    void buildZipf(size_t n);
+    uint32_t sampleZipf();
+    void sampleFlythrough(std::vector<uint32_t>& ids);
+    void sampleUdim(std::vector<uint32_t>& ids);
+
+    AccessSpec spec_;
+    const std::vector<SyntheticTexture>& corpus_;
+    std::mt19937_64 rng_;
+    uint32_t frame_ = 0;
+
+    // Zipf / Udim: cumulative popularity over ranks and the rank -> item map
+    std::vector<double> zipfCdf_;
+    std::vector<uint32_t> ranking_;
+
+    // Udim: first texture id and tile count per asset
+    std::vector<uint32_t> assetStart_;
+    std::vector<uint32_t> assetTiles_;
+
+    // Flythrough: uniform grid over the world, camera path state
+    uint32_t gridSize_ = 1;
+    std::vector<std::vector<uint32_t>> grid_;
+    double cameraPhase_ = 0.0;
+    double cameraOrigin_[2] = {0.0, 0.0};
+};
+
+// Write a RequestTrace (Texture records, then one Requests record per frame)
+// for hip_demand_replay and hip_demand_mrc.
+bool writeWorkloadTrace(const std::string& path, const std::vector<SyntheticTexture>& corpus,
+                        AccessGenerator& access);
+
+} // namespace hip_demand
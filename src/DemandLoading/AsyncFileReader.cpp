@@ -0,0 +1,385 @@
+#include "AsyncFileReader.h"
+#include "DemandLoading/Logging.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HIP_DEMAND_POSIX_IO 1
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define HIP_DEMAND_IO_URING 1
+#endif
+#endif
+#endif
+
+namespace hip_demand {
+
+namespace {
+
+// Clamp [offset, offset + length) to a file of fileSize bytes; length 0 means to the end
+uint64_t rangeLength(uint64_t fileSize, uint64_t offset, uint64_t length) {
+    if (offset >= fileSize) return 0;
+    uint64_t available = fileSize - offset;
+    return (length == 0 || length > available) ? available : length;
+}
+
+FileReadResult readBlocking(const std::string& path, uint64_t offset, uint64_t length) {
+    FileReadResult result;
+#if defined(HIP_DEMAND_POSIX_IO)
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        result.error = errno;
+        return result;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        result.error = errno;
+        ::close(fd);
+        return result;
+    }
+    result.data.resize(rangeLength(static_cast<uint64_t>(st.st_size), offset, length));
+    size_t done = 0;
+    while (done < result.data.size()) {
+        ssize_t n = ::pread(fd, result.data.data() + done, result.data.size() - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            result.error = errno;
+            break;
+        }
+        if (n == 0) break;  // File shrank
+        done += static_cast<size_t>(n);
+    }
+    result.data.resize(done);
+    ::close(fd);
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        result.error = errno ? errno : ENOENT;
+        return result;
+    }
+    uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    result.data.resize(rangeLength(fileSize, offset, length));
+    in.seekg(static_cast<std::streamoff>(offset));
+    in.read(result.data.data(), static_cast<std::streamsize>(result.data.size()));
+    result.data.resize(static_cast<size_t>(in.gcount()));
+#endif
+    return result;
+}
+
+// Blocking reads spread over a pool; queue depth = thread count
+class ThreadFileReader : public AsyncFileReader {
+public:
+    explicit ThreadFileReader(unsigned int queueDepth) : pool_(std::max(1u, queueDepth)) {}
+
+    void read(const std::string& path, uint64_t offset, uint64_t length, FileReadCallback callback) override {
+        pool_.submit([path, offset, length, callback = std::move(callback)]() {
+            callback(readBlocking(path, offset, length));
+        });
+    }
+
+    Backend backend() const override { return Backend::Threads; }
+
+private:
+    ThreadPool pool_;
+};
+
+#if defined(HIP_DEMAND_IO_URING)
+
+// One io_uring owned by an I/O thread. Files are opened on that thread and read
+// in chunks, with up to queueDepth chunk reads in flight across all files.
+class IoUringFileReader : public AsyncFileReader {
+public:
+    ~IoUringFileReader() override {
+        if (thread_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            cv_.notify_one();
+            thread_.join();
+        }
+        if (sqes_) ::munmap(sqes_, sqesSize_);
+        if (cqRing_ && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+        if (sqRing_) ::munmap(sqRing_, sqRingSize_);
+        if (ringFd_ >= 0) ::close(ringFd_);
+    }
+
+    // False if the kernel refuses io_uring; the caller falls back to threads
+    bool init(unsigned int queueDepth) {
+        depth_ = std::max(1u, queueDepth);
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd_ = static_cast<int>(::syscall(__NR_io_uring_setup, depth_, &params));
+        if (ringFd_ < 0) {
+            logMessage(LogLevel::Debug, "AsyncFileReader: io_uring_setup failed: %s", std::strerror(errno));
+            return false;
+        }
+
+        sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) {
+            sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        }
+        sqRing_ = mapRing(sqRingSize_, IORING_OFF_SQ_RING);
+        cqRing_ = singleMmap ? sqRing_ : mapRing(cqRingSize_, IORING_OFF_CQ_RING);
+        sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mapRing(sqesSize_, IORING_OFF_SQES);
+        if (!sqRing_ || !cqRing_ || !sqes) {
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(sqRing_);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        depth_ = std::min(depth_, params.sq_entries);
+
+        thread_ = std::thread([this]() { run(); });
+        return true;
+    }
+
+    void read(const std::string& path, uint64_t offset, uint64_t length, FileReadCallback callback) override {
+        auto request = std::make_unique<Request>();
+        request->path = path;
+        request->offset = offset;
+        request->length = length;
+        request->callback = std::move(callback);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming_.push_back(std::move(request));
+        }
+        cv_.notify_one();
+    }
+
+    Backend backend() const override { return Backend::IoUring; }
+
+private:
+    // Large files are split so one file can use several queue slots
+    static constexpr uint64_t kChunkBytes = 1u << 20;
+
+    struct Request {
+        std::string path;
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        FileReadCallback callback;
+        int fd = -1;
+        FileReadResult result;
+        size_t validBytes = 0;         // Shrinks if the file ends early
+        size_t chunksOutstanding = 0;
+    };
+
+    struct Chunk {
+        Request* request = nullptr;
+        size_t pos = 0;  // Offset into request->result.data
+        iovec iov;
+    };
+
+    void* mapRing(size_t size, unsigned long long offset) {
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, static_cast<off_t>(offset));
+        return p == MAP_FAILED ? nullptr : p;
+    }
+
+    void run() {
+        std::vector<std::unique_ptr<Request>> requests;  // Open requests, owned here
+        std::deque<Chunk*> ready;                        // Chunks waiting for a queue slot
+        std::vector<std::unique_ptr<Chunk>> chunkPool;
+        unsigned int inflight = 0;
+
+        for (;;) {
+            std::deque<std::unique_ptr<Request>> incoming;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (incoming_.empty() && ready.empty() && inflight == 0) {
+                    cv_.wait(lock, [this]() { return stopping_ || !incoming_.empty(); });
+                    if (incoming_.empty()) {
+                        return;  // Stopping and drained
+                    }
+                }
+                incoming.swap(incoming_);
+            }
+
+            for (std::unique_ptr<Request>& request : incoming) {
+                if (startRequest(*request, ready, chunkPool)) {
+                    requests.push_back(std::move(request));
+                }
+            }
+
+            unsigned int toSubmit = 0;
+            while (!ready.empty() && inflight < depth_) {
+                pushRead(ready.front());
+                ready.pop_front();
+                inflight++;
+                toSubmit++;
+            }
+            if (inflight == 0) {
+                continue;
+            }
+
+            int ret = static_cast<int>(::syscall(__NR_io_uring_enter, ringFd_, toSubmit, 1u, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                logMessage(LogLevel::Error, "AsyncFileReader: io_uring_enter failed: %s", std::strerror(errno));
+            }
+
+            unsigned head = *cqHead_;
+            unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                Chunk* chunk = reinterpret_cast<Chunk*>(static_cast<uintptr_t>(cqe.user_data));
+                Request& request = *chunk->request;
+                inflight--;
+                if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+                    ready.push_back(chunk);
+                    continue;
+                }
+                if (cqe.res < 0) {
+                    request.result.error = -cqe.res;
+                } else if (cqe.res == 0) {
+                    request.validBytes = std::min(request.validBytes, chunk->pos);
+                } else if (static_cast<size_t>(cqe.res) < chunk->iov.iov_len) {
+                    // Short read: queue the rest
+                    chunk->pos += static_cast<size_t>(cqe.res);
+                    chunk->iov.iov_base = static_cast<char*>(chunk->iov.iov_base) + cqe.res;
+                    chunk->iov.iov_len -= static_cast<size_t>(cqe.res);
+                    ready.push_back(chunk);
+                    continue;
+                }
+                chunkPool.emplace_back(chunk);
+                if (--request.chunksOutstanding == 0) {
+                    finishRequest(request);
+                    requests.erase(std::find_if(requests.begin(), requests.end(),
+                                                [&](const std::unique_ptr<Request>& r) { return r.get() == &request; }));
+                }
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        }
+    }
+
+    // Open the file and split the range into chunks; false if the request completed right away
+    bool startRequest(Request& request, std::deque<Chunk*>& ready, std::vector<std::unique_ptr<Chunk>>& chunkPool) {
+        request.fd = ::open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (request.fd < 0 || ::fstat(request.fd, &st) != 0) {
+            request.result.error = errno;
+            finishRequest(request);
+            return false;
+        }
+        request.result.data.resize(rangeLength(static_cast<uint64_t>(st.st_size), request.offset, request.length));
+        request.validBytes = request.result.data.size();
+        if (request.result.data.empty()) {
+            finishRequest(request);
+            return false;
+        }
+        for (size_t pos = 0; pos < request.result.data.size(); pos += kChunkBytes) {
+            Chunk* chunk;
+            if (chunkPool.empty()) {
+                chunk = new Chunk();
+            } else {
+                chunk = chunkPool.back().release();
+                chunkPool.pop_back();
+            }
+            chunk->request = &request;
+            chunk->pos = pos;
+            chunk->iov.iov_base = request.result.data.data() + pos;
+            chunk->iov.iov_len = static_cast<size_t>(std::min<uint64_t>(kChunkBytes, request.result.data.size() - pos));
+            ready.push_back(chunk);
+            request.chunksOutstanding++;
+        }
+        return true;
+    }
+
+    void finishRequest(Request& request) {
+        if (request.fd >= 0) {
+            ::close(request.fd);
+            request.fd = -1;
+        }
+        if (request.result.ok()) {
+            request.result.data.resize(request.validBytes);
+        } else {
+            request.result.data.clear();
+        }
+        request.callback(std::move(request.result));
+    }
+
+    void pushRead(Chunk* chunk) {
+        unsigned tail = *sqTail_;
+        unsigned index = tail & sqMask_;
+        io_uring_sqe& sqe = sqes_[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;  // Plain READ needs 5.6; READV works from 5.1
+        sqe.fd = chunk->request->fd;
+        sqe.off = chunk->request->offset + chunk->pos;
+        sqe.addr = reinterpret_cast<uintptr_t>(&chunk->iov);
+        sqe.len = 1;
+        sqe.user_data = reinterpret_cast<uintptr_t>(chunk);
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    int ringFd_ = -1;
+    unsigned int depth_ = 0;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    size_t sqRingSize_ = 0;
+    size_t cqRingSize_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqesSize_ = 0;
+    unsigned* sqTail_ = nullptr;
+    unsigned* sqArray_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<Request>> incoming_;
+    bool stopping_ = false;
+};
+
+#endif // HIP_DEMAND_IO_URING
+
+} // namespace
+
+std::unique_ptr<AsyncFileReader> AsyncFileReader::create(unsigned int queueDepth, bool preferIoUring) {
+#if defined(HIP_DEMAND_IO_URING)
+    if (preferIoUring) {
+        auto ring = std::make_unique<IoUringFileReader>();
+        if (ring->init(queueDepth)) {
+            return ring;
+        }
+        logMessage(LogLevel::Info, "AsyncFileReader: io_uring unavailable, using %u reader threads", queueDepth);
+    }
+#else
+    (void)preferIoUring;
+#endif
+    return std::make_unique<ThreadFileReader>(queueDepth);
+}
+
+} // namespace hip_demand
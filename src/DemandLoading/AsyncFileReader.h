@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hip_demand {
+
+struct FileReadResult {
+    std::vector<char> data;  // The bytes read; shorter than requested if the file ended first
+    int error = 0;           // errno of a failed open or read, 0 on success
+    bool ok() const { return error == 0; }
+};
+
+// Called once per read from an I/O thread; keep it short (hand work to another pool)
+using FileReadCallback = std::function<void(FileReadResult&& result)>;
+
+// Reads whole files or byte ranges with many requests in flight, so decoders can
+// run on in-memory bytes instead of blocking on the file. On Linux an io_uring
+// ring keeps up to queueDepth reads outstanding from one I/O thread; elsewhere,
+// or where io_uring is unavailable (old kernel, seccomp), queueDepth threads do
+// blocking preads.
+class AsyncFileReader {
+public:
+    enum class Backend { IoUring, Threads };
+
+    // preferIoUring == false forces the thread backend
+    static std::unique_ptr<AsyncFileReader> create(unsigned int queueDepth, bool preferIoUring = true);
+
+    virtual ~AsyncFileReader() = default;
+
+    // Queue a read of [offset, offset + length); length 0 reads to the end of the file.
+    // The destructor waits for queued reads and runs their callbacks.
+    virtual void read(const std::string& path, uint64_t offset, uint64_t length, FileReadCallback callback) = 0;
+
+    void readFile(const std::string& path, FileReadCallback callback) {
+        read(path, 0, 0, std::move(callback));
+    }
+
+    virtual Backend backend() const = 0;
+    const char* backendName() const { return backend() == Backend::IoUring ? "io_uring" : "threads"; }
+};
+
+} // namespace hip_demand
@@ -0,0 +1,203 @@
+#include "DemandLoading/CpuTextureSampling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HIP_DEMAND_CPU_SSE2 1
+#endif
+
+namespace hip_demand {
+
+namespace {
+
+// 8-bit sRGB to linear [0,1], applied per texel before filtering like the GPU
+struct SrgbTable {
+    float linear[256];
+    SrgbTable() {
+        for (int i = 0; i < 256; ++i) {
+            float c = i / 255.0f;
+            linear[i] = (c <= 0.04045f) ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+    }
+};
+
+const float* srgbToLinear() {
+    static const SrgbTable table;
+    return table.linear;
+}
+
+// Four-channel RGBA value; SSE2 when available, otherwise plain floats the
+// compiler can vectorize
+#if defined(HIP_DEMAND_CPU_SSE2)
+struct Vec4 {
+    __m128 v;
+};
+
+inline Vec4 zero4() {
+    return {_mm_setzero_ps()};
+}
+
+inline Vec4 loadTexel(const uint8_t* p, const float* srgb) {
+    if (srgb) {
+        return {_mm_set_ps(p[3] * (1.0f / 255.0f), srgb[p[2]], srgb[p[1]], srgb[p[0]])};
+    }
+    int32_t packed;
+    std::memcpy(&packed, p, sizeof(packed));
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x = _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero);
+    x = _mm_unpacklo_epi16(x, zero);
+    return {_mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(1.0f / 255.0f))};
+}
+
+inline Vec4 lerp4(Vec4 a, Vec4 b, float t) {
+    return {_mm_add_ps(a.v, _mm_mul_ps(_mm_sub_ps(b.v, a.v), _mm_set1_ps(t)))};
+}
+
+inline float4 toFloat4(Vec4 a) {
+    float out[4];
+    _mm_storeu_ps(out, a.v);
+    return make_float4(out[0], out[1], out[2], out[3]);
+}
+#else
+struct Vec4 {
+    float v[4];
+};
+
+inline Vec4 zero4() {
+    return {{0.0f, 0.0f, 0.0f, 0.0f}};
+}
+
+inline Vec4 loadTexel(const uint8_t* p, const float* srgb) {
+    const float a = p[3] * (1.0f / 255.0f);
+    if (srgb) {
+        return {{srgb[p[0]], srgb[p[1]], srgb[p[2]], a}};
+    }
+    return {{p[0] * (1.0f / 255.0f), p[1] * (1.0f / 255.0f), p[2] * (1.0f / 255.0f), a}};
+}
+
+inline Vec4 lerp4(Vec4 a, Vec4 b, float t) {
+    Vec4 r;
+    for (int c = 0; c < 4; ++c) {
+        r.v[c] = a.v[c] + (b.v[c] - a.v[c]) * t;
+    }
+    return r;
+}
+
+inline float4 toFloat4(Vec4 a) {
+    return make_float4(a.v[0], a.v[1], a.v[2], a.v[3]);
+}
+#endif
+
+// Bring a normalized coordinate into a small range with the same texels, so the
+// scaled value always fits an int
+inline float reduceCoord(float u, hipTextureAddressMode mode) {
+    switch (mode) {
+        case hipAddressModeWrap:
+            return u - std::floor(u);
+        case hipAddressModeMirror:
+            return u - 2.0f * std::floor(u * 0.5f);
+        default:
+            return std::min(std::max(u, -1.0f), 2.0f);
+    }
+}
+
+// Map an integer texel coordinate into [0, n); -1 means border (transparent black)
+inline int resolveCoord(int i, int n, hipTextureAddressMode mode) {
+    if (i >= 0 && i < n) return i;
+    switch (mode) {
+        case hipAddressModeWrap: {
+            int m = i % n;
+            return m < 0 ? m + n : m;
+        }
+        case hipAddressModeMirror: {
+            int period = 2 * n;
+            int m = i % period;
+            if (m < 0) m += period;
+            return m < n ? m : period - 1 - m;
+        }
+        case hipAddressModeBorder:
+            return -1;
+        default:
+            return i < 0 ? 0 : n - 1;
+    }
+}
+
+inline Vec4 fetchTexel(const CpuTexture& tex, const CpuMipLevel& level, int x, int y, const float* srgb) {
+    x = resolveCoord(x, static_cast<int>(level.width), tex.addressMode[0]);
+    y = resolveCoord(y, static_cast<int>(level.height), tex.addressMode[1]);
+    if (x < 0 || y < 0) return zero4();
+    return loadTexel(level.texels + (static_cast<size_t>(y) * level.width + x) * 4, srgb);
+}
+
+// x, y in level texels (texel centers at +0.5)
+Vec4 sampleLevel(const CpuTexture& tex, const CpuMipLevel& level, float x, float y, const float* srgb) {
+    if (tex.filterMode == hipFilterModePoint) {
+        return fetchTexel(tex, level, static_cast<int>(std::floor(x)), static_cast<int>(std::floor(y)), srgb);
+    }
+    x -= 0.5f;
+    y -= 0.5f;
+    const float fx0 = std::floor(x);
+    const float fy0 = std::floor(y);
+    const int x0 = static_cast<int>(fx0);
+    const int y0 = static_cast<int>(fy0);
+    const float tx = x - fx0;
+    const float ty = y - fy0;
+    Vec4 top = lerp4(fetchTexel(tex, level, x0, y0, srgb), fetchTexel(tex, level, x0 + 1, y0, srgb), tx);
+    Vec4 bottom = lerp4(fetchTexel(tex, level, x0, y0 + 1, srgb), fetchTexel(tex, level, x0 + 1, y0 + 1, srgb), tx);
+    return lerp4(top, bottom, ty);
+}
+
+Vec4 sampleLevelAt(const CpuTexture& tex, size_t levelIndex, float u, float v, const float* srgb) {
+    const CpuMipLevel& level = tex.levels[levelIndex];
+    if (tex.normalizedCoords) {
+        return sampleLevel(tex, level, u * level.width, v * level.height, srgb);
+    }
+    // Unnormalized coordinates address level 0 texels
+    const CpuMipLevel& base = tex.levels[0];
+    return sampleLevel(tex, level, u * level.width / base.width, v * level.height / base.height, srgb);
+}
+
+} // namespace
+
+float4 sampleCpuTexture(const CpuTexture& tex, float u, float v, float lod) {
+    if (tex.levels.empty()) {
+        return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+    const float* srgb = tex.sRGB ? srgbToLinear() : nullptr;
+    if (tex.normalizedCoords) {
+        u = reduceCoord(u, tex.addressMode[0]);
+        v = reduceCoord(v, tex.addressMode[1]);
+    }
+
+    const size_t lastLevel = tex.levels.size() - 1;
+    if (!(lod > 0.0f)) lod = 0.0f;  // Also catches NaN
+    lod = std::min(lod, static_cast<float>(lastLevel));
+
+    if (lastLevel == 0 || tex.mipmapFilterMode == hipFilterModePoint) {
+        return toFloat4(sampleLevelAt(tex, static_cast<size_t>(lod + 0.5f), u, v, srgb));
+    }
+    const size_t level = static_cast<size_t>(lod);
+    const float t = lod - static_cast<float>(level);
+    Vec4 fine = sampleLevelAt(tex, level, u, v, srgb);
+    if (t == 0.0f || level == lastLevel) {
+        return toFloat4(fine);
+    }
+    return toFloat4(lerp4(fine, sampleLevelAt(tex, level + 1, u, v, srgb), t));
+}
+
+float computeCpuTextureLod(const CpuTexture& tex, float2 ddx, float2 ddy) {
+    if (tex.levels.size() < 2) {
+        return 0.0f;
+    }
+    const float w = tex.normalizedCoords ? static_cast<float>(tex.levels[0].width) : 1.0f;
+    const float h = tex.normalizedCoords ? static_cast<float>(tex.levels[0].height) : 1.0f;
+    const float lenX = (ddx.x * w) * (ddx.x * w) + (ddx.y * h) * (ddx.y * h);
+    const float lenY = (ddy.x * w) * (ddy.x * w) + (ddy.y * h) * (ddy.y * h);
+    const float rho2 = std::max(lenX, lenY);
+    return rho2 > 1.0f ? 0.5f * std::log2(rho2) : 0.0f;
+}
+
+} // namespace hip_demand
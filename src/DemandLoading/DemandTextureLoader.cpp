@@ -1,6 +1,19 @@
 #include "DemandLoading/DemandTextureLoader.h"
+#include "AsyncFileReader.h"
+#include "DemandLoading/CpuDemandTextureContext.h"
 #include "DemandLoading/Logging.h"
+#include "DemandLoading/MemoryArbiter.h"
+#include "DemandLoading/RequestTrace.h"
+#include "LatencyHistogram.h"
+#include "ResidencyBitmap.h"
+#include "RetryPolicy.h"
+#include "SharedTexelCache.h"
+#include "SkylinePacker.h"
+#include "ThreadPool.h"
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -9,14 +22,17 @@
 #include <atomic>
 #include <cstring>
 #include <cmath>
+#include <exception>
+#include <fstream>
+#include <sstream>
 
-#ifdef USE_OIIO
 #include "ImageSource/ImageSource.h"
+#include "ImageSource/ImageSourceRegistry.h"
+#ifdef USE_OIIO
 #include "ImageSource/OIIOReader.h"
 #endif
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include "ImageSource/TextureInfo.h"
+#include "ImageSource/TexturePack.h"
 
 namespace hip_demand {
 
@@ -34,8 +50,50 @@ const char* getErrorString(LoaderError error) {
     }
 }
 
-// Internal texture metadata (renamed to avoid conflict with ImageSource::TextureInfo)
-struct TextureMetadata {
+TextureSizeClass getTextureSizeClass(size_t estimatedBytes) {
+    if (estimatedBytes < (256u << 10)) return TextureSizeClass::Small;
+    if (estimatedBytes < (4u << 20)) return TextureSizeClass::Medium;
+    if (estimatedBytes < (64u << 20)) return TextureSizeClass::Large;
+    return TextureSizeClass::Huge;
+}
+
+const char* getTextureSizeClassName(TextureSizeClass sizeClass) {
+    switch (sizeClass) {
+        case TextureSizeClass::Small: return "small";
+        case TextureSizeClass::Medium: return "medium";
+        case TextureSizeClass::Large: return "large";
+        case TextureSizeClass::Huge: return "huge";
+        default: return "unknown";
+    }
+}
+
+// Per-texture state bits (TextureTable::state)
+enum TextureStateBits : uint8_t {
+    kTextureResident = 1u << 0,
+    kTextureLoading = 1u << 1,
+    kTextureHasMipmaps = 1u << 2,
+    kTextureMissPending = 1u << 3,  // Requested while not resident; latency clock running
+    kTextureFailed = 1u << 4,       // Last load failed; retried at TextureRecord::retryFrame
+    kTextureFailedPermanent = 1u << 5, // Last load failed in a way retrying cannot fix
+    kTexturePinned = 1u << 6           // Has a nested pin or an unexpired lease (Impl::pins_)
+};
+
+// Timeline of a texture's latest miss (see TextureLatency)
+struct MissTimeline {
+    uint32_t missFrame = 0;
+    uint32_t loadStartFrame = 0;
+    uint32_t residentFrame = 0;
+    bool loadStarted = false;
+    bool measured = false;
+    std::chrono::steady_clock::time_point missTime;
+    std::chrono::steady_clock::time_point loadStartTime;
+    uint64_t queueMicros = 0;
+    uint64_t totalMicros = 0;
+};
+
+// Cold per-texture data, allocated when a texture is created and touched only by
+// create, load and evict (renamed to avoid conflict with ImageSource::TextureInfo)
+struct TextureRecord {
     std::string filename;
     TextureDesc desc;
     hipTextureObject_t texObj = 0;
@@ -44,14 +102,86 @@ struct TextureMetadata {
     int width = 0;
     int height = 0;
     int channels = 0;
-    int numMipLevels = 0;
-    size_t memoryUsage = 0;
-    uint32_t lastUsedFrame = 0;
-    bool resident = false;
-    bool loading = false;
-    bool hasMipmaps = false;
     std::unique_ptr<uint8_t[]> cachedData;  // For reload after eviction
+    std::unique_ptr<CpuTexture> cpuTexture; // CPU backend: resident mip chain
+    std::string readerName;                 // Reader that accepted the file at creation
+    hip_demand::TextureInfo sourceInfo;     // Header read at creation, reused at load
     LoaderError lastError = LoaderError::Success;
+    uint32_t failureCount = 0;              // Consecutive failed loads
+    uint32_t retryFrame = 0;                // Transient failure: first frame a retry is allowed
+    MissTimeline latency;
+    uint32_t atlasX = 0;                    // Atlas member: level-0 corner of its texels in the page
+    uint32_t atlasY = 0;
+    uint32_t evictedFrame = 0;              // Last eviction, for thrash detection
+    bool evicted = false;                   // Evicted and not requested since
+    uint8_t evictedMipBias = 0;             // loadedMipBias of the evicted copy
+    uint8_t loadedMipBias = 0;              // Mip levels the resident copy dropped
+    uint8_t baseMipBias = 0;                // Levels the resolution cap always drops
+};
+
+// Texture metadata as parallel arrays indexed by texture id. Fields read by
+// per-frame scans (request dedup, eviction, snapshots) are packed so a scan
+// only touches the bytes it needs; everything else sits in a TextureRecord.
+// An id that was never created costs sizeof the hot fields plus one null pointer.
+struct TextureTable {
+    std::vector<uint8_t> state;              // TextureStateBits
+    std::vector<uint8_t> numMipLevels;       // While resident
+    std::vector<uint32_t> lastUsedFrame;
+    std::vector<size_t> memoryUsage;         // Device bytes while resident
+    std::vector<size_t> estimatedBytes;      // RGBA8 with full mip chain from the header; 0 = size unknown
+    std::vector<uint32_t> atlasPage;         // 1-based index of the texture's atlas page; 0 = standalone
+    std::vector<uint8_t> budgetGroup;        // TextureDesc::budgetGroup
+    std::vector<std::unique_ptr<TextureRecord>> records;
+
+    void resize(size_t count) {
+        state.resize(count, 0);
+        numMipLevels.resize(count, 0);
+        lastUsedFrame.resize(count, 0);
+        memoryUsage.resize(count, 0);
+        estimatedBytes.resize(count, 0);
+        atlasPage.resize(count, 0);
+        budgetGroup.resize(count, 0);
+        records.resize(count);
+    }
+
+    bool isResident(uint32_t texId) const { return (state[texId] & kTextureResident) != 0; }
+    bool isBusy(uint32_t texId) const { return (state[texId] & (kTextureResident | kTextureLoading)) != 0; }
+};
+
+// Page shared by small textures (LoaderOptions::atlasMaxTextureSize). Members are
+// placed when they are created, only into pages that are neither resident nor
+// loading; the page then loads and evicts as one texture and its members'
+// table entries follow it. Member memoryUsage is its share of the page.
+struct AtlasPage {
+    TextureDesc desc;                // Filtering shared by the members; clamp addressing
+    SkylinePacker packer;
+    std::vector<uint32_t> members;
+    TextureRecord surface;           // Texture fields of the whole page while resident
+    bool resident = false;
+    bool loading = false;
+    uint32_t lastUsedFrame = 0;
+    uint32_t width = 0;              // Allocated size while resident
+    uint32_t height = 0;
+    size_t memoryUsage = 0;
+    uint64_t texelArea = 0;          // Level-0 texels of the members, gutters excluded
+    uint32_t pinnedMembers = 0;      // Members with kTexturePinned; the page is not evicted while any are
+};
+
+// Pins held on one texture (pinTexture); it stays pinned while either is active
+struct PinRecord {
+    uint32_t count = 0;         // Nested pins
+    uint32_t leaseEndFrame = 0; // Lease covers launches before this frame
+    bool leased = false;
+};
+
+// Share of the texture budget (see DemandTextureLoader::createBudgetGroup)
+struct BudgetGroup {
+    std::string name;
+    size_t minBytes = 0;
+    size_t maxBytes = 0;         // 0 = no cap
+    size_t memoryUsage = 0;
+    size_t residentCount = 0;
+    uint64_t evictionCount = 0;
 };
 
 struct RequestStats {
@@ -59,122 +189,145 @@ struct RequestStats {
     uint32_t overflow = 0;
 };
 
+// Storage of an evicted texture or page that a launch may still sample; freed once
+// processRequests() has seen that launch finish
+struct RetiredStorage {
+    TextureRecord storage;  // Only the texture object, arrays and CPU mip chain are set
+    size_t bytes = 0;
+    uint32_t frame = 0;     // Launch that may still sample it
+};
+
+// Residency snapshot file: a header line, then one line per resident texture,
+// hottest first: "<age> <width> <height> <bytes> <filename>". Version 1 lines also
+// held the loaded mip level count, which warm starts never used: a texture loads at
+// the mip bias of the new session.
+static const char* kSnapshotMagic = "hip_demand-residency";
+static const int kSnapshotVersion = 2;
+
+struct SnapshotEntry {
+    uint32_t age = 0;  // Frames since last use when the snapshot was taken
+    int width = 0;
+    int height = 0;
+    size_t memoryUsage = 0;
+    std::string filename;
+};
+
+// Expand 8-bit interleaved pixels with 1-4+ channels to RGBA8
+static std::unique_ptr<uint8_t[]> expandToRGBA8(const uint8_t* src, size_t pixelCount, int channels) {
+    std::unique_ptr<uint8_t[]> dst(new uint8_t[pixelCount * 4]);
+    for (size_t i = 0; i < pixelCount; ++i) {
+        const uint8_t* p = src + i * channels;
+        uint8_t* q = dst.get() + i * 4;
+        if (channels == 1) {
+            q[0] = q[1] = q[2] = p[0];
+            q[3] = 255;
+        } else if (channels == 2) {
+            q[0] = q[1] = q[2] = p[0];
+            q[3] = p[1];
+        } else if (channels == 3) {
+            q[0] = p[0]; q[1] = p[1]; q[2] = p[2];
+            q[3] = 255;
+        } else {
+            q[0] = p[0]; q[1] = p[1]; q[2] = p[2]; q[3] = p[3];
+        }
+    }
+    return dst;
+}
+
 class DemandTextureLoader::Impl {
 public:
     explicit Impl(const LoaderOptions& opts) : options_(opts) {
-        hipError_t err = hipGetDevice(&device_);
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::HipError;
-            return;
-        }
-        
-        // Allocate device buffers
-        size_t flagWords = (options_.maxTextures + 31) / 32;
-        err = hipMalloc(&d_residentFlags_, flagWords * sizeof(uint32_t));
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::OutOfMemory;
-            return;
+        // Idle eviction measures idleness from the last frame a texture was sampled
+        if (options_.idleEvictionFrames > 0 && !options_.trackUsage) {
+            logMessage(LogLevel::Info, "DemandTextureLoader: idleEvictionFrames enables trackUsage");
+            options_.trackUsage = true;
         }
-        
-        err = hipMalloc(&d_textures_, options_.maxTextures * sizeof(hipTextureObject_t));
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::OutOfMemory;
-            hipFree(d_residentFlags_);
-            d_residentFlags_ = nullptr;
-            return;
+        // Thrash bias changes reload the resident textures that were sampled
+        if (options_.thrashWindowFrames > 0 && !options_.trackUsage) {
+            logMessage(LogLevel::Info, "DemandTextureLoader: thrashWindowFrames enables trackUsage");
+            options_.trackUsage = true;
         }
-        
-        err = hipMalloc(&d_requests_, options_.maxRequestsPerLaunch * sizeof(uint32_t));
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::OutOfMemory;
-            hipFree(d_textures_);
-            hipFree(d_residentFlags_);
-            d_textures_ = nullptr;
-            d_residentFlags_ = nullptr;
+        if (cpuBackend()) {
+            initCpuBuffers();
+        } else if (!initDeviceBuffers()) {
             return;
         }
 
-        err = hipMalloc(&d_requestStats_, sizeof(RequestStats));
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::OutOfMemory;
-            hipFree(d_requests_);
-            hipFree(d_textures_);
-            hipFree(d_residentFlags_);
-            d_requests_ = nullptr;
-            d_textures_ = nullptr;
-            d_residentFlags_ = nullptr;
-            return;
-        }
-        d_requestCount_ = reinterpret_cast<uint32_t*>(d_requestStats_);
-        d_requestOverflow_ = d_requestCount_ + 1;
-        
-        // Initialize to zero
-        err = hipMemset(d_residentFlags_, 0, flagWords * sizeof(uint32_t));
-        if (err != hipSuccess) lastError_ = LoaderError::HipError;
-        
-        err = hipMemset(d_textures_, 0, options_.maxTextures * sizeof(hipTextureObject_t));
-        if (err != hipSuccess) lastError_ = LoaderError::HipError;
-        
-        err = hipMemset(d_requestStats_, 0, sizeof(RequestStats));
-        if (err != hipSuccess) lastError_ = LoaderError::HipError;
-        
-        // Allocate host pinned buffers for async copies
-        flagWordCount_ = flagWords;
-        if (hipHostMalloc(reinterpret_cast<void**>(&h_residentFlags_), flagWords * sizeof(uint32_t)) != hipSuccess) {
-            lastError_ = LoaderError::OutOfMemory;
-            return;
-        }
-        if (hipHostMalloc(reinterpret_cast<void**>(&h_textures_), options_.maxTextures * sizeof(hipTextureObject_t)) != hipSuccess) {
-            lastError_ = LoaderError::OutOfMemory;
-            hipHostFree(h_residentFlags_);
-            h_residentFlags_ = nullptr;
-            return;
+        textures_.resize(options_.maxTextures);
+        budgetGroups_.push_back(BudgetGroup{"default"});
+        initBackgroundEviction();
+        thrashWindowEnd_ = options_.thrashWindowFrames;
+        initAtlas();
+        loadPool_ = std::make_unique<ThreadPool>(options_.maxThreads);
+        if (options_.ioQueueDepth > 0) {
+            fileReader_ = AsyncFileReader::create(options_.ioQueueDepth, options_.useIoUring);
+            logMessage(LogLevel::Debug, "DemandTextureLoader: async file reads via %s, queue depth %u",
+                       fileReader_->backendName(), options_.ioQueueDepth);
         }
-        if (hipHostMalloc(reinterpret_cast<void**>(&h_requests_), options_.maxRequestsPerLaunch * sizeof(uint32_t)) != hipSuccess) {
-            lastError_ = LoaderError::OutOfMemory;
-            hipHostFree(h_residentFlags_);
-            hipHostFree(h_textures_);
-            h_residentFlags_ = nullptr;
-            h_textures_ = nullptr;
-            return;
+        if (!options_.sharedCacheName.empty()) {
+            sharedCache_ = SharedTexelCache::open(options_.sharedCacheName, options_.sharedCacheBytes,
+                                                  options_.sharedCacheClaimTimeoutMs, options_.sharedCacheRemoveWhenUnused);
+            if (!sharedCache_) {
+                logMessage(LogLevel::Warn, "DemandTextureLoader: shared texel cache '%s' unavailable; decoding locally",
+                           options_.sharedCacheName.c_str());
+            }
         }
-        if (hipHostMalloc(reinterpret_cast<void**>(&h_requestStats_), sizeof(RequestStats)) != hipSuccess) {
-            lastError_ = LoaderError::OutOfMemory;
-            hipHostFree(h_residentFlags_);
-            hipHostFree(h_textures_);
-            hipHostFree(h_requests_);
-            h_residentFlags_ = nullptr;
-            h_textures_ = nullptr;
-            h_requests_ = nullptr;
-            return;
+        // Last: the arbiter may call back as soon as this loader joins
+        if (options_.memoryArbiter) {
+            arbiterMember_ = options_.memoryArbiter->join(options_.arbiterPriority,
+                                                          [this](size_t budget, bool evict) { onArbiterBudget(budget, evict); });
+            arbiterBudget_ = options_.memoryArbiter->report(*arbiterMember_, 0, 0);
         }
-
-        std::fill_n(h_residentFlags_, flagWords, 0u);
-        std::fill_n(h_textures_, options_.maxTextures, static_cast<hipTextureObject_t>(0));
-        std::fill_n(h_requests_, options_.maxRequestsPerLaunch, 0u);
-        h_requestStats_->count = 0;
-        h_requestStats_->overflow = 0;
-
-        textures_.resize(options_.maxTextures);
     }
     
     ~Impl() {
+        if (arbiterMember_) {
+            options_.memoryArbiter->leave(arbiterMember_);
+        }
+        fileReader_.reset();
+        loadPool_.reset();
+        stopTrace();
         unloadAll();
+        if (!retired_.empty()) {
+            // Nothing is read after the loader is gone, but a launch may still be in flight
+            if (!cpuBackend()) hipDeviceSynchronize();
+            for (RetiredStorage& r : retired_) {
+                releaseTextureStorage(r.storage);
+            }
+            retired_.clear();
+        }
+        if (cpuBackend()) {
+            return;  // Host storage is owned by the cpu* members
+        }
 
+        if (uploadEvent_) hipEventDestroy(uploadEvent_);
         if (h_residentFlags_) hipHostFree(h_residentFlags_);
         if (h_textures_) hipHostFree(h_textures_);
         if (h_requests_) hipHostFree(h_requests_);
         if (h_requestStats_) hipHostFree(h_requestStats_);
+        if (h_usedFlags_) hipHostFree(h_usedFlags_);
+        if (h_atlas_) hipHostFree(h_atlas_);
         
         if (d_residentFlags_) hipFree(d_residentFlags_);
         if (d_textures_) hipFree(d_textures_);
-        if (d_requests_) hipFree(d_requests_);
-        if (d_requestStats_) hipFree(d_requestStats_);
+        if (!mappedFeedback_) {
+            // Mapped feedback buffers are the host allocations freed above
+            if (d_requests_) hipFree(d_requests_);
+            if (d_requestStats_) hipFree(d_requestStats_);
+        }
+        if (d_usedFlags_) hipFree(d_usedFlags_);
+        if (d_atlas_) hipFree(d_atlas_);
     }
     
     TextureHandle createTexture(const std::string& filename, const TextureDesc& desc) {
         std::lock_guard<std::mutex> lock(mutex_);
         
+        if (desc.budgetGroup >= budgetGroups_.size()) {
+            lastError_ = LoaderError::InvalidParameter;
+            logMessage(LogLevel::Error, "createTexture: unknown budget group %u", desc.budgetGroup);
+            return TextureHandle{0, false, 0, 0, 0, lastError_};
+        }
+        
         if (nextTextureId_ >= options_.maxTextures) {
             lastError_ = LoaderError::MaxTexturesExceeded;
             logMessage(LogLevel::Error, "createTexture: max textures exceeded (%zu)", static_cast<size_t>(options_.maxTextures));
@@ -183,59 +336,28 @@ public:
         
         uint32_t id = nextTextureId_++;
         
-        TextureMetadata& info = textures_[id];
+        textures_.records[id] = std::make_unique<TextureRecord>();
+        TextureRecord& info = *textures_.records[id];
         info.filename = filename;
         info.desc = desc;
-        info.resident = false;
+        textures_.budgetGroup[id] = static_cast<uint8_t>(desc.budgetGroup);
         
-        // Try to get image dimensions without loading
-#ifdef USE_OIIO
-        // Try OIIO first for better format support
-        try {
-            std::unique_ptr<ImageSource> imgSrc = createImageSource(filename);
-            if (imgSrc) {
-                hip_demand::TextureInfo texInfo;
-                imgSrc->open(&texInfo);
-                if (imgSrc->isOpen()) {
-                    info.width = texInfo.width;
-                    info.height = texInfo.height;
-                    info.channels = 4;  // OIIO always converts to RGBA
-                    imgSrc->close();
-                } else {
-                    // Fall back to stb_image
-                    int w, h, c;
-                    if (stbi_info(filename.c_str(), &w, &h, &c)) {
-                        info.width = w;
-                        info.height = h;
-                        info.channels = c;
-                    } else {
-                        info.lastError = LoaderError::FileNotFound;
-                    }
-                }
-            }
-        } catch (...) {
-            // Fall back to stb_image on any exception
-            int w, h, c;
-            if (stbi_info(filename.c_str(), &w, &h, &c)) {
-                info.width = w;
-                info.height = h;
-                info.channels = c;
-            } else {
-                info.lastError = LoaderError::FileNotFound;
-            }
-        }
-#else
-        int w, h, c;
-        if (stbi_info(filename.c_str(), &w, &h, &c)) {
-            info.width = w;
-            info.height = h;
-            info.channels = c;
+        // Sniff the format and read the header once; both are cached for load time
+        info.readerName.clear();
+        info.sourceInfo = hip_demand::TextureInfo();
+        info.lastError = readImageInfo(filename, info.readerName, info.sourceInfo);
+        if (info.lastError == LoaderError::Success) {
+            info.width = static_cast<int>(info.sourceInfo.width);
+            info.height = static_cast<int>(info.sourceInfo.height);
+            info.channels = static_cast<int>(info.sourceInfo.numChannels);
+            textures_.estimatedBytes[id] = calculateMipmapMemory(info.width, info.height, 4);
+            info.baseMipBias = resolutionBias(info);
+            assignToAtlas(id);
         } else {
-            info.lastError = LoaderError::FileNotFound;
-            logMessage(LogLevel::Warn, "createTexture: file not found '%s'", filename.c_str());
+            logMessage(LogLevel::Warn, "createTexture: cannot read '%s': %s", filename.c_str(), getErrorString(info.lastError));
         }
-#endif
         
+        traceTexture(id);
         lastError_ = LoaderError::Success;
         logMessage(LogLevel::Debug, "createTexture: queued '%s' as id=%u (%dx%d ch=%d)", filename.c_str(), id, info.width, info.height, info.channels);
         return TextureHandle{id, true, info.width, info.height, info.channels, LoaderError::Success};
@@ -245,9 +367,9 @@ public:
                                          int channels, const TextureDesc& desc) {
         std::lock_guard<std::mutex> lock(mutex_);
         
-        if (!data || width <= 0 || height <= 0 || channels <= 0) {
+        if (!data || width <= 0 || height <= 0 || channels <= 0 || desc.budgetGroup >= budgetGroups_.size()) {
             lastError_ = LoaderError::InvalidParameter;
-            logMessage(LogLevel::Error, "createTextureFromMemory: invalid parameters (w=%d h=%d ch=%d)", width, height, channels);
+            logMessage(LogLevel::Error, "createTextureFromMemory: invalid parameters (w=%d h=%d ch=%d group=%u)", width, height, channels, desc.budgetGroup);
             return TextureHandle{0, false, 0, 0, 0, lastError_};
         }
         
@@ -259,45 +381,148 @@ public:
         
         uint32_t id = nextTextureId_++;
         
-        TextureMetadata& info = textures_[id];
+        textures_.records[id] = std::make_unique<TextureRecord>();
+        TextureRecord& info = *textures_.records[id];
         info.filename = "";  // Memory-based texture
         info.desc = desc;
+        textures_.budgetGroup[id] = static_cast<uint8_t>(desc.budgetGroup);
         info.width = width;
         info.height = height;
         info.channels = channels;
-        info.resident = false;
+        textures_.estimatedBytes[id] = calculateMipmapMemory(width, height, 4);
         
         // Cache the data
         size_t dataSize = width * height * channels;
         info.cachedData = std::make_unique<uint8_t[]>(dataSize);
         std::memcpy(info.cachedData.get(), data, dataSize);
+        info.baseMipBias = resolutionBias(info);
+        assignToAtlas(id);
         
+        traceTexture(id);
         lastError_ = LoaderError::Success;
         logMessage(LogLevel::Debug, "createTextureFromMemory: created id=%u (%dx%d ch=%d)", id, width, height, channels);
         return TextureHandle{id, true, width, height, channels, LoaderError::Success};
     }
     
+    std::vector<TextureHandle> createTexturesFromPack(const std::string& packPath, const TextureDesc& desc) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<TextureHandle> handles;
+        if (desc.budgetGroup >= budgetGroups_.size()) {
+            lastError_ = LoaderError::InvalidParameter;
+            logMessage(LogLevel::Error, "createTexturesFromPack: unknown budget group %u", desc.budgetGroup);
+            return handles;
+        }
+
+        // One open and one mapping for the whole pack; entries need no sniffing or header reads
+        std::string error;
+        std::shared_ptr<TexturePack> pack = TexturePack::openShared(packPath, &error);
+        if (!pack) {
+            lastError_ = sniffImageSource(packPath).readable ? LoaderError::ImageLoadFailed : LoaderError::FileNotFound;
+            logMessage(LogLevel::Error, "createTexturesFromPack: %s", error.c_str());
+            return handles;
+        }
+
+        lastError_ = LoaderError::Success;
+        handles.reserve(pack->getEntryCount());
+        for (size_t i = 0; i < pack->getEntryCount(); ++i) {
+            if (nextTextureId_ >= options_.maxTextures) {
+                lastError_ = LoaderError::MaxTexturesExceeded;
+                logMessage(LogLevel::Error, "createTexturesFromPack: max textures exceeded (%zu) after %zu of %zu entries", static_cast<size_t>(options_.maxTextures), i, pack->getEntryCount());
+                break;
+            }
+            const PackEntry& entry = pack->getEntry(i);
+            uint32_t id = nextTextureId_++;
+
+            textures_.records[id] = std::make_unique<TextureRecord>();
+            TextureRecord& info = *textures_.records[id];
+            info.filename = TexturePack::makeEntryPath(packPath, entry.name);
+            info.desc = desc;
+            textures_.budgetGroup[id] = static_cast<uint8_t>(desc.budgetGroup);
+            info.readerName = "pack";
+            info.sourceInfo = TexturePack::getTextureInfo(entry);
+            info.width = static_cast<int>(entry.width);
+            info.height = static_cast<int>(entry.height);
+            info.channels = static_cast<int>(entry.numChannels);
+            textures_.estimatedBytes[id] = calculateMipmapMemory(info.width, info.height, 4);
+            info.baseMipBias = resolutionBias(info);
+            assignToAtlas(id);
+
+            traceTexture(id);
+            handles.push_back(TextureHandle{id, true, info.width, info.height, info.channels, LoaderError::Success});
+        }
+        packs_.push_back(std::move(pack));
+        logMessage(LogLevel::Info, "createTexturesFromPack: '%s' -> %zu textures", packPath.c_str(), handles.size());
+        return handles;
+    }
+
     void launchPrepare(hipStream_t stream) {
+        // CPU render threads read the host arrays a background eviction edits. The uploads below
+        // read the pinned tables when the stream reaches them, so edits made before then wait
+        // for uploadEvent_ (see waitForTableUploads); storage evicted after them is retired
+        // until the launch finishes.
+        if (cpuBackend()) {
+            waitForBackgroundEviction();
+            if (arbiterEvictPending_.exchange(false, std::memory_order_relaxed)) {
+                runBackgroundEviction();
+            }
+        }
         std::lock_guard<std::mutex> lock(mutex_);
-        
-        // Upload resident flags and texture array
-        size_t flagWords = (options_.maxTextures + 31) / 32;
-        hipError_t err = hipMemcpyAsync(d_residentFlags_, h_residentFlags_, 
-                  flagWords * sizeof(uint32_t), 
-                      hipMemcpyHostToDevice, stream);
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::HipError;
-            logMessage(LogLevel::Error, "launchPrepare: hipMemcpyAsync(residentFlags) failed: %s", hipGetErrorString(err));
+        if (cpuBackend()) {
+            prepareCpuLaunch();
+            currentFrame_++;
+            logMessage(LogLevel::Debug, "launchPrepare: frame=%u (cpu) usedRuns=%zu", currentFrame_, usedRuns_.size());
             return;
         }
         
-        err = hipMemcpyAsync(d_textures_, h_textures_, 
-                      options_.maxTextures * sizeof(hipTextureObject_t),
-                      hipMemcpyHostToDevice, stream);
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::HipError;
-            logMessage(LogLevel::Error, "launchPrepare: hipMemcpyAsync(textures) failed: %s", hipGetErrorString(err));
-            return;
+        // Upload only the residency blocks (flag words, summary bits, texture objects)
+        // changed since the last launch
+        residency_.takeDirtyRuns(uploadRuns_, kMaxTransferRuns);
+        bool tablesUploaded = !uploadRuns_.empty();
+        hipError_t err = hipSuccess;
+        for (const ResidencyBitmap::Run& run : uploadRuns_) {
+            size_t firstWord = run.firstBlock * 32;
+            size_t firstTex = run.firstBlock * ResidencyBitmap::kTexturesPerBlock;
+            size_t texCount = std::min(run.blockCount * ResidencyBitmap::kTexturesPerBlock, options_.maxTextures - firstTex);
+            err = hipMemcpyAsync(d_residentFlags_ + firstWord, h_residentFlags_ + firstWord,
+                                 runWordCount(run) * sizeof(uint32_t), hipMemcpyHostToDevice, stream);
+            if (err == hipSuccess) {
+                err = hipMemcpyAsync(d_residentSummary_ + run.firstBlock, h_residentFlags_ + flagWordCount_ + run.firstBlock,
+                                     run.blockCount * sizeof(uint32_t), hipMemcpyHostToDevice, stream);
+            }
+            if (err == hipSuccess) {
+                err = hipMemcpyAsync(d_textures_ + firstTex, h_textures_ + firstTex,
+                                     texCount * sizeof(hipTextureObject_t), hipMemcpyHostToDevice, stream);
+            }
+            if (err != hipSuccess) {
+                residency_.markAllDirty();
+                lastError_ = LoaderError::HipError;
+                logMessage(LogLevel::Error, "launchPrepare: hipMemcpyAsync(residency) failed: %s", hipGetErrorString(err));
+                return;
+            }
+        }
+        
+        // Atlas mappings of textures placed in pages loaded since the last launch
+        if (d_atlas_ && atlasDirtyBegin_ < atlasDirtyEnd_) {
+            err = hipMemcpyAsync(d_atlas_ + atlasDirtyBegin_, h_atlas_ + atlasDirtyBegin_,
+                                 (atlasDirtyEnd_ - atlasDirtyBegin_) * sizeof(AtlasMapping), hipMemcpyHostToDevice, stream);
+            if (err != hipSuccess) {
+                lastError_ = LoaderError::HipError;
+                logMessage(LogLevel::Error, "launchPrepare: hipMemcpyAsync(atlas) failed: %s", hipGetErrorString(err));
+                return;
+            }
+            atlasDirtyBegin_ = UINT32_MAX;
+            atlasDirtyEnd_ = 0;
+            tablesUploaded = true;
+        }
+        if (tablesUploaded) {
+            err = hipEventRecord(uploadEvent_, stream);
+            if (err != hipSuccess) {
+                lastError_ = LoaderError::HipError;
+                logMessage(LogLevel::Error, "launchPrepare: hipEventRecord(upload) failed: %s", hipGetErrorString(err));
+                hipStreamSynchronize(stream);
+                return;
+            }
+            uploadsPending_ = true;
         }
         
         // Reset request counter and overflow flag
@@ -307,36 +532,126 @@ public:
             logMessage(LogLevel::Error, "launchPrepare: hipMemsetAsync(requestStats) failed: %s", hipGetErrorString(err));
             return;
         }
+
+        // Only resident textures can be marked used, so only their blocks are cleared here
+        // and downloaded in processRequests
+        if (d_usedFlags_) {
+            residency_.residentRuns(usedRuns_, kMaxTransferRuns);
+            for (const ResidencyBitmap::Run& run : usedRuns_) {
+                err = hipMemsetAsync(d_usedFlags_ + run.firstBlock * 32, 0, runWordCount(run) * sizeof(uint32_t), stream);
+                if (err != hipSuccess) {
+                    usedRuns_.clear();
+                    lastError_ = LoaderError::HipError;
+                    logMessage(LogLevel::Error, "launchPrepare: hipMemsetAsync(usedFlags) failed: %s", hipGetErrorString(err));
+                    return;
+                }
+            }
+        }
         
         currentFrame_++;
-        logMessage(LogLevel::Debug, "launchPrepare: frame=%u", currentFrame_);
+        logMessage(LogLevel::Debug, "launchPrepare: frame=%u uploadRuns=%zu usedRuns=%zu", currentFrame_, uploadRuns_.size(), usedRuns_.size());
     }
     
+    CpuDemandTextureContext getCpuContext() const {
+        CpuDemandTextureContext ctx;
+        if (!cpuBackend()) return ctx;
+        ctx.residentFlags = h_residentFlags_;
+        ctx.residentSummary = h_residentFlags_ + flagWordCount_;
+        ctx.textures = cpuTextures_.data();
+        ctx.requests = h_requests_;
+        ctx.requestCount = &cpuRequestCount_;
+        ctx.requestOverflow = &cpuRequestOverflow_;
+        ctx.requestedFlags = cpuRequestedFlags_.get();
+        ctx.usedFlags = cpuUsedFlags_.get();
+        ctx.atlas = h_atlas_;
+        ctx.maxTextures = static_cast<uint32_t>(options_.maxTextures);
+        ctx.maxRequests = static_cast<uint32_t>(options_.maxRequestsPerLaunch);
+        return ctx;
+    }
+
     DeviceContext getDeviceContext() const {
         DeviceContext ctx;
         ctx.residentFlags = d_residentFlags_;
+        ctx.residentSummary = d_residentSummary_;
         ctx.textures = d_textures_;
         ctx.requests = d_requests_;
         ctx.requestCount = d_requestCount_;
         ctx.requestOverflow = d_requestOverflow_;
+        ctx.usedFlags = d_usedFlags_;
+        ctx.atlas = d_atlas_;
         ctx.maxTextures = options_.maxTextures;
         ctx.maxRequests = options_.maxRequestsPerLaunch;
         return ctx;
     }
     
     size_t processRequests(hipStream_t stream) {
-        // Download request count and overflow flag in one transfer
-        hipError_t err = hipMemcpyAsync(h_requestStats_, d_requestStats_, sizeof(RequestStats),
-                      hipMemcpyDeviceToHost, stream);
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::HipError;
-            return 0;
+        size_t loaded = loadRequestedTextures(stream);
+        scheduleBackgroundEviction();
+        return loaded;
+    }
+
+private:
+    size_t loadRequestedTextures(hipStream_t stream) {
+        std::vector<ResidencyBitmap::Run> usedRuns;
+        hipError_t err = hipSuccess;
+        if (cpuBackend()) {
+            gatherCpuRequests(usedRuns);
+        } else if (!mappedFeedback_) {
+            // Download request count and overflow flag in one transfer
+            err = hipMemcpyAsync(h_requestStats_, d_requestStats_, sizeof(RequestStats),
+                          hipMemcpyDeviceToHost, stream);
+            if (err != hipSuccess) {
+                lastError_ = LoaderError::HipError;
+                return 0;
+            }
+        }
+
+        // Usage bits of the blocks cleared in launchPrepare ride along with the stats; no extra sync
+        if (d_usedFlags_) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                usedRuns = usedRuns_;
+            }
+            for (const ResidencyBitmap::Run& run : usedRuns) {
+                size_t firstWord = run.firstBlock * 32;
+                err = hipMemcpyAsync(h_usedFlags_ + firstWord, d_usedFlags_ + firstWord, runWordCount(run) * sizeof(uint32_t),
+                                     hipMemcpyDeviceToHost, stream);
+                if (err != hipSuccess) {
+                    lastError_ = LoaderError::HipError;
+                    return 0;
+                }
+            }
         }
         
-        err = hipStreamSynchronize(stream);
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::HipError;
-            return 0;
+        // With mapped feedback this is the only sync: once the kernel is done its writes are in host memory
+        if (!cpuBackend()) {
+            err = hipStreamSynchronize(stream);
+            if (err != hipSuccess) {
+                lastError_ = LoaderError::HipError;
+                return 0;
+            }
+        }
+        releaseRetiredStorage();
+
+        // Refresh LRU age of textures sampled this frame
+        std::vector<uint32_t> used;
+        if (h_usedFlags_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const ResidencyBitmap::Run& run : usedRuns) {
+                size_t firstWord = run.firstBlock * 32;
+                for (size_t w = firstWord; w < firstWord + runWordCount(run); ++w) {
+                    for (uint32_t bits = h_usedFlags_[w]; bits; bits &= bits - 1) {
+                        uint32_t texId = static_cast<uint32_t>(w * 32) + ResidencyBitmap::countTrailingZeros(bits);
+                        if (texId < nextTextureId_ && textures_.isResident(texId)) {
+                            textures_.lastUsedFrame[texId] = currentFrame_;
+                            if (uint32_t page = textures_.atlasPage[texId]) {
+                                atlasPages_[page - 1]->lastUsedFrame = currentFrame_;
+                            }
+                            used.push_back(texId);
+                        }
+                    }
+                }
+            }
         }
         
         uint32_t requestCount = h_requestStats_->count;
@@ -349,82 +664,145 @@ public:
         logMessage(LogLevel::Debug, "processRequests: requestCount=%u", requestCount);
         
         if (requestCount == 0) {
-            return 0;
+            // Pinned textures may still need loading, sampled ones reloading at a changed mip bias
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pins_.empty() && biasedResidentCount_ == 0 && thrashMipBias_ == 0) {
+                if (trace_ && !used.empty()) trace_->writeRequests(currentFrame_, used);
+                // A loader that stopped missing still reports, so its demand decays
+                if (arbiterMember_) reportArbiterDemand(used, 0);
+                return 0;
+            }
         }
         
-        // Download requests
+        // Download requests (the CPU queue and mapped feedback already are h_requests_)
         requestCount = std::min(requestCount, (uint32_t)options_.maxRequestsPerLaunch);
-        err = hipMemcpyAsync(h_requests_, d_requests_, 
-                      requestCount * sizeof(uint32_t),
-                      hipMemcpyDeviceToHost, stream);
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::HipError;
-            return 0;
-        }
-        
-        err = hipStreamSynchronize(stream);
-        if (err != hipSuccess) {
-            lastError_ = LoaderError::HipError;
-            return 0;
+        if (!cpuBackend() && !mappedFeedback_ && requestCount > 0) {
+            err = hipMemcpyAsync(h_requests_, d_requests_, 
+                          requestCount * sizeof(uint32_t),
+                          hipMemcpyDeviceToHost, stream);
+            if (err != hipSuccess) {
+                lastError_ = LoaderError::HipError;
+                return 0;
+            }
+            
+            err = hipStreamSynchronize(stream);
+            if (err != hipSuccess) {
+                lastError_ = LoaderError::HipError;
+                return 0;
+            }
         }
         
         // Deduplicate requests and gather texture info under lock
-        std::unordered_set<uint32_t> uniqueRequests;
+        std::unordered_set<uint32_t> uniqueRequests(used.begin(), used.end());
+        std::unordered_set<uint32_t> requestedPages;
         std::vector<uint32_t> toLoad;
         size_t estimatedMemoryNeeded = 0;
+        std::vector<size_t> groupMemoryNeeded;
+        auto now = std::chrono::steady_clock::now();
         
         {
             std::lock_guard<std::mutex> lock(mutex_);
             
+            std::vector<uint32_t> requested = used;
+            groupMemoryNeeded.assign(budgetGroups_.size(), 0);
+            updateThrashBias();
             for (size_t i = 0; i < requestCount; ++i) {
                 uint32_t texId = h_requests_[i];
-                if (texId < nextTextureId_ && !textures_[texId].resident) {
-                    if (uniqueRequests.insert(texId).second) {
-                        toLoad.push_back(texId);
-                        // Calculate actual memory needed
-                        const TextureMetadata& info = textures_[texId];
-                        int w = info.width;
-                        int h = info.height;
-                        if (w > 0 && h > 0) {
-                            size_t mipMemory = calculateMipmapMemory(w, h, 4);
-                            estimatedMemoryNeeded += mipMemory;
+                if (texId < nextTextureId_ && uniqueRequests.insert(texId).second) {
+                    requested.push_back(texId);
+                    if (!textures_.isResident(texId)) {
+                        if ((textures_.state[texId] & kTextureFailed) && !retryDue(texId)) {
+                            noteMiss(texId, now);
+                            suppressedRetries_++;
+                            continue;
                         }
+                        // Atlas members load with their page, once per page. A member missing
+                        // from a resident page failed when it loaded and waits for a reload.
+                        if (uint32_t page = textures_.atlasPage[texId]) {
+                            const AtlasPage& p = *atlasPages_[page - 1];
+                            noteMiss(texId, now);
+                            if (p.resident) {
+                                suppressedRetries_++;
+                            } else if (!p.loading && requestedPages.insert(page).second) {
+                                toLoad.push_back(texId);
+                                estimatedMemoryNeeded += atlasPageBytes(p);
+                                groupMemoryNeeded[textures_.budgetGroup[texId]] += atlasPageBytes(p);
+                            }
+                            continue;
+                        }
+                        toLoad.push_back(texId);
+                        size_t bytes = loadEstimate(texId);
+                        estimatedMemoryNeeded += bytes;
+                        groupMemoryNeeded[textures_.budgetGroup[texId]] += bytes;
+                        noteMiss(texId, now);
+                        noteThrashLoad(texId);
+                    }
+                }
+            }
+            // Pinned textures load without waiting for a request
+            expirePinLeases();
+            for (const auto& entry : pins_) {
+                uint32_t texId = entry.first;
+                if (uniqueRequests.count(texId) || textures_.isBusy(texId)) continue;
+                if ((textures_.state[texId] & kTextureFailed) && !retryDue(texId)) continue;
+                if (uint32_t page = textures_.atlasPage[texId]) {
+                    const AtlasPage& p = *atlasPages_[page - 1];
+                    if (!p.resident && !p.loading && requestedPages.insert(page).second) {
+                        toLoad.push_back(texId);
+                        estimatedMemoryNeeded += atlasPageBytes(p);
+                        groupMemoryNeeded[textures_.budgetGroup[texId]] += atlasPageBytes(p);
                     }
+                    continue;
                 }
+                toLoad.push_back(texId);
+                size_t bytes = loadEstimate(texId);
+                estimatedMemoryNeeded += bytes;
+                groupMemoryNeeded[textures_.budgetGroup[texId]] += bytes;
+            }
+            queueMipBiasReloads(used, toLoad, estimatedMemoryNeeded, groupMemoryNeeded);
+            if (trace_) {
+                trace_->writeRequests(currentFrame_, requested);
             }
             logMessage(LogLevel::Debug, "processRequests: unique-to-load=%zu estMem=%.2f MB", toLoad.size(), static_cast<double>(estimatedMemoryNeeded) / (1024.0 * 1024.0));
+            if (arbiterMember_) {
+                reportArbiterDemand(used, estimatedMemoryNeeded);
+            }
             
             // Check if we need eviction (with actual size estimates). A maxTextureMemory of 0 means
-            // "no budget", so skip eviction entirely in that case.
-            if (options_.enableEviction && options_.maxTextureMemory > 0 && estimatedMemoryNeeded > 0) {
-                evictIfNeeded(estimatedMemoryNeeded);
+            // "no budget"; only capped budget groups evict then.
+            if (options_.enableEviction && estimatedMemoryNeeded > 0) {
+                evictIfNeeded(groupMemoryNeeded, estimatedMemoryNeeded);
             }
         }
         
         // Load textures outside the lock to allow concurrency
-        size_t loaded = 0;
-        for (uint32_t texId : toLoad) {
-            if (loadTextureThreadSafe(texId)) {
-                loaded++;
-            }
-        }
-        
-        return loaded;
+        return loadBatch(toLoad);
     }
+
+public:
     
     size_t getResidentTextureCount() const {
         std::lock_guard<std::mutex> lock(mutex_);
-        size_t count = 0;
-        for (uint32_t i = 0; i < nextTextureId_; ++i) {
-            if (textures_[i].resident) count++;
-        }
-        return count;
+        return residency_.count();
     }
-    
-    size_t getTotalTextureMemory() const {
+
+    std::vector<uint32_t> getResidentTextureIds() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<uint32_t> ids;
+        ids.reserve(residency_.count());
+        residency_.forEach([&](uint32_t texId) { ids.push_back(texId); });
+        return ids;
+    }
+    
+    size_t getTotalTextureMemory() const {
         std::lock_guard<std::mutex> lock(mutex_);
         return totalMemoryUsage_;
     }
+
+    size_t getRetiredTextureMemory() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return retiredMemory_;
+    }
     
     size_t getRequestCount() const {
         return lastRequestCount_;
@@ -437,7 +815,231 @@ public:
     LoaderError getLastError() const {
         return lastError_;
     }
+
+    size_t getFailedTextureCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return failedTextureCount_;
+    }
+
+    uint64_t getSuppressedRetryCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return suppressedRetries_;
+    }
+
+    LoaderError getTextureError(uint32_t texId) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (texId >= nextTextureId_) {
+            return LoaderError::InvalidTextureId;
+        }
+        return textures_.records[texId]->lastError;
+    }
+
+    void retryFailedTextures() {
+        std::vector<std::string> failedFiles;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (uint32_t i = 0; i < nextTextureId_; ++i) {
+                if (textures_.state[i] & kTextureFailed) {
+                    clearFailure(i, *textures_.records[i]);
+                    failedFiles.push_back(textures_.records[i]->filename);
+                }
+            }
+        }
+#ifdef USE_OIIO
+        // The files may have been fixed on disk; reopen them rather than reuse cached handles
+        for (const std::string& filename : failedFiles) {
+            OIIOReader::invalidateFile(filename);
+        }
+#endif
+    }
+
+    LatencyReport getLatencyReport() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        LatencyReport report;
+        report.all = latencyStats(latencyFrames_[kTextureSizeClassCount], latencyMicros_[kTextureSizeClassCount]);
+        for (size_t c = 0; c < kTextureSizeClassCount; ++c) {
+            report.bySizeClass[c] = latencyStats(latencyFrames_[c], latencyMicros_[c]);
+        }
+        report.pending = latencyPending_;
+        return report;
+    }
+
+    TextureLatency getTextureLatency(uint32_t texId) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        TextureLatency result;
+        if (texId >= nextTextureId_) {
+            return result;
+        }
+        const MissTimeline& t = textures_.records[texId]->latency;
+        result.pending = (textures_.state[texId] & kTextureMissPending) != 0;
+        result.measured = t.measured && !result.pending;
+        result.missFrame = t.missFrame;
+        result.loadStartFrame = t.loadStarted ? t.loadStartFrame : 0;
+        if (result.measured) {
+            result.residentFrame = t.residentFrame;
+            result.frames = t.residentFrame + 1 - t.missFrame;
+            result.queueMillis = t.queueMicros / 1000.0;
+            result.totalMillis = t.totalMicros / 1000.0;
+        }
+        return result;
+    }
+
+    void resetLatencyStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (LatencyHistogram& h : latencyFrames_) h.clear();
+        for (LatencyHistogram& h : latencyMicros_) h.clear();
+    }
     
+    AtlasStats getAtlasStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        AtlasStats stats;
+        uint64_t textureTexels = 0;
+        uint64_t placedTexels = 0;
+        uint64_t pageTexels = 0;
+        for (const auto& page : atlasPages_) {
+            stats.pageCount++;
+            stats.textureCount += page->members.size();
+            if (page->resident) {
+                stats.residentPageCount++;
+                stats.residentBytes += page->memoryUsage;
+            }
+            textureTexels += page->texelArea;
+            placedTexels += page->packer.placedArea();
+            pageTexels += static_cast<uint64_t>(page->packer.usedWidth()) * page->packer.usedHeight();
+        }
+        if (pageTexels > 0) {
+            stats.packingEfficiency = static_cast<double>(textureTexels) / pageTexels;
+            stats.gutterOverhead = static_cast<double>(placedTexels - textureTexels) / textureTexels;
+            stats.freeSpace = static_cast<double>(pageTexels - placedTexels) / pageTexels;
+        }
+        return stats;
+    }
+
+    uint32_t createBudgetGroup(const std::string& name, size_t minBytes, size_t maxBytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool taken = std::any_of(budgetGroups_.begin(), budgetGroups_.end(),
+                                 [&](const BudgetGroup& g) { return g.name == name; });
+        if (taken || (maxBytes > 0 && minBytes > maxBytes) || budgetGroups_.size() >= kMaxBudgetGroups) {
+            lastError_ = LoaderError::InvalidParameter;
+            logMessage(LogLevel::Error, "createBudgetGroup: cannot create '%s' (%s)", name.c_str(),
+                       taken ? "name in use" : budgetGroups_.size() >= kMaxBudgetGroups ? "too many groups" : "min > max");
+            return kInvalidBudgetGroup;
+        }
+        BudgetGroup group;
+        group.name = name;
+        group.minBytes = minBytes;
+        group.maxBytes = maxBytes;
+        budgetGroups_.push_back(std::move(group));
+        logMessage(LogLevel::Info, "createBudgetGroup: '%s' id=%zu min=%.2f MB max=%.2f MB", name.c_str(), budgetGroups_.size() - 1, static_cast<double>(minBytes) / (1024.0 * 1024.0), static_cast<double>(maxBytes) / (1024.0 * 1024.0));
+        return static_cast<uint32_t>(budgetGroups_.size() - 1);
+    }
+
+    bool setBudgetGroupLimits(uint32_t group, size_t minBytes, size_t maxBytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (group >= budgetGroups_.size() || (maxBytes > 0 && minBytes > maxBytes)) {
+            lastError_ = LoaderError::InvalidParameter;
+            return false;
+        }
+        budgetGroups_[group].minBytes = minBytes;
+        budgetGroups_[group].maxBytes = maxBytes;
+        return true;
+    }
+
+    std::vector<BudgetGroupStats> getBudgetGroupStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<BudgetGroupStats> stats;
+        stats.reserve(budgetGroups_.size());
+        for (const BudgetGroup& g : budgetGroups_) {
+            BudgetGroupStats gs;
+            gs.name = g.name;
+            gs.minBytes = g.minBytes;
+            gs.maxBytes = g.maxBytes;
+            gs.memoryUsage = g.memoryUsage;
+            gs.residentCount = g.residentCount;
+            gs.evictionCount = g.evictionCount;
+            stats.push_back(std::move(gs));
+        }
+        return stats;
+    }
+
+    bool pinTexture(uint32_t texId, uint32_t frames) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (texId >= nextTextureId_) {
+            lastError_ = LoaderError::InvalidTextureId;
+            return false;
+        }
+        PinRecord& pin = pins_[texId];
+        if (frames == 0) {
+            pin.count++;
+        } else {
+            uint32_t end = currentFrame_ + 1 + frames;
+            if (!pin.leased || static_cast<int32_t>(end - pin.leaseEndFrame) > 0) {
+                pin.leaseEndFrame = end;
+            }
+            pin.leased = true;
+        }
+        setPinned(texId, true);
+        return true;
+    }
+
+    bool unpinTexture(uint32_t texId) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = pins_.find(texId);
+        if (it == pins_.end() || it->second.count == 0) {
+            logMessage(LogLevel::Warn, "unpinTexture: texId=%u is not pinned", texId);
+            return false;
+        }
+        it->second.count--;
+        if (it->second.count == 0 && !it->second.leased) {
+            pins_.erase(it);
+            setPinned(texId, false);
+        }
+        return true;
+    }
+
+    bool isTexturePinned(uint32_t texId) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return texId < nextTextureId_ && (textures_.state[texId] & kTexturePinned) != 0;
+    }
+
+    size_t getPinnedTextureCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pins_.size();
+    }
+
+    size_t getPinnedTextureMemory() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pinnedMemory();
+    }
+
+    ThrashStats getThrashStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ThrashStats stats;
+        stats.mipBias = thrashMipBias_;
+        stats.loads = thrashLoads_;
+        stats.reloads = thrashReloads_;
+        stats.lastReloadRate = lastReloadRate_;
+        return stats;
+    }
+
+    uint32_t getTextureMipBias(uint32_t texId) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (texId >= nextTextureId_ || !textures_.isResident(texId)) return 0;
+        return textures_.records[texId]->loadedMipBias;
+    }
+
+    SharedCacheStats getSharedCacheStats() const {
+        SharedCacheStats stats;
+        if (!sharedCache_) return stats;
+        stats.enabled = true;
+        stats.segmentBytes = sharedCache_->segmentBytes();
+        stats.hits = sharedCache_->hits();
+        stats.publishes = sharedCache_->publishes();
+        stats.waits = sharedCache_->waits();
+        stats.bypasses = sharedCache_->bypasses();
+        return stats;
+    }
+
     void enableEviction(bool enable) {
         std::lock_guard<std::mutex> lock(mutex_);
         options_.enableEviction = enable;
@@ -446,13 +1048,155 @@ public:
     void setMaxTextureMemory(size_t bytes) {
         std::lock_guard<std::mutex> lock(mutex_);
         options_.maxTextureMemory = bytes;
+        if (trace_) {
+            trace_->writeBudget(currentFrame_, bytes);
+        }
     }
     
     size_t getMaxTextureMemory() const {
         std::lock_guard<std::mutex> lock(mutex_);
         return options_.maxTextureMemory;
     }
+
+    size_t getMemoryBudget() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return memoryBudget();
+    }
     
+    bool startTrace(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto writer = std::make_unique<RequestTraceWriter>();
+        if (!writer->open(path)) {
+            lastError_ = LoaderError::FileNotFound;
+            logMessage(LogLevel::Error, "startTrace: cannot write '%s'", path.c_str());
+            return false;
+        }
+        trace_ = std::move(writer);
+        trace_->writeBudget(currentFrame_, options_.maxTextureMemory);
+
+        // Describe textures created before tracing started
+        for (uint32_t i = 0; i < nextTextureId_; ++i) {
+            traceTexture(i);
+        }
+        if (!options_.trackUsage) {
+            logMessage(LogLevel::Warn, "startTrace: without trackUsage the trace records misses only");
+        }
+        logMessage(LogLevel::Info, "startTrace: recording to '%s'", path.c_str());
+        return true;
+    }
+
+    void stopTrace() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!trace_) return;
+        if (!trace_->good()) {
+            lastError_ = LoaderError::FileNotFound;
+            logMessage(LogLevel::Warn, "stopTrace: trace write failed; file is truncated");
+        }
+        logMessage(LogLevel::Info, "stopTrace: %llu events recorded", static_cast<unsigned long long>(trace_->getEventCount()));
+        trace_.reset();
+    }
+
+    bool saveResidencySnapshot(const std::string& path) {
+        std::vector<SnapshotEntry> entries;
+        uint32_t frame;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            frame = currentFrame_;
+            residency_.forEach([&](uint32_t texId) {
+                const TextureRecord& info = *textures_.records[texId];
+                if (info.filename.empty()) return;
+                SnapshotEntry e;
+                e.age = currentFrame_ - textures_.lastUsedFrame[texId];
+                e.width = info.width;
+                e.height = info.height;
+                e.memoryUsage = textures_.memoryUsage[texId];
+                e.filename = info.filename;
+                entries.push_back(std::move(e));
+            });
+        }
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const SnapshotEntry& a, const SnapshotEntry& b) { return a.age < b.age; });
+
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            lastError_ = LoaderError::FileNotFound;
+            logMessage(LogLevel::Error, "saveResidencySnapshot: cannot write '%s'", path.c_str());
+            return false;
+        }
+        out << kSnapshotMagic << " " << kSnapshotVersion << " " << frame << "\n";
+        for (const SnapshotEntry& e : entries) {
+            out << e.age << " " << e.width << " " << e.height << " "
+                << e.memoryUsage << " " << e.filename << "\n";
+        }
+        out.flush();
+        if (!out) {
+            lastError_ = LoaderError::FileNotFound;
+            logMessage(LogLevel::Error, "saveResidencySnapshot: write to '%s' failed", path.c_str());
+            return false;
+        }
+        logMessage(LogLevel::Info, "saveResidencySnapshot: wrote %zu textures to '%s'", entries.size(), path.c_str());
+        return true;
+    }
+
+    size_t warmStart(const std::string& path) {
+        std::vector<SnapshotEntry> entries;
+        LoaderError err = readResidencySnapshot(path, entries);
+        if (err != LoaderError::Success) {
+            lastError_ = err;
+            logMessage(LogLevel::Error, "warmStart: cannot read snapshot '%s': %s", path.c_str(), getErrorString(err));
+            return 0;
+        }
+
+        std::vector<uint32_t> toLoad;
+        size_t plannedMemory = 0;
+        size_t skippedBudget = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            // Several textures may share a file (different descs); hand them out in id order
+            std::unordered_map<std::string, std::vector<uint32_t>> byFilename;
+            for (uint32_t i = nextTextureId_; i-- > 0;) {
+                const std::string& filename = textures_.records[i]->filename;
+                if (!filename.empty()) {
+                    byFilename[filename].push_back(i);
+                }
+            }
+
+            std::unordered_set<uint32_t> plannedPages;
+            std::vector<size_t> plannedGroupMemory(budgetGroups_.size(), 0);
+            size_t budget = memoryBudget();
+            for (const SnapshotEntry& e : entries) {
+                auto it = byFilename.find(e.filename);
+                if (it == byFilename.end() || it->second.empty()) continue;
+                uint32_t texId = it->second.back();
+                it->second.pop_back();
+
+                size_t mem = loadEstimate(texId);
+                if (textures_.isBusy(texId) || mem == 0) continue;
+                if ((textures_.state[texId] & kTextureFailed) && !retryDue(texId)) continue;
+                uint32_t page = textures_.atlasPage[texId];
+                if (page && plannedPages.count(page)) continue;
+
+                const BudgetGroup& group = budgetGroups_[textures_.budgetGroup[texId]];
+                size_t& groupPlanned = plannedGroupMemory[textures_.budgetGroup[texId]];
+                if ((budget > 0 && totalMemoryUsage_ + plannedMemory + mem > budget) ||
+                    (group.maxBytes > 0 && group.memoryUsage + groupPlanned + mem > group.maxBytes)) {
+                    skippedBudget++;
+                    continue;
+                }
+                plannedMemory += mem;
+                groupPlanned += mem;
+                toLoad.push_back(texId);
+                if (page) plannedPages.insert(page);
+            }
+        }
+
+        size_t loaded = loadBatch(toLoad);
+        logMessage(LogLevel::Info, "warmStart: loaded %zu of %zu snapshot textures (%zu over budget) est=%.2f MB",
+                   loaded, entries.size(), skippedBudget, static_cast<double>(plannedMemory) / (1024.0 * 1024.0));
+        return loaded;
+    }
+
     void unloadTexture(uint32_t texId) {
         std::lock_guard<std::mutex> lock(mutex_);
         destroyTexture(texId);
@@ -460,12 +1204,375 @@ public:
     
     void unloadAll() {
         std::lock_guard<std::mutex> lock(mutex_);
-        for (uint32_t i = 0; i < nextTextureId_; ++i) {
-            destroyTexture(i);
+        std::vector<uint32_t> resident;
+        residency_.forEach([&](uint32_t texId) { resident.push_back(texId); });
+        for (uint32_t texId : resident) {
+            destroyTexture(texId);
+        }
+    }
+    
+private:
+    // HIP backend: device buffers and the pinned host buffers they are copied through
+    bool initDeviceBuffers() {
+        hipError_t err = hipGetDevice(&device_);
+        if (err != hipSuccess) {
+            lastError_ = LoaderError::HipError;
+            return false;
+        }
+        
+        // Allocate device buffers; the residency summary lives right after the flag words
+        size_t flagWords = ResidencyBitmap::wordCountFor(options_.maxTextures);
+        size_t summaryWords = ResidencyBitmap::summaryCountFor(options_.maxTextures);
+        err = hipMalloc(&d_residentFlags_, (flagWords + summaryWords) * sizeof(uint32_t));
+        if (err != hipSuccess) {
+            lastError_ = LoaderError::OutOfMemory;
+            return false;
+        }
+        
+        err = hipMalloc(&d_textures_, options_.maxTextures * sizeof(hipTextureObject_t));
+        if (err != hipSuccess) {
+            lastError_ = LoaderError::OutOfMemory;
+            hipFree(d_residentFlags_);
+            d_residentFlags_ = nullptr;
+            return false;
+        }
+        
+        if (options_.mappedFeedback) {
+            mappedFeedback_ = initMappedFeedback();
+        }
+        if (!mappedFeedback_) {
+            err = hipMalloc(&d_requests_, options_.maxRequestsPerLaunch * sizeof(uint32_t));
+            if (err != hipSuccess) {
+                lastError_ = LoaderError::OutOfMemory;
+                hipFree(d_textures_);
+                hipFree(d_residentFlags_);
+                d_textures_ = nullptr;
+                d_residentFlags_ = nullptr;
+                return false;
+            }
+
+            err = hipMalloc(&d_requestStats_, sizeof(RequestStats));
+            if (err != hipSuccess) {
+                lastError_ = LoaderError::OutOfMemory;
+                hipFree(d_requests_);
+                hipFree(d_textures_);
+                hipFree(d_residentFlags_);
+                d_requests_ = nullptr;
+                d_textures_ = nullptr;
+                d_residentFlags_ = nullptr;
+                return false;
+            }
+        }
+        d_requestCount_ = reinterpret_cast<uint32_t*>(d_requestStats_);
+        d_requestOverflow_ = d_requestCount_ + 1;
+        d_residentSummary_ = d_residentFlags_ + flagWords;
+        
+        // Initialize to zero
+        err = hipMemset(d_residentFlags_, 0, (flagWords + summaryWords) * sizeof(uint32_t));
+        if (err != hipSuccess) lastError_ = LoaderError::HipError;
+        
+        err = hipMemset(d_textures_, 0, options_.maxTextures * sizeof(hipTextureObject_t));
+        if (err != hipSuccess) lastError_ = LoaderError::HipError;
+        
+        err = hipMemset(d_requestStats_, 0, sizeof(RequestStats));
+        if (err != hipSuccess) lastError_ = LoaderError::HipError;
+        
+        // Allocate host pinned buffers for async copies
+        flagWordCount_ = flagWords;
+        if (hipHostMalloc(reinterpret_cast<void**>(&h_residentFlags_), (flagWords + summaryWords) * sizeof(uint32_t)) != hipSuccess) {
+            lastError_ = LoaderError::OutOfMemory;
+            return false;
+        }
+        if (hipHostMalloc(reinterpret_cast<void**>(&h_textures_), options_.maxTextures * sizeof(hipTextureObject_t)) != hipSuccess) {
+            lastError_ = LoaderError::OutOfMemory;
+            hipHostFree(h_residentFlags_);
+            h_residentFlags_ = nullptr;
+            return false;
+        }
+        if (!mappedFeedback_ && hipHostMalloc(reinterpret_cast<void**>(&h_requests_), options_.maxRequestsPerLaunch * sizeof(uint32_t)) != hipSuccess) {
+            lastError_ = LoaderError::OutOfMemory;
+            hipHostFree(h_residentFlags_);
+            hipHostFree(h_textures_);
+            h_residentFlags_ = nullptr;
+            h_textures_ = nullptr;
+            return false;
+        }
+        if (!mappedFeedback_ && hipHostMalloc(reinterpret_cast<void**>(&h_requestStats_), sizeof(RequestStats)) != hipSuccess) {
+            lastError_ = LoaderError::OutOfMemory;
+            hipHostFree(h_residentFlags_);
+            hipHostFree(h_textures_);
+            hipHostFree(h_requests_);
+            h_residentFlags_ = nullptr;
+            h_textures_ = nullptr;
+            h_requests_ = nullptr;
+            return false;
+        }
+
+        // Usage bits are optional; without them LRU age is the load frame
+        if (options_.trackUsage) {
+            if (hipMalloc(&d_usedFlags_, flagWords * sizeof(uint32_t)) != hipSuccess ||
+                hipMemset(d_usedFlags_, 0, flagWords * sizeof(uint32_t)) != hipSuccess ||
+                hipHostMalloc(reinterpret_cast<void**>(&h_usedFlags_), flagWords * sizeof(uint32_t)) != hipSuccess) {
+                logMessage(LogLevel::Warn, "DemandTextureLoader: usage tracking disabled (allocation failed)");
+                if (d_usedFlags_) hipFree(d_usedFlags_);
+                d_usedFlags_ = nullptr;
+                h_usedFlags_ = nullptr;
+                options_.trackUsage = false;
+            } else {
+                std::fill_n(h_usedFlags_, flagWords, 0u);
+            }
+        }
+
+        if (hipEventCreateWithFlags(&uploadEvent_, hipEventDisableTiming) != hipSuccess) {
+            lastError_ = LoaderError::HipError;
+            return false;
+        }
+
+        residency_.attach(h_residentFlags_, h_residentFlags_ + flagWords, options_.maxTextures);
+        std::fill_n(h_textures_, options_.maxTextures, static_cast<hipTextureObject_t>(0));
+        std::fill_n(h_requests_, options_.maxRequestsPerLaunch, 0u);
+        h_requestStats_->count = 0;
+        h_requestStats_->overflow = 0;
+        return true;
+    }
+
+    // Request list and stats in host-mapped, coherent pinned memory; d_requests_ and
+    // d_requestStats_ are their device aliases, so the kernel's atomics and stores land in
+    // host memory and processRequests reads them without copies. Used flags stay in device
+    // memory: every sample of a resident texture may set one, and those writes would all
+    // cross the bus.
+    bool initMappedFeedback() {
+        const unsigned int flags = hipHostMallocMapped | hipHostMallocCoherent;
+        if (hipHostMalloc(reinterpret_cast<void**>(&h_requests_), options_.maxRequestsPerLaunch * sizeof(uint32_t), flags) != hipSuccess ||
+            hipHostMalloc(reinterpret_cast<void**>(&h_requestStats_), sizeof(RequestStats), flags) != hipSuccess ||
+            hipHostGetDevicePointer(reinterpret_cast<void**>(&d_requests_), h_requests_, 0) != hipSuccess ||
+            hipHostGetDevicePointer(reinterpret_cast<void**>(&d_requestStats_), h_requestStats_, 0) != hipSuccess) {
+            logMessage(LogLevel::Warn, "DemandTextureLoader: mapped feedback disabled (allocation failed), using copies");
+            if (h_requests_) hipHostFree(h_requests_);
+            if (h_requestStats_) hipHostFree(h_requestStats_);
+            h_requests_ = nullptr;
+            h_requestStats_ = nullptr;
+            d_requests_ = nullptr;
+            d_requestStats_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    // CPU backend: the h_ buffers point at plain host storage that CpuDemandTextureContext
+    // reads and writes directly; no HIP calls are made
+    void initCpuBuffers() {
+        size_t flagWords = ResidencyBitmap::wordCountFor(options_.maxTextures);
+        size_t summaryWords = ResidencyBitmap::summaryCountFor(options_.maxTextures);
+        flagWordCount_ = flagWords;
+        cpuResidentFlags_.assign(flagWords + summaryWords, 0u);
+        cpuRequests_.assign(options_.maxRequestsPerLaunch, 0u);
+        cpuTextures_.assign(options_.maxTextures, nullptr);
+        cpuRequestedFlags_.reset(new std::atomic<uint32_t>[flagWords]);
+        for (size_t w = 0; w < flagWords; ++w) {
+            cpuRequestedFlags_[w].store(0u, std::memory_order_relaxed);
+        }
+        if (options_.trackUsage) {
+            cpuUsedFlags_.reset(new std::atomic<uint32_t>[flagWords]);
+            for (size_t w = 0; w < flagWords; ++w) {
+                cpuUsedFlags_[w].store(0u, std::memory_order_relaxed);
+            }
+            cpuUsedCopy_.assign(flagWords, 0u);
+            h_usedFlags_ = cpuUsedCopy_.data();
+        }
+        h_residentFlags_ = cpuResidentFlags_.data();
+        h_requests_ = cpuRequests_.data();
+        h_requestStats_ = &cpuRequestStats_;
+        residency_.attach(h_residentFlags_, h_residentFlags_ + flagWords, options_.maxTextures);
+    }
+
+    bool cpuBackend() const { return options_.backend == TextureBackend::Cpu; }
+
+    // Page geometry and the per-texture mapping table; packing is turned off if the
+    // table cannot be allocated
+    void initAtlas() {
+        if (options_.atlasMaxTextureSize == 0) return;
+        // A gutter of g texels still covers the bilinear footprint at level log2(g)
+        atlasMipLevels_ = 1;
+        while (atlasMipLevels_ < 16 && (1u << atlasMipLevels_) <= options_.atlasGutter) {
+            atlasMipLevels_++;
+        }
+        atlasAlignment_ = 1u << (atlasMipLevels_ - 1);
+        atlasGutter_ = (options_.atlasGutter + atlasAlignment_ - 1) / atlasAlignment_ * atlasAlignment_;
+
+        if (cpuBackend()) {
+            cpuAtlas_.assign(options_.maxTextures, AtlasMapping{});
+            h_atlas_ = cpuAtlas_.data();
+            return;
+        }
+        size_t bytes = options_.maxTextures * sizeof(AtlasMapping);
+        if (hipMalloc(&d_atlas_, bytes) != hipSuccess ||
+            hipMemset(d_atlas_, 0, bytes) != hipSuccess ||
+            hipHostMalloc(reinterpret_cast<void**>(&h_atlas_), bytes) != hipSuccess) {
+            logMessage(LogLevel::Warn, "DemandTextureLoader: atlas packing disabled (allocation failed)");
+            if (d_atlas_) hipFree(d_atlas_);
+            d_atlas_ = nullptr;
+            h_atlas_ = nullptr;
+            options_.atlasMaxTextureSize = 0;
+            return;
+        }
+        std::fill_n(h_atlas_, options_.maxTextures, AtlasMapping{});
+    }
+
+    // Side of a texture's rectangle in a page: texels, gutter on both sides, alignment
+    uint32_t atlasPaddedSize(int size) const {
+        return (static_cast<uint32_t>(size) + 2 * atlasGutter_ + atlasAlignment_ - 1) / atlasAlignment_ * atlasAlignment_;
+    }
+
+    bool atlasEligible(const TextureRecord& info) const {
+        if (options_.atlasMaxTextureSize == 0 || info.width <= 0 || info.height <= 0) return false;
+        const TextureDesc& desc = info.desc;
+        int size = std::max(info.width, info.height);
+        uint32_t pageSize = options_.atlasPageSize / atlasAlignment_ * atlasAlignment_;
+        return static_cast<uint32_t>(size) <= options_.atlasMaxTextureSize && atlasPaddedSize(size) <= pageSize &&
+               desc.normalizedCoords && desc.generateMipmaps && desc.maxMipLevel == 0 && info.baseMipBias == 0;
+    }
+
+    // Members of a page share its sampler state and are charged to one budget group
+    static bool sameAtlasPageKey(const TextureDesc& a, const TextureDesc& b) {
+        return a.filterMode == b.filterMode && a.mipmapFilterMode == b.mipmapFilterMode && a.sRGB == b.sRGB &&
+               a.budgetGroup == b.budgetGroup;
+    }
+
+    // Place a new texture in one of the latest open pages with the same key, or
+    // start a page; textures that are not eligible stay standalone. Caller holds mutex_.
+    void assignToAtlas(uint32_t texId) {
+        TextureRecord& info = *textures_.records[texId];
+        if (!atlasEligible(info)) return;
+        uint32_t width = atlasPaddedSize(info.width);
+        uint32_t height = atlasPaddedSize(info.height);
+        uint32_t x = 0;
+        uint32_t y = 0;
+        size_t pageIndex = atlasPages_.size();
+        size_t tried = 0;
+        for (size_t p = atlasPages_.size(); p-- > 0 && tried < kAtlasOpenPages;) {
+            AtlasPage& page = *atlasPages_[p];
+            if (page.resident || page.loading || !sameAtlasPageKey(page.desc, info.desc)) continue;
+            tried++;
+            if (page.packer.insert(width, height, x, y)) {
+                pageIndex = p;
+                break;
+            }
+        }
+        if (pageIndex == atlasPages_.size()) {
+            auto page = std::make_unique<AtlasPage>();
+            page->desc = info.desc;
+            page->desc.addressMode[0] = hipAddressModeClamp;
+            page->desc.addressMode[1] = hipAddressModeClamp;
+            page->desc.maxMipLevel = static_cast<unsigned int>(atlasMipLevels_);
+            page->packer.reset(options_.atlasPageSize, options_.atlasPageSize, atlasAlignment_);
+            page->packer.insert(width, height, x, y);  // Always fits an empty page (atlasEligible)
+            atlasPages_.push_back(std::move(page));
+        }
+
+        AtlasPage& page = *atlasPages_[pageIndex];
+        page.members.push_back(texId);
+        page.texelArea += static_cast<uint64_t>(info.width) * info.height;
+        info.atlasX = x + atlasGutter_;
+        info.atlasY = y + atlasGutter_;
+        textures_.atlasPage[texId] = static_cast<uint32_t>(pageIndex + 1);
+    }
+
+    // Device bytes a page takes when loaded now
+    size_t atlasPageBytes(const AtlasPage& page) const {
+        return calculateMipmapMemory(page.packer.usedWidth(), page.packer.usedHeight(), 4);
+    }
+
+    // Bytes a load of texId brings in: its page for atlas members
+    size_t loadEstimate(uint32_t texId) const {
+        if (uint32_t page = textures_.atlasPage[texId]) {
+            return atlasPageBytes(*atlasPages_[page - 1]);
+        }
+        uint32_t bias = mipBiasFor(texId);
+        if (bias == 0 || textures_.estimatedBytes[texId] == 0) {
+            return textures_.estimatedBytes[texId];
+        }
+        const TextureRecord& info = *textures_.records[texId];
+        return calculateMipmapMemory(biasedSize(info.width, bias), biasedSize(info.height, bias), 4);
+    }
+
+    // Mip levels a load of texId drops: the resolution cap plus the thrash bias, short of 1x1.
+    // Atlas members, unnormalized textures and textures of unknown size keep all.
+    uint32_t mipBiasFor(uint32_t texId) const {
+        const TextureRecord& info = *textures_.records[texId];
+        if (thrashMipBias_ == 0) return info.baseMipBias;
+        if (textures_.atlasPage[texId] || !info.desc.normalizedCoords || info.width <= 0 || info.height <= 0) {
+            return 0;
+        }
+        return std::min(info.baseMipBias + thrashMipBias_, floorLog2(std::max(info.width, info.height)));
+    }
+
+    // Levels TextureDesc::lodBias and maxResolution (or the LoaderOptions defaults) drop
+    uint8_t resolutionBias(const TextureRecord& info) const {
+        const TextureDesc& desc = info.desc;
+        if (!desc.normalizedCoords || info.width <= 0 || info.height <= 0) return 0;
+        uint32_t size = static_cast<uint32_t>(std::max(info.width, info.height));
+        uint32_t maxBias = floorLog2(static_cast<int>(size));
+        uint32_t bias = std::min(desc.lodBias ? desc.lodBias : options_.textureLodBias, maxBias);
+        unsigned int cap = desc.maxResolution ? desc.maxResolution : options_.maxTextureResolution;
+        while (cap > 0 && bias < maxBias && (size >> bias) > cap) {
+            bias++;
+        }
+        return static_cast<uint8_t>(bias);
+    }
+
+    static uint32_t floorLog2(int value) {
+        uint32_t log = 0;
+        while (value > 1) {
+            value >>= 1;
+            log++;
+        }
+        return log;
+    }
+
+    static int biasedSize(int size, uint32_t bias) {
+        return std::max(1, size >> bias);
+    }
+
+    void markAtlasDirty(uint32_t texId) {
+        atlasDirtyBegin_ = std::min(atlasDirtyBegin_, texId);
+        atlasDirtyEnd_ = std::max(atlasDirtyEnd_, texId + 1);
+    }
+
+    // Texel an address mode fetches for index i of n; -1 for border's transparent black
+    static int atlasSourceTexel(int i, int n, hipTextureAddressMode mode) {
+        switch (mode) {
+            case hipAddressModeWrap:
+                return ((i % n) + n) % n;
+            case hipAddressModeMirror: {
+                int p = ((i % (2 * n)) + 2 * n) % (2 * n);
+                return p < n ? p : 2 * n - 1 - p;
+            }
+            case hipAddressModeBorder:
+                return (i < 0 || i >= n) ? -1 : i;
+            default:
+                return std::min(std::max(i, 0), n - 1);
+        }
+    }
+
+    // Copy RGBA8 texels to (x, y) in a page and fill the gutter around them with
+    // what the texture's address modes fetch outside [0, 1]
+    static void blitAtlasMember(uint8_t* page, uint32_t pageWidth, const unsigned char* src, int width, int height,
+                                uint32_t x, uint32_t y, int gutter, const TextureDesc& desc) {
+        for (int ty = -gutter; ty < height + gutter; ++ty) {
+            int sy = atlasSourceTexel(ty, height, desc.addressMode[1]);
+            uint8_t* row = page + (static_cast<size_t>(static_cast<int>(y) + ty) * pageWidth + x - gutter) * 4;
+            for (int tx = -gutter; tx < width + gutter; ++tx, row += 4) {
+                int sx = atlasSourceTexel(tx, width, desc.addressMode[0]);
+                if (sx < 0 || sy < 0) {
+                    std::memset(row, 0, 4);
+                } else {
+                    std::memcpy(row, src + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+                }
+            }
         }
     }
-    
-private:
+
     // Calculate total memory needed for mipmaps
     size_t calculateMipmapMemory(int width, int height, int bytesPerPixel) const {
         size_t total = 0;
@@ -488,13 +1595,568 @@ private:
         return levels;
     }
     
+    // Reset the CPU request queue and the usage bits of occupied blocks; caller holds mutex_
+    void prepareCpuLaunch() {
+        // Without an overflow every requested bit belongs to a queued id, so clearing
+        // the queued ids' words clears them all
+        uint32_t queued = std::min(cpuRequestCount_.load(std::memory_order_relaxed),
+                                   static_cast<uint32_t>(options_.maxRequestsPerLaunch));
+        if (cpuRequestOverflow_.load(std::memory_order_relaxed) != 0u) {
+            for (size_t w = 0; w < flagWordCount_; ++w) {
+                cpuRequestedFlags_[w].store(0u, std::memory_order_relaxed);
+            }
+        } else {
+            for (uint32_t i = 0; i < queued; ++i) {
+                cpuRequestedFlags_[h_requests_[i] >> 5].store(0u, std::memory_order_relaxed);
+            }
+        }
+        cpuRequestCount_.store(0u, std::memory_order_relaxed);
+        cpuRequestOverflow_.store(0u, std::memory_order_relaxed);
+
+        if (cpuUsedFlags_) {
+            residency_.residentRuns(usedRuns_, kMaxTransferRuns);
+            for (const ResidencyBitmap::Run& run : usedRuns_) {
+                size_t firstWord = run.firstBlock * 32;
+                for (size_t w = firstWord; w < firstWord + runWordCount(run); ++w) {
+                    cpuUsedFlags_[w].store(0u, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    // CPU counterpart of the request/usage download; render threads must be done
+    void gatherCpuRequests(std::vector<ResidencyBitmap::Run>& usedRuns) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        h_requestStats_->count = cpuRequestCount_.load(std::memory_order_acquire);
+        h_requestStats_->overflow = cpuRequestOverflow_.load(std::memory_order_acquire);
+        if (cpuUsedFlags_) {
+            usedRuns = usedRuns_;
+            for (const ResidencyBitmap::Run& run : usedRuns) {
+                size_t firstWord = run.firstBlock * 32;
+                for (size_t w = firstWord; w < firstWord + runWordCount(run); ++w) {
+                    h_usedFlags_[w] = cpuUsedFlags_[w].load(std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    // CPU backend: RGBA8 mip chain in one host allocation, built from the same box filter
+    bool buildCpuTexture(TextureRecord& info, const unsigned char* data, int width, int height,
+                         const TextureDesc& desc, int& numMipLevels, size_t& memoryUsage) {
+        int numLevels = 1;
+        if (desc.generateMipmaps && (width > 1 || height > 1)) {
+            numLevels = calculateMipLevels(width, height);
+            if (desc.maxMipLevel > 0) {
+                numLevels = std::min(numLevels, (int)desc.maxMipLevel);
+            }
+        }
+
+        size_t total = 0;
+        for (int level = 0, w = width, h = height; level < numLevels; ++level) {
+            total += static_cast<size_t>(w) * h * 4;
+            w = std::max(1, w / 2);
+            h = std::max(1, h / 2);
+        }
+
+        auto tex = std::make_unique<CpuTexture>();
+        tex->storage.reset(new (std::nothrow) uint8_t[total]);
+        if (!tex->storage) {
+            return false;
+        }
+        uint8_t* dst = tex->storage.get();
+        std::memcpy(dst, data, static_cast<size_t>(width) * height * 4);
+        tex->levels.push_back(CpuMipLevel{dst, static_cast<uint32_t>(width), static_cast<uint32_t>(height)});
+        for (int level = 1; level < numLevels; ++level) {
+            const CpuMipLevel& prev = tex->levels.back();
+            uint32_t w = std::max(1u, prev.width / 2);
+            uint32_t h = std::max(1u, prev.height / 2);
+            dst += static_cast<size_t>(prev.width) * prev.height * 4;
+            downsampleBox(prev.texels, prev.width, prev.height, dst, w, h);
+            tex->levels.push_back(CpuMipLevel{dst, w, h});
+        }
+
+        tex->addressMode[0] = desc.addressMode[0];
+        tex->addressMode[1] = desc.addressMode[1];
+        tex->filterMode = desc.filterMode;
+        tex->mipmapFilterMode = desc.mipmapFilterMode;
+        tex->normalizedCoords = desc.normalizedCoords;
+        tex->sRGB = desc.sRGB;
+        info.cpuTexture = std::move(tex);
+        numMipLevels = numLevels;
+        memoryUsage = total;
+        return true;
+    }
+
+    // Flag words covered by a run of residency blocks (the last block may be partial)
+    size_t runWordCount(const ResidencyBitmap::Run& run) const {
+        return std::min(run.blockCount * 32, flagWordCount_ - run.firstBlock * 32);
+    }
+
+    // Trace helpers; callers hold mutex_
+    void traceTexture(uint32_t texId) {
+        if (!trace_) return;
+        const TextureRecord& info = *textures_.records[texId];
+        trace_->writeTexture(currentFrame_, texId, info.width, info.height, info.channels,
+                             textures_.estimatedBytes[texId], info.filename);
+    }
+
+    void traceLoad(uint32_t texId, size_t bytes, std::chrono::steady_clock::time_point start, bool success) {
+        if (!trace_) return;
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        trace_->writeLoad(currentFrame_, texId, bytes, static_cast<uint32_t>(micros), success);
+    }
+
+    // Failure helpers; callers hold mutex_
+    void noteLoadFailure(uint32_t texId, TextureRecord& info, LoaderError error) {
+        info.lastError = error;
+        info.failureCount++;
+        if (!(textures_.state[texId] & kTextureFailed)) {
+            failedTextureCount_++;
+        }
+        textures_.state[texId] |= kTextureFailed;
+        if (isPermanentFailure(error)) {
+            textures_.state[texId] |= kTextureFailedPermanent;
+            logMessage(LogLevel::Warn, "loadTexture: texId=%u failed permanently (%s); not retried",
+                       texId, getErrorString(error));
+            return;
+        }
+        uint64_t backoff = retryBackoffFrames(info.failureCount, options_.retryBackoffFrames, options_.maxRetryBackoffFrames);
+        info.retryFrame = currentFrame_ + static_cast<uint32_t>(backoff);
+        logMessage(LogLevel::Info, "loadTexture: texId=%u failed (%s), attempt %u; retry in %llu frames",
+                   texId, getErrorString(error), info.failureCount, static_cast<unsigned long long>(backoff));
+    }
+
+    void clearFailure(uint32_t texId, TextureRecord& info) {
+        if (textures_.state[texId] & kTextureFailed) {
+            failedTextureCount_--;
+        }
+        textures_.state[texId] &= ~(kTextureFailed | kTextureFailedPermanent);
+        info.failureCount = 0;
+        info.retryFrame = 0;
+    }
+
+    bool retryDue(uint32_t texId) const {
+        if (textures_.state[texId] & kTextureFailedPermanent) return false;
+        return static_cast<int32_t>(currentFrame_ - textures_.records[texId]->retryFrame) >= 0;
+    }
+
+    // Latency helpers; callers hold mutex_
+    void noteMiss(uint32_t texId, std::chrono::steady_clock::time_point now) {
+        if (textures_.state[texId] & kTextureMissPending) return;
+        textures_.state[texId] |= kTextureMissPending;
+        latencyPending_++;
+        MissTimeline& t = textures_.records[texId]->latency;
+        t.missFrame = currentFrame_;
+        t.missTime = now;
+        t.loadStarted = false;
+    }
+
+    void noteLoadStart(uint32_t texId, MissTimeline& t) {
+        if (!(textures_.state[texId] & kTextureMissPending) || t.loadStarted) return;
+        t.loadStarted = true;
+        t.loadStartFrame = currentFrame_;
+        t.loadStartTime = std::chrono::steady_clock::now();
+    }
+
+    // The texture was published this frame, so it is sampled from the next launch on
+    void noteResident(uint32_t texId, MissTimeline& t) {
+        auto now = std::chrono::steady_clock::now();
+        latencyPending_--;
+        t.residentFrame = currentFrame_;
+        t.measured = true;
+        t.totalMicros = std::chrono::duration_cast<std::chrono::microseconds>(now - t.missTime).count();
+        t.queueMicros = t.loadStarted
+            ? std::chrono::duration_cast<std::chrono::microseconds>(t.loadStartTime - t.missTime).count()
+            : t.totalMicros;
+        uint32_t frames = t.residentFrame + 1 - t.missFrame;
+        size_t sizeClass = static_cast<size_t>(getTextureSizeClass(textures_.estimatedBytes[texId]));
+        latencyFrames_[sizeClass].add(frames);
+        latencyMicros_[sizeClass].add(t.totalMicros);
+        latencyFrames_[kTextureSizeClassCount].add(frames);
+        latencyMicros_[kTextureSizeClassCount].add(t.totalMicros);
+        if (trace_) {
+            trace_->writeLatency(currentFrame_, texId, textures_.estimatedBytes[texId], t.missFrame,
+                                 static_cast<uint32_t>(std::min<uint64_t>(t.queueMicros, UINT32_MAX)),
+                                 static_cast<uint32_t>(std::min<uint64_t>(t.totalMicros, UINT32_MAX)));
+        }
+    }
+
+    static LatencyStats latencyStats(const LatencyHistogram& frames, const LatencyHistogram& micros) {
+        LatencyStats stats;
+        stats.count = frames.count();
+        stats.frames.p50 = static_cast<double>(frames.percentile(0.50));
+        stats.frames.p95 = static_cast<double>(frames.percentile(0.95));
+        stats.frames.p99 = static_cast<double>(frames.percentile(0.99));
+        stats.frames.max = static_cast<double>(frames.max());
+        stats.millis.p50 = micros.percentile(0.50) / 1000.0;
+        stats.millis.p95 = micros.percentile(0.95) / 1000.0;
+        stats.millis.p99 = micros.percentile(0.99) / 1000.0;
+        stats.millis.max = micros.max() / 1000.0;
+        return stats;
+    }
+
     // Thread-safe texture loading wrapper
-    bool loadTextureThreadSafe(uint32_t texId) {
-        return loadTexture(texId);
+    bool loadTextureThreadSafe(uint32_t texId, std::shared_ptr<const std::vector<char>> fileData = nullptr) {
+        return loadTexture(texId, std::move(fileData));
+    }
+
+    // Load textures on the worker pool; returns the number that became resident.
+    // With async I/O, files whose reader decodes from memory are read ahead through
+    // a window (see ReadAhead) and each completion queues its decode and upload on
+    // the pool.
+    size_t loadBatch(const std::vector<uint32_t>& texIds) {
+        std::atomic<size_t> loaded{0};
+        std::vector<uint32_t> direct;
+        std::vector<std::pair<uint32_t, std::string>> readAhead;
+        if (fileReader_) {
+            std::vector<std::pair<std::string, unsigned int>> cacheKeys;  // Reader and level, when shared
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (uint32_t texId : texIds) {
+                    const TextureRecord& info = *textures_.records[texId];
+                    if (!info.filename.empty() && info.sourceInfo.isValid && !info.sourceInfo.isTiled &&
+                        !textures_.atlasPage[texId] && imageSourceDecodesFromMemory(info.readerName)) {
+                        readAhead.emplace_back(texId, info.filename);
+                        if (sharedCache_) cacheKeys.emplace_back(info.readerName, mipBiasFor(texId));
+                    } else {
+                        direct.push_back(texId);
+                    }
+                }
+            }
+            // Images in the shared cache, or being decoded by another process, are not read here
+            if (sharedCache_) {
+                size_t kept = 0;
+                for (size_t i = 0; i < readAhead.size(); ++i) {
+                    SharedTexelKey key;
+                    if (SharedTexelCache::makeKey(readAhead[i].second, cacheKeys[i].first, cacheKeys[i].second, key) &&
+                        sharedCache_->contains(key)) {
+                        direct.push_back(readAhead[i].first);
+                    } else {
+                        readAhead[kept++] = std::move(readAhead[i]);
+                    }
+                }
+                readAhead.resize(kept);
+            }
+        } else {
+            direct = texIds;
+        }
+
+        auto pending = std::make_shared<ReadAhead>();
+        pending->files = std::move(readAhead);
+        pending->remaining = pending->files.size();
+        pending->loaded = &loaded;
+        readAheadMore(pending);
+
+        loadPool_->parallelFor(direct.size(), [&](size_t i) {
+            if (loadTextureThreadSafe(direct[i])) {
+                loaded++;
+            }
+        });
+
+        std::unique_lock<std::mutex> lock(pending->mutex);
+        pending->cv.wait(lock, [&]() { return pending->remaining == 0; });
+        return loaded;
+    }
+
+    // Read-ahead of one loadBatch. A file's bytes stay in memory until its decode finishes,
+    // so at most ioQueueDepth files are read or waiting for their decode at once, and no new
+    // read starts while completed reads hold more than readAheadBytes.
+    struct ReadAhead {
+        std::vector<std::pair<uint32_t, std::string>> files;
+        std::atomic<size_t>* loaded = nullptr;  // loadBatch's count; valid while remaining > 0
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t next = 0;       // First file not yet read
+        size_t inFlight = 0;   // Files read or being read and not yet decoded
+        size_t heldBytes = 0;  // Bytes of completed reads not yet decoded
+        size_t remaining = 0;  // Files not yet decoded
+    };
+
+    // Start reads until the window is full; each decode that finishes calls this again
+    void readAheadMore(const std::shared_ptr<ReadAhead>& pending) {
+        std::vector<size_t> start;
+        {
+            std::lock_guard<std::mutex> lock(pending->mutex);
+            while (pending->next < pending->files.size() && pending->inFlight < options_.ioQueueDepth &&
+                   (pending->inFlight == 0 || pending->heldBytes < options_.readAheadBytes)) {
+                start.push_back(pending->next++);
+                pending->inFlight++;
+            }
+        }
+        for (size_t i : start) {
+            uint32_t id = pending->files[i].first;
+            fileReader_->readFile(pending->files[i].second, [this, id, pending](FileReadResult&& result) {
+                // A failed read leaves the reader to open the file and report the error itself
+                std::shared_ptr<const std::vector<char>> data;
+                size_t bytes = 0;
+                if (result.ok()) {
+                    bytes = result.data.size();
+                    data = std::make_shared<const std::vector<char>>(std::move(result.data));
+                    std::lock_guard<std::mutex> lock(pending->mutex);
+                    pending->heldBytes += bytes;
+                }
+                loadPool_->submit([this, id, data, bytes, pending]() mutable {
+                    if (loadTextureThreadSafe(id, std::move(data))) {
+                        (*pending->loaded)++;
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(pending->mutex);
+                        pending->heldBytes -= bytes;
+                        pending->inFlight--;
+                    }
+                    // Before the count drops, so loadBatch cannot return with reads unstarted
+                    readAheadMore(pending);
+                    std::lock_guard<std::mutex> lock(pending->mutex);
+                    if (--pending->remaining == 0) pending->cv.notify_all();
+                });
+            });
+        }
+    }
+
+    static LoaderError readResidencySnapshot(const std::string& path, std::vector<SnapshotEntry>& entries) {
+        std::ifstream in(path);
+        if (!in) {
+            return LoaderError::FileNotFound;
+        }
+
+        std::string line;
+        std::string magic;
+        int version = 0;
+        if (!std::getline(in, line) || !(std::istringstream(line) >> magic >> version) ||
+            magic != kSnapshotMagic || version < 1 || version > kSnapshotVersion) {
+            return LoaderError::InvalidParameter;
+        }
+
+        while (std::getline(in, line)) {
+            if (line.empty()) continue;
+            std::istringstream fields(line);
+            SnapshotEntry e;
+            int mipLevels = 0;
+            if (!(fields >> e.age) || (version == 1 && !(fields >> mipLevels)) ||
+                !(fields >> e.width >> e.height >> e.memoryUsage)) {
+                return LoaderError::InvalidParameter;
+            }
+            fields.get();  // single separator; the filename may contain spaces
+            std::getline(fields, e.filename);
+            if (e.filename.empty()) {
+                return LoaderError::InvalidParameter;
+            }
+            entries.push_back(std::move(e));
+        }
+        return LoaderError::Success;
+    }
+
+    // Sniff the file once and read its header with the first candidate reader that accepts it
+    static LoaderError readImageInfo(const std::string& filename, std::string& readerName,
+                                     hip_demand::TextureInfo& texInfo) {
+        ImageSourceSniff sniff = sniffImageSource(filename);
+        if (!sniff.readable) {
+            return LoaderError::FileNotFound;
+        }
+        for (const std::string& reader : sniff.readers) {
+            try {
+                std::unique_ptr<ImageSource> imgSrc = createImageSource(filename, reader);
+                if (!imgSrc) continue;
+                imgSrc->open(&texInfo);
+                if (imgSrc->isOpen() && texInfo.isValid && texInfo.numChannels > 0) {
+                    imgSrc->close();
+                    readerName = reader;
+                    return LoaderError::Success;
+                }
+            } catch (const std::exception& e) {
+                logMessage(LogLevel::Debug, "readImageInfo: reader '%s' rejected '%s': %s", reader.c_str(), filename.c_str(), e.what());
+            }
+        }
+        return LoaderError::ImageLoadFailed;
+    }
+
+    // Decode the level a load starts at (0 unless a resolution cap or mip bias skips levels)
+    // with a reader that has already been opened. Readers return stored mips as they are and
+    // build missing ones from level 0. Returns 8-bit pixels with the reader's native channel count.
+    static std::unique_ptr<uint8_t[]> readBaseLevel(ImageSource& imgSrc, const hip_demand::TextureInfo& texInfo,
+                                                    unsigned int level, int& width, int& height) {
+        level = std::min(level, std::max(texInfo.numMipLevels, 1u) - 1);
+        unsigned int w = getMipLevelDimension(texInfo.width, level);
+        unsigned int h = getMipLevelDimension(texInfo.height, level);
+        size_t size = static_cast<size_t>(w) * h * texInfo.numChannels;
+        std::unique_ptr<uint8_t[]> pixels(new uint8_t[size]);
+        bool ok = imgSrc.readMipLevel(reinterpret_cast<char*>(pixels.get()), level, w, h);
+        imgSrc.close();
+        if (!ok) return nullptr;
+        width = static_cast<int>(w);
+        height = static_cast<int>(h);
+        return pixels;
+    }
+
+    // Decode the first loaded level of a file. The reader and header cached at creation are reused so
+    // the file is opened exactly once; without them (or if that fails) the file is sniffed again.
+    // fileData, if set, is the whole file read ahead; it is decoded instead of reading the file.
+    static std::unique_ptr<uint8_t[]> readBaseLevel(const std::string& filename, const std::string& cachedReader,
+                                                    const hip_demand::TextureInfo& cachedInfo,
+                                                    std::shared_ptr<const std::vector<char>> fileData, unsigned int level,
+                                                    int& width, int& height, int& channels) {
+        if (!cachedReader.empty() && cachedInfo.isValid) {
+            try {
+                std::unique_ptr<ImageSource> imgSrc = createImageSource(filename, cachedReader);
+                if (imgSrc) {
+                    if (fileData) imgSrc->setFileData(std::move(fileData));
+                    imgSrc->openWithInfo(cachedInfo);
+                    if (auto pixels = readBaseLevel(*imgSrc, cachedInfo, level, width, height)) {
+                        channels = static_cast<int>(cachedInfo.numChannels);
+                        return pixels;
+                    }
+                }
+            } catch (const std::exception& e) {
+                logMessage(LogLevel::Debug, "readBaseLevel: cached reader '%s' failed on '%s': %s", cachedReader.c_str(), filename.c_str(), e.what());
+            }
+            logMessage(LogLevel::Warn, "readBaseLevel: '%s' changed since creation, re-sniffing", filename.c_str());
+        }
+
+        for (const std::string& reader : findImageSources(filename)) {
+            try {
+                std::unique_ptr<ImageSource> imgSrc = createImageSource(filename, reader);
+                if (!imgSrc) continue;
+                hip_demand::TextureInfo texInfo;
+                imgSrc->open(&texInfo);
+                if (!imgSrc->isOpen() || !texInfo.isValid || texInfo.numChannels == 0) continue;
+
+                if (auto pixels = readBaseLevel(*imgSrc, texInfo, level, width, height)) {
+                    channels = static_cast<int>(texInfo.numChannels);
+                    return pixels;
+                }
+            } catch (const std::exception& e) {
+                logMessage(LogLevel::Debug, "readBaseLevel: reader '%s' failed on '%s': %s", reader.c_str(), filename.c_str(), e.what());
+            }
+        }
+        return nullptr;
     }
     
+    // Mip level `level` of a texture as RGBA8, decoded from its file or decimated and expanded
+    // from the cached copy of a memory texture; data points into ownedData or at cached, and
+    // width/height become the level's size. On failure error tells a missing file from one
+    // that cannot be decoded.
+    static bool readRGBA8(const std::string& filename, const std::string& readerName,
+                          const hip_demand::TextureInfo& sourceInfo, const unsigned char* cached,
+                          std::shared_ptr<const std::vector<char>> fileData, unsigned int level,
+                          int& width, int& height, int& channels,
+                          std::unique_ptr<uint8_t[]>& ownedData, const unsigned char*& data, LoaderError& error) {
+        if (!filename.empty()) {
+            ownedData = readBaseLevel(filename, readerName, sourceInfo, std::move(fileData), level, width, height, channels);
+            if (!ownedData) {
+                error = sniffImageSource(filename).readable ? LoaderError::ImageLoadFailed : LoaderError::FileNotFound;
+                return false;
+            }
+            if (channels != 4) {
+                ownedData = expandToRGBA8(ownedData.get(), static_cast<size_t>(width) * height, channels);
+                channels = 4;
+            }
+            data = ownedData.get();
+        } else if (cached) {
+            if (level > 0) {
+                int w = static_cast<int>(getMipLevelDimension(width, level));
+                int h = static_cast<int>(getMipLevelDimension(height, level));
+                ownedData.reset(new uint8_t[static_cast<size_t>(w) * h * channels]);
+                decimateBox(cached, width, height, channels, level, ownedData.get(), w, h);
+                cached = ownedData.get();
+                width = w;
+                height = h;
+            }
+            if (channels == 4) {
+                data = cached;
+            } else {
+                ownedData = expandToRGBA8(cached, static_cast<size_t>(width) * height, channels);
+                data = ownedData.get();
+                channels = 4;
+            }
+        } else {
+            error = LoaderError::InvalidParameter;
+            return false;
+        }
+        return true;
+    }
+
+    // readRGBA8 through the shared texel cache: a file level another process decoded is
+    // copied from it, one this process decodes is published for the others
+    bool readDecoded(const std::string& filename, const std::string& readerName,
+                     const hip_demand::TextureInfo& sourceInfo, const unsigned char* cached,
+                     std::shared_ptr<const std::vector<char>> fileData, unsigned int level,
+                     int& width, int& height, int& channels,
+                     std::unique_ptr<uint8_t[]>& ownedData, const unsigned char*& data, LoaderError& error) {
+        SharedTexelKey key;
+        if (!sharedCache_ || filename.empty() || !SharedTexelCache::makeKey(filename, readerName, level, key)) {
+            return readRGBA8(filename, readerName, sourceInfo, cached, std::move(fileData), level, width, height, channels,
+                             ownedData, data, error);
+        }
+        SharedTexelClaim claim;
+        if (sharedCache_->acquire(key, ownedData, width, height, claim) == SharedTexelResult::Hit) {
+            channels = 4;
+            data = ownedData.get();
+            return true;
+        }
+        bool ok = readRGBA8(filename, readerName, sourceInfo, cached, std::move(fileData), level, width, height, channels,
+                            ownedData, data, error);
+        if (ok) {
+            sharedCache_->publish(claim, data, width, height);
+        } else {
+            sharedCache_->abandon(claim);
+        }
+        return ok;
+    }
+
+    // Average 2^levels x 2^levels blocks in one pass, straight to the level a load starts at
+    // (blocks at odd edges average fewer texels)
+    static void decimateBox(const unsigned char* src, int srcWidth, int srcHeight, int channels,
+                            unsigned int levels, unsigned char* dst, int width, int height) {
+        const int block = 1 << levels;
+        for (int y = 0; y < height; ++y) {
+            int y0 = y * block;
+            int y1 = std::min(y0 + block, srcHeight);
+            for (int x = 0; x < width; ++x) {
+                int x0 = x * block;
+                int x1 = std::min(x0 + block, srcWidth);
+                uint32_t sum[4] = {0, 0, 0, 0};
+                for (int sy = y0; sy < y1; ++sy) {
+                    const unsigned char* row = src + (static_cast<size_t>(sy) * srcWidth + x0) * channels;
+                    for (int sx = x0; sx < x1; ++sx, row += channels) {
+                        for (int c = 0; c < channels; ++c) sum[c] += row[c];
+                    }
+                }
+                uint32_t count = static_cast<uint32_t>((y1 - y0) * (x1 - x0));
+                unsigned char* out = dst + (static_cast<size_t>(y) * width + x) * channels;
+                for (int c = 0; c < channels; ++c) {
+                    out[c] = static_cast<unsigned char>((sum[c] + count / 2) / count);
+                }
+            }
+        }
+    }
+
+    // Simple 2x2 box filter from one RGBA8 level to the next
+    static void downsampleBox(const unsigned char* src, int srcWidth, int srcHeight,
+                              unsigned char* dst, int width, int height) {
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int sx = x * 2;
+                int sy = y * 2;
+                
+                for (int c = 0; c < 4; ++c) {
+                    int sum = 0;
+                    int count = 0;
+                    
+                    for (int dy = 0; dy < 2 && (sy + dy) < srcHeight; ++dy) {
+                        for (int dx = 0; dx < 2 && (sx + dx) < srcWidth; ++dx) {
+                            sum += src[((sy + dy) * srcWidth + (sx + dx)) * 4 + c];
+                            count++;
+                        }
+                    }
+                    
+                    dst[(y * width + x) * 4 + c] = sum / count;
+                }
+            }
+        }
+    }
+
     // Generate mipmap levels using simple box filter
-    bool generateMipLevels(hipMipmappedArray_t mipmapArray, unsigned char* baseData, 
+    bool generateMipLevels(hipMipmappedArray_t mipmapArray, const unsigned char* baseData, 
                           int baseWidth, int baseHeight, int numLevels) {
         std::vector<unsigned char> currentLevel(baseWidth * baseHeight * 4);
         std::memcpy(currentLevel.data(), baseData, baseWidth * baseHeight * 4);
@@ -509,28 +2171,7 @@ private:
             height = std::max(1, height / 2);
             
             std::vector<unsigned char> nextLevel(width * height * 4);
-            
-            // Simple box filter downsample
-            for (int y = 0; y < height; ++y) {
-                for (int x = 0; x < width; ++x) {
-                    int sx = x * 2;
-                    int sy = y * 2;
-                    
-                    for (int c = 0; c < 4; ++c) {
-                        int sum = 0;
-                        int count = 0;
-                        
-                        for (int dy = 0; dy < 2 && (sy + dy) < prevHeight; ++dy) {
-                            for (int dx = 0; dx < 2 && (sx + dx) < prevWidth; ++dx) {
-                                sum += currentLevel[((sy + dy) * prevWidth + (sx + dx)) * 4 + c];
-                                count++;
-                            }
-                        }
-                        
-                        nextLevel[(y * width + x) * 4 + c] = sum / count;
-                    }
-                }
-            }
+            downsampleBox(currentLevel.data(), prevWidth, prevHeight, nextLevel.data(), width, height);
             
             // Upload to GPU
             hipArray_t levelArray;
@@ -550,133 +2191,29 @@ private:
         
         return true;
     }
-    bool loadTexture(uint32_t texId) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        TextureMetadata& info = textures_[texId];
-        if (info.resident || info.loading) {
-            return false;
+    // Upload RGBA8 level 0 into info's texture fields: the CPU mip chain, a mipmapped
+    // array or a plain array, plus the texture object. On failure nothing is left
+    // allocated; error is OutOfMemory, or HipError if the upload or cleanup failed.
+    bool createTextureStorage(TextureRecord& info, const unsigned char* data, int width, int height,
+                              const TextureDesc& desc, int& numMipLevels, bool& hasMipmaps,
+                              size_t& memoryUsage, LoaderError& error) {
+        if (cpuBackend()) {
+            if (!buildCpuTexture(info, data, width, height, desc, numMipLevels, memoryUsage)) {
+                error = LoaderError::OutOfMemory;
+                return false;
+            }
+            hasMipmaps = numMipLevels > 1;
+            return true;
         }
-        info.loading = true;
-        TextureDesc desc = info.desc;
-        std::string filename = info.filename;
-        int initWidth = info.width;
-        int initHeight = info.height;
-        int initChannels = info.channels;
-        const unsigned char* cachedPtr = info.cachedData.get();
-        bool hasCached = (cachedPtr != nullptr);
-        lock.unlock();
 
-        // Load image data
-        unsigned char* data = nullptr;
-        bool needsFree = false;
-        int width = initWidth;
-        int height = initHeight;
-        int channels = initChannels;
-        
-        if (!filename.empty()) {
-#ifdef USE_OIIO
-            // Try OIIO first for better format support
-            bool oiioSuccess = false;
-            try {
-                std::unique_ptr<ImageSource> imgSrc = createImageSource(filename);
-                if (imgSrc) {
-                    hip_demand::TextureInfo texInfo;
-                    imgSrc->open(&texInfo);
-                    if (imgSrc->isOpen()) {
-                        width = texInfo.width;
-                        height = texInfo.height;
-                        channels = 4;  // OIIO always provides RGBA
-                        
-                        // Allocate memory for base level
-                        size_t imageSize = width * height * 4;
-                        data = new unsigned char[imageSize];
-                        
-                        // Read base mip level
-                        if (imgSrc->readMipLevel(reinterpret_cast<char*>(data), 0, width, height)) {
-                            needsFree = true;
-                            oiioSuccess = true;
-                        } else {
-                            delete[] data;
-                            data = nullptr;
-                        }
-                        imgSrc->close();
-                    }
-                }
-            } catch (...) {
-                // Fall through to stb_image
-                if (data) {
-                    delete[] data;
-                    data = nullptr;
-                }
-                oiioSuccess = false;
-            }
-            
-            // Fall back to stb_image if OIIO failed
-            if (!oiioSuccess) {
-#endif
-                // Force 4 channels for consistency
-                data = stbi_load(filename.c_str(), &width, &height, &channels, 4);
-                if (!data) {
-                    lock.lock();
-                    info.loading = false;
-                    info.lastError = LoaderError::ImageLoadFailed;
-                    logMessage(LogLevel::Error, "loadTexture: failed to load image '%s'", filename.c_str());
-                    return false;
-                }
-                needsFree = true;
-                channels = 4;  // stbi_load forces 4 channels
-#ifdef USE_OIIO
-            }
-#endif
-        } else if (hasCached) {
-            // Use cached data - convert to 4 channels if needed
-            width = initWidth;
-            height = initHeight;
-            channels = initChannels;
-            
-            if (channels == 4) {
-                data = const_cast<unsigned char*>(cachedPtr);
-            } else {
-                // Convert to 4 channels
-                size_t pixelCount = width * height;
-                unsigned char* data4 = new unsigned char[pixelCount * 4];
-                needsFree = true;
-                
-                for (size_t i = 0; i < pixelCount; ++i) {
-                    if (channels == 1) {
-                        data4[i*4+0] = cachedPtr[i];
-                        data4[i*4+1] = cachedPtr[i];
-                        data4[i*4+2] = cachedPtr[i];
-                        data4[i*4+3] = 255;
-                    } else if (channels == 3) {
-                        data4[i*4+0] = cachedPtr[i*3+0];
-                        data4[i*4+1] = cachedPtr[i*3+1];
-                        data4[i*4+2] = cachedPtr[i*3+2];
-                        data4[i*4+3] = 255;
-                    }
-                }
-                data = data4;
-                channels = 4;
-            }
-        } else {
-            lock.lock();
-            info.loading = false;
-            info.lastError = LoaderError::InvalidParameter;
-            logMessage(LogLevel::Error, "loadTexture: invalid parameters for texId=%u", texId);
+        // Loads run on pool workers, which start on device 0; allocate on the loader's device
+        hipError_t err = hipSetDevice(device_);
+        if (err != hipSuccess) {
+            error = LoaderError::HipError;
             return false;
         }
-        
-        // Update dimensions if not set
-        int finalWidth = width;
-        int finalHeight = height;
-        int finalChannels = channels;
-        
-        hipError_t err;
         bool success = false;
-        
-        // Check if we should generate mipmaps
         bool useMipmaps = desc.generateMipmaps && (width > 1 || height > 1);
-        
         if (useMipmaps) {
             // Create mipmapped array
             int numLevels = calculateMipLevels(width, height);
@@ -689,19 +2226,11 @@ private:
             
             err = hipMallocMipmappedArray(&info.mipmapArray, &channelDesc, extent, numLevels);
             if (err != hipSuccess) {
-                if (needsFree) {
-                    if (!filename.empty()) {
-                        stbi_image_free(data);
-                    } else {
-                        delete[] data;
-                    }
-                }
-                lock.lock();
-                info.loading = false;
-                info.lastError = LoaderError::OutOfMemory;
+                info.mipmapArray = nullptr;
+                error = LoaderError::OutOfMemory;
                 return false;
             }
-            
+
             // Get level 0 array and copy data
             hipArray_t level0Array;
             err = hipGetMipmappedArrayLevel(&level0Array, info.mipmapArray, 0);
@@ -737,9 +2266,9 @@ private:
                 success = (err == hipSuccess);
                 
                 if (success) {
-                    info.hasMipmaps = true;
-                    info.numMipLevels = numLevels;
-                    info.memoryUsage = calculateMipmapMemory(width, height, 4);
+                    hasMipmaps = true;
+                    numMipLevels = numLevels;
+                    memoryUsage = calculateMipmapMemory(width, height, 4);
                 }
             }
         } else {
@@ -771,169 +2300,943 @@ private:
                 success = (err == hipSuccess);
                 
                 if (success) {
-                    info.hasMipmaps = false;
-                    info.numMipLevels = 1;
-                    info.memoryUsage = width * height * 4;
+                    numMipLevels = 1;
+                    memoryUsage = static_cast<size_t>(width) * height * 4;
                 }
             }
         }
         
-        // Free stbi data or converted data
-        if (needsFree) {
-            if (!filename.empty()) {
-                stbi_image_free(data);
+        if (!success) {
+            releaseTextureStorage(info);
+            error = LoaderError::HipError;
+            return false;
+        }
+        return true;
+    }
+
+    // Free whatever createTextureStorage allocated; false if a HIP call failed
+    bool releaseTextureStorage(TextureRecord& info) {
+        bool ok = true;
+        if (info.texObj) {
+            ok &= (hipDestroyTextureObject(info.texObj) == hipSuccess);
+            info.texObj = 0;
+        }
+        if (info.mipmapArray) {
+            ok &= (hipFreeMipmappedArray(info.mipmapArray) == hipSuccess);
+            info.mipmapArray = nullptr;
+        }
+        if (info.array) {
+            ok &= (hipFreeArray(info.array) == hipSuccess);
+            info.array = nullptr;
+        }
+        info.cpuTexture.reset();
+        return ok;
+    }
+
+    // Give up storage that was published. The launch of the current frame may still sample it,
+    // so unless processRequests() has seen that launch finish it is queued until it has.
+    bool retireTextureStorage(TextureRecord& info, size_t bytes) {
+        if (completedFrame_ == currentFrame_) {
+            return releaseTextureStorage(info);
+        }
+        RetiredStorage retired;
+        retired.storage.texObj = info.texObj;
+        retired.storage.array = info.array;
+        retired.storage.mipmapArray = info.mipmapArray;
+        retired.storage.cpuTexture = std::move(info.cpuTexture);
+        retired.bytes = bytes;
+        retired.frame = currentFrame_;
+        info.texObj = 0;
+        info.array = nullptr;
+        info.mipmapArray = nullptr;
+        retired_.push_back(std::move(retired));
+        retiredMemory_ += bytes;
+        return true;
+    }
+
+    // The current frame's launch has finished: free what it could still sample. Frees run
+    // outside the lock; hipFree* calls may wait for the device.
+    void releaseRetiredStorage() {
+        std::vector<RetiredStorage> done;
+        size_t bytes = 0;
+        uint32_t frame;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            completedFrame_ = frame = currentFrame_;
+            while (!retired_.empty() && static_cast<int32_t>(completedFrame_ - retired_.front().frame) >= 0) {
+                bytes += retired_.front().bytes;
+                done.push_back(std::move(retired_.front()));
+                retired_.pop_front();
+            }
+            retiredMemory_ -= bytes;
+        }
+        if (done.empty()) return;
+        bool ok = true;
+        for (RetiredStorage& r : done) {
+            ok &= releaseTextureStorage(r.storage);
+        }
+        if (!ok) {
+            lastError_ = LoaderError::HipError;
+        }
+        logMessage(LogLevel::Debug, "releaseRetiredStorage: frame=%u freed %zu retired (%.2f MB)", frame, done.size(),
+                   static_cast<double>(bytes) / (1024.0 * 1024.0));
+    }
+
+    bool loadTexture(uint32_t texId, std::shared_ptr<const std::vector<char>> fileData = nullptr) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // A resident texture is only reloaded when the mip bias has changed since it loaded
+        bool rebias = textures_.isResident(texId) && !textures_.atlasPage[texId] &&
+                      textures_.records[texId]->loadedMipBias != mipBiasFor(texId);
+        if ((textures_.state[texId] & kTextureLoading) || (textures_.isResident(texId) && !rebias)) {
+            return false;
+        }
+        if (uint32_t page = textures_.atlasPage[texId]) {
+            lock.unlock();
+            return loadAtlasPage(page - 1);
+        }
+        textures_.state[texId] |= kTextureLoading;
+        // The record outlives the unlocked decode; only this thread touches its device fields until published
+        TextureRecord& info = *textures_.records[texId];
+        noteLoadStart(texId, info.latency);
+        TextureDesc desc = info.desc;
+        std::string filename = info.filename;
+        int initWidth = info.width;
+        int initHeight = info.height;
+        int initChannels = info.channels;
+        const unsigned char* cachedPtr = info.cachedData.get();
+        std::string readerName = info.readerName;
+        hip_demand::TextureInfo sourceInfo = info.sourceInfo;
+        uint32_t mipBias = mipBiasFor(texId);
+        lock.unlock();
+        auto loadStart = std::chrono::steady_clock::now();
+
+        // Load image data as RGBA8
+        std::unique_ptr<uint8_t[]> ownedData;
+        const unsigned char* data = nullptr;
+        int width = initWidth;
+        int height = initHeight;
+        int channels = initChannels;
+        LoaderError readError = LoaderError::Success;
+        if (!readDecoded(filename, readerName, sourceInfo, cachedPtr, std::move(fileData), mipBias, width, height, channels,
+                       ownedData, data, readError)) {
+            lock.lock();
+            textures_.state[texId] &= ~kTextureLoading;
+            noteLoadFailure(texId, info, readError);
+            traceLoad(texId, 0, loadStart, false);
+            if (readError == LoaderError::InvalidParameter) {
+                logMessage(LogLevel::Error, "loadTexture: invalid parameters for texId=%u", texId);
             } else {
-                delete[] data;
+                logMessage(LogLevel::Error, "loadTexture: failed to load image '%s'", filename.c_str());
             }
+            return false;
         }
         
-        if (!success) {
-            // Clean up on failure
-            if (info.mipmapArray) {
-                hipError_t cleanupErr = hipFreeMipmappedArray(info.mipmapArray);
-                if (cleanupErr != hipSuccess) {
-                    lastError_ = LoaderError::HipError;
-                }
-                info.mipmapArray = nullptr;
-            }
-            if (info.array) {
-                hipError_t cleanupErr = hipFreeArray(info.array);
-                if (cleanupErr != hipSuccess) {
-                    lastError_ = LoaderError::HipError;
-                }
-                info.array = nullptr;
-            }
+        // Update dimensions if not set; a load that skipped levels keeps the full size
+        uint32_t droppedLevels = mipBias;
+        int finalWidth = droppedLevels ? initWidth : width;
+        int finalHeight = droppedLevels ? initHeight : height;
+        int finalChannels = channels;
+        
+        // Built aside so a texture being reloaded stays sampleable until it is replaced
+        TextureRecord storage;
+        bool hasMipmaps = false;
+        int numMipLevels = 0;
+        size_t memoryUsage = 0;
+        LoaderError uploadError = LoaderError::Success;
+        if (!createTextureStorage(storage, data, width, height, desc, numMipLevels, hasMipmaps, memoryUsage, uploadError)) {
             lock.lock();
-            info.loading = false;
-            info.lastError = LoaderError::HipError;
-            logMessage(LogLevel::Error, "loadTexture: GPU upload failed for texId=%u", texId);
+            textures_.state[texId] &= ~kTextureLoading;
+            noteLoadFailure(texId, info, uploadError);
+            traceLoad(texId, 0, loadStart, false);
+            logMessage(LogLevel::Error, "loadTexture: %s upload failed for texId=%u (%s)", cpuBackend() ? "host" : "GPU", texId, getErrorString(uploadError));
             return false;
         }
         
         // Publish results under lock
         lock.lock();
+        if (textures_.isResident(texId)) {
+            // Reload at a new bias: replace the old copy in place; the texture never leaves residency
+            size_t oldUsage = textures_.memoryUsage[texId];
+            if (!retireTextureStorage(info, oldUsage)) {
+                lastError_ = LoaderError::HipError;
+            }
+            totalMemoryUsage_ -= oldUsage;
+            BudgetGroup& group = budgetGroups_[textures_.budgetGroup[texId]];
+            group.memoryUsage -= oldUsage;
+            group.residentCount--;
+            if (info.loadedMipBias > info.baseMipBias) biasedResidentCount_--;
+            residency_.touch(texId);
+        }
+        info.texObj = storage.texObj;
+        info.array = storage.array;
+        info.mipmapArray = storage.mipmapArray;
+        info.cpuTexture = std::move(storage.cpuTexture);
+        info.loadedMipBias = static_cast<uint8_t>(droppedLevels);
+        if (droppedLevels > info.baseMipBias) biasedResidentCount_++;
         info.width = finalWidth;
         info.height = finalHeight;
         info.channels = finalChannels;
-        h_textures_[texId] = info.texObj;
-        uint32_t wordIdx = texId / 32;
-        uint32_t bitIdx = texId % 32;
-        h_residentFlags_[wordIdx] |= (1u << bitIdx);
-        info.resident = true;
-        info.loading = false;
-        info.lastUsedFrame = currentFrame_;
-        totalMemoryUsage_ += info.memoryUsage;
-        logMessage(LogLevel::Info, "loadTexture: id=%u size=%dx%d mipLevels=%d mem=%.2f MB total=%.2f MB", texId, info.width, info.height, info.numMipLevels, static_cast<double>(info.memoryUsage) / (1024.0 * 1024.0), static_cast<double>(totalMemoryUsage_) / (1024.0 * 1024.0));
+        if (cpuBackend()) {
+            cpuTextures_[texId] = info.cpuTexture.get();
+        } else {
+            waitForTableUploads();
+            h_textures_[texId] = info.texObj;
+        }
+        residency_.set(texId);
+        bool missed = (textures_.state[texId] & kTextureMissPending) != 0;
+        clearFailure(texId, info);
+        info.lastError = LoaderError::Success;
+        textures_.state[texId] = (textures_.state[texId] & kTexturePinned) | kTextureResident |
+                                 (hasMipmaps ? kTextureHasMipmaps : 0);
+        textures_.numMipLevels[texId] = static_cast<uint8_t>(numMipLevels);
+        textures_.lastUsedFrame[texId] = currentFrame_;
+        textures_.memoryUsage[texId] = memoryUsage;
+        textures_.estimatedBytes[texId] = calculateMipmapMemory(finalWidth, finalHeight, 4);
+        totalMemoryUsage_ += memoryUsage;
+        noteLoadedBytes(memoryUsage);
+        chargeBudgetGroup(texId, memoryUsage);
+        traceLoad(texId, memoryUsage, loadStart, true);
+        if (missed) {
+            noteResident(texId, info.latency);
+        }
+        logMessage(LogLevel::Info, "loadTexture: id=%u size=%dx%d mipBias=%u mipLevels=%d mem=%.2f MB total=%.2f MB", texId, info.width, info.height, droppedLevels, numMipLevels, static_cast<double>(memoryUsage) / (1024.0 * 1024.0), static_cast<double>(totalMemoryUsage_) / (1024.0 * 1024.0));
         
         return true;
     }
     
-    void destroyTexture(uint32_t texId) {
-        TextureMetadata& info = textures_[texId];
-        
-        if (!info.resident) return;
-        
-        if (info.texObj) {
-            hipError_t err = hipDestroyTextureObject(info.texObj);
-            if (err != hipSuccess) {
-                lastError_ = LoaderError::HipError;
+    // Decode every member of a page into one RGBA8 image, gutters filled, and upload
+    // it as a single texture. Members that fail keep their failure state; the page is
+    // published if any member decoded. Members decode one after another on this worker.
+    bool loadAtlasPage(uint32_t pageIndex) {
+        struct MemberLoad {
+            uint32_t texId;
+            std::string filename;
+            std::string readerName;
+            hip_demand::TextureInfo sourceInfo;
+            const unsigned char* cached;
+            int width;
+            int height;
+            int channels;
+            uint32_t x;
+            uint32_t y;
+            TextureDesc desc;
+            LoaderError error;
+        };
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        AtlasPage& page = *atlasPages_[pageIndex];
+        if (page.resident || page.loading) {
+            return false;
+        }
+        page.loading = true;
+        std::vector<MemberLoad> loads;
+        loads.reserve(page.members.size());
+        for (uint32_t texId : page.members) {
+            if (textures_.state[texId] & kTextureFailedPermanent) continue;
+            TextureRecord& info = *textures_.records[texId];
+            textures_.state[texId] |= kTextureLoading;
+            noteLoadStart(texId, info.latency);
+            loads.push_back(MemberLoad{texId, info.filename, info.readerName, info.sourceInfo, info.cachedData.get(),
+                                       info.width, info.height, info.channels, info.atlasX, info.atlasY, info.desc,
+                                       LoaderError::Success});
+        }
+        uint32_t pageWidth = page.packer.usedWidth();
+        uint32_t pageHeight = page.packer.usedHeight();
+        TextureDesc pageDesc = page.desc;
+        lock.unlock();
+        auto loadStart = std::chrono::steady_clock::now();
+
+        std::vector<uint8_t> texels(static_cast<size_t>(pageWidth) * pageHeight * 4, 0);
+        size_t decoded = 0;
+        for (MemberLoad& m : loads) {
+            std::unique_ptr<uint8_t[]> ownedData;
+            const unsigned char* data = nullptr;
+            int width = m.width;
+            int height = m.height;
+            int channels = m.channels;
+            if (!readDecoded(m.filename, m.readerName, m.sourceInfo, m.cached, nullptr, 0, width, height, channels,
+                           ownedData, data, m.error)) {
+                logMessage(LogLevel::Error, "loadAtlasPage: failed to load image '%s'", m.filename.c_str());
+                continue;
             }
-            info.texObj = 0;
+            if (width != m.width || height != m.height) {
+                // Its rectangle was sized from the header read at creation
+                m.error = LoaderError::ImageLoadFailed;
+                logMessage(LogLevel::Error, "loadAtlasPage: '%s' is %dx%d, was %dx%d at creation", m.filename.c_str(), width, height, m.width, m.height);
+                continue;
+            }
+            blitAtlasMember(texels.data(), pageWidth, data, width, height, m.x, m.y, static_cast<int>(atlasGutter_), m.desc);
+            decoded++;
         }
-        
-        if (info.mipmapArray) {
-            hipError_t err = hipFreeMipmappedArray(info.mipmapArray);
-            if (err != hipSuccess) {
-                lastError_ = LoaderError::HipError;
+
+        bool hasMipmaps = false;
+        int numMipLevels = 0;
+        size_t memoryUsage = 0;
+        LoaderError uploadError = LoaderError::Success;
+        bool uploaded = decoded > 0 &&
+                        createTextureStorage(page.surface, texels.data(), pageWidth, pageHeight, pageDesc,
+                                             numMipLevels, hasMipmaps, memoryUsage, uploadError);
+
+        lock.lock();
+        page.loading = false;
+        if (!uploaded) {
+            for (const MemberLoad& m : loads) {
+                textures_.state[m.texId] &= ~kTextureLoading;
+                noteLoadFailure(m.texId, *textures_.records[m.texId], m.error != LoaderError::Success ? m.error : uploadError);
+                traceLoad(m.texId, 0, loadStart, false);
             }
-            info.mipmapArray = nullptr;
+            logMessage(LogLevel::Error, "loadAtlasPage: page=%u failed (%s)", pageIndex,
+                       decoded > 0 ? getErrorString(uploadError) : "no member could be loaded");
+            return false;
         }
-        
-        if (info.array) {
-            hipError_t err = hipFreeArray(info.array);
-            if (err != hipSuccess) {
-                lastError_ = LoaderError::HipError;
+        page.resident = true;
+        page.width = pageWidth;
+        page.height = pageHeight;
+        page.memoryUsage = memoryUsage;
+        page.lastUsedFrame = currentFrame_;
+        totalMemoryUsage_ += memoryUsage;
+        noteLoadedBytes(memoryUsage);
+
+        // Members are charged for the page in proportion to their rectangles; the
+        // first one also takes the rounding remainder
+        std::vector<size_t> shares(loads.size(), 0);
+        uint64_t paddedTotal = 0;
+        for (const MemberLoad& m : loads) {
+            if (m.error == LoaderError::Success) {
+                paddedTotal += static_cast<uint64_t>(atlasPaddedSize(m.width)) * atlasPaddedSize(m.height);
             }
-            info.array = nullptr;
         }
-        
-        info.resident = false;
-        info.hasMipmaps = false;
-        info.numMipLevels = 0;
+        size_t charged = 0;
+        size_t first = loads.size();
+        for (size_t i = 0; i < loads.size(); ++i) {
+            if (loads[i].error != LoaderError::Success) continue;
+            uint64_t padded = static_cast<uint64_t>(atlasPaddedSize(loads[i].width)) * atlasPaddedSize(loads[i].height);
+            shares[i] = static_cast<size_t>(memoryUsage * padded / paddedTotal);
+            charged += shares[i];
+            first = std::min(first, i);
+        }
+        shares[first] += memoryUsage - charged;
+
+        for (size_t i = 0; i < loads.size(); ++i) {
+            const MemberLoad& m = loads[i];
+            TextureRecord& info = *textures_.records[m.texId];
+            if (m.error != LoaderError::Success) {
+                textures_.state[m.texId] &= ~kTextureLoading;
+                noteLoadFailure(m.texId, info, m.error);
+                traceLoad(m.texId, 0, loadStart, false);
+                continue;
+            }
+            size_t share = shares[i];
+            if (cpuBackend()) {
+                cpuTextures_[m.texId] = page.surface.cpuTexture.get();
+            } else {
+                waitForTableUploads();
+                h_textures_[m.texId] = page.surface.texObj;
+            }
+            // Border samples stay half a texel of the coarsest page level inside the gutter
+            float border = static_cast<float>(atlasGutter_) - 0.5f * atlasAlignment_;
+            AtlasMapping& mapping = h_atlas_[m.texId];
+            mapping.scaleU = static_cast<float>(m.width) / pageWidth;
+            mapping.scaleV = static_cast<float>(m.height) / pageHeight;
+            mapping.offsetU = static_cast<float>(m.x) / pageWidth;
+            mapping.offsetV = static_cast<float>(m.y) / pageHeight;
+            mapping.borderU = border / m.width;
+            mapping.borderV = border / m.height;
+            mapping.addressModes = static_cast<uint32_t>(m.desc.addressMode[0]) |
+                                   (static_cast<uint32_t>(m.desc.addressMode[1]) << 8);
+            markAtlasDirty(m.texId);
+            residency_.set(m.texId);
+            bool missed = (textures_.state[m.texId] & kTextureMissPending) != 0;
+            clearFailure(m.texId, info);
+            info.lastError = LoaderError::Success;
+            textures_.state[m.texId] = (textures_.state[m.texId] & kTexturePinned) | kTextureResident |
+                                       (hasMipmaps ? kTextureHasMipmaps : 0);
+            textures_.numMipLevels[m.texId] = static_cast<uint8_t>(numMipLevels);
+            textures_.lastUsedFrame[m.texId] = currentFrame_;
+            textures_.memoryUsage[m.texId] = share;
+            chargeBudgetGroup(m.texId, share);
+            traceLoad(m.texId, share, loadStart, true);
+            if (missed) {
+                noteResident(m.texId, info.latency);
+            }
+        }
+        logMessage(LogLevel::Info, "loadAtlasPage: page=%u textures=%zu/%zu size=%ux%u mipLevels=%d mem=%.2f MB total=%.2f MB", pageIndex, decoded, page.members.size(), pageWidth, pageHeight, numMipLevels, static_cast<double>(memoryUsage) / (1024.0 * 1024.0), static_cast<double>(totalMemoryUsage_) / (1024.0 * 1024.0));
+        return true;
+    }
+    
+    void destroyTexture(uint32_t texId) {
+        if (!textures_.isResident(texId)) return;
+        if (uint32_t page = textures_.atlasPage[texId]) {
+            destroyAtlasPage(page - 1);
+            return;
+        }
+        if (!retireTextureStorage(*textures_.records[texId], textures_.memoryUsage[texId])) {
+            lastError_ = LoaderError::HipError;
+        }
+        retireTexture(texId);
+    }
+
+    // Free a resident page and retire all of its members
+    void destroyAtlasPage(uint32_t pageIndex) {
+        AtlasPage& page = *atlasPages_[pageIndex];
+        if (!page.resident) return;
+        if (!retireTextureStorage(page.surface, page.memoryUsage)) {
+            lastError_ = LoaderError::HipError;
+        }
+        for (uint32_t texId : page.members) {
+            if (textures_.isResident(texId)) {
+                retireTexture(texId);
+            }
+        }
+        logMessage(LogLevel::Debug, "destroyAtlasPage: evicted page=%u freed=%.2f MB", pageIndex, static_cast<double>(page.memoryUsage) / (1024.0 * 1024.0));
+        page.resident = false;
+        page.memoryUsage = 0;
+    }
+
+    // launchPrepare's uploads copy the pinned residency, texture and atlas tables when the
+    // stream reaches them, not when they are queued. Edits from other threads (background
+    // eviction, a mid-frame unload or load) wait for them; callers hold mutex_.
+    void waitForTableUploads() {
+        if (!uploadsPending_) return;
+        hipEventSynchronize(uploadEvent_);
+        uploadsPending_ = false;
+    }
+
+    // Clear a texture's residency and accounting once its storage is gone
+    void retireTexture(uint32_t texId) {
+        size_t memoryUsage = textures_.memoryUsage[texId];
+        TextureRecord& info = *textures_.records[texId];
+        if (info.loadedMipBias > info.baseMipBias) {
+            biasedResidentCount_--;
+        }
+        info.loadedMipBias = 0;
+        // A rebias reload may be in flight; it still owns the loading bit
+        textures_.state[texId] &= kTexturePinned | kTextureLoading;
+        textures_.numMipLevels[texId] = 0;
+        textures_.memoryUsage[texId] = 0;
         
         // Update host arrays
-        h_textures_[texId] = 0;
-        uint32_t wordIdx = texId / 32;
-        uint32_t bitIdx = texId % 32;
-        h_residentFlags_[wordIdx] &= ~(1u << bitIdx);
+        waitForTableUploads();
+        if (h_textures_) h_textures_[texId] = 0;
+        if (cpuBackend()) cpuTextures_[texId] = nullptr;
+        residency_.clear(texId);
         
-        logMessage(LogLevel::Debug, "destroyTexture: evicted texId=%u freed=%.2f MB", texId, static_cast<double>(info.memoryUsage) / (1024.0 * 1024.0));
-        totalMemoryUsage_ -= info.memoryUsage;
-        info.memoryUsage = 0;
+        if (trace_) {
+            trace_->writeEvict(currentFrame_, texId, memoryUsage);
+        }
+        logMessage(LogLevel::Debug, "destroyTexture: evicted texId=%u freed=%.2f MB", texId, static_cast<double>(memoryUsage) / (1024.0 * 1024.0));
+        totalMemoryUsage_ -= memoryUsage;
+        BudgetGroup& group = budgetGroups_[textures_.budgetGroup[texId]];
+        group.memoryUsage -= memoryUsage;
+        group.residentCount--;
+    }
+
+    void chargeBudgetGroup(uint32_t texId, size_t bytes) {
+        BudgetGroup& group = budgetGroups_[textures_.budgetGroup[texId]];
+        group.memoryUsage += bytes;
+        group.residentCount++;
     }
     
-    void evictIfNeeded(size_t requiredMemory) {
-        // A budget of 0 means unlimited; never evict.
-        if (options_.maxTextureMemory == 0) {
-            return;
+    // Make room for loads needing groupRequired[g] bytes in budget group g. A group whose
+    // loads would take it over its maximum evicts its own least recently used textures;
+    // the global budget then evicts groups over their maximum first, then any texture
+    // whose group stays at or above its minimum (or that is making room for itself).
+    void evictIfNeeded(const std::vector<size_t>& groupRequired, size_t requiredMemory) {
+        bool groupOverCap = false;
+        for (size_t g = 0; g < groupRequired.size(); ++g) {
+            const BudgetGroup& group = budgetGroups_[g];
+            groupOverCap |= group.maxBytes > 0 && group.memoryUsage + groupRequired[g] > group.maxBytes;
         }
-
-        // Check if we need to free space
-        if (totalMemoryUsage_ + requiredMemory <= options_.maxTextureMemory) {
+        // A budget of 0 means unlimited; only group caps evict then
+        size_t budget = memoryBudget();
+        bool globalOver = budget > 0 && totalMemoryUsage_ + requiredMemory > budget;
+        if (!groupOverCap && !globalOver) {
             return;
         }
 
-        logMessage(LogLevel::Debug, "evictIfNeeded: current=%.2f MB required=%.2f MB budget=%.2f MB", static_cast<double>(totalMemoryUsage_) / (1024.0 * 1024.0), static_cast<double>(requiredMemory) / (1024.0 * 1024.0), static_cast<double>(options_.maxTextureMemory) / (1024.0 * 1024.0));
+        logMessage(LogLevel::Debug, "evictIfNeeded: current=%.2f MB required=%.2f MB budget=%.2f MB", static_cast<double>(totalMemoryUsage_) / (1024.0 * 1024.0), static_cast<double>(requiredMemory) / (1024.0 * 1024.0), static_cast<double>(budget) / (1024.0 * 1024.0));
         
         // Find LRU textures to evict
         std::vector<std::pair<uint32_t, uint32_t>> lruList;  // (frame, texId)
-        for (uint32_t i = 0; i < nextTextureId_; ++i) {
-            if (textures_[i].resident) {
-                lruList.push_back({textures_[i].lastUsedFrame, i});
-            }
-        }
+        lruList.reserve(residency_.count());
+        // Atlas members age with their page, which any member's use keeps alive
+        residency_.forEach([&](uint32_t texId) {
+            uint32_t page = textures_.atlasPage[texId];
+            lruList.push_back({page ? atlasPages_[page - 1]->lastUsedFrame : textures_.lastUsedFrame[texId], texId});
+        });
         
         std::sort(lruList.begin(), lruList.end());
         
+        // Groups over their cap make room among their own textures
+        for (size_t g = 0; groupOverCap && g < groupRequired.size(); ++g) {
+            BudgetGroup& group = budgetGroups_[g];
+            if (group.maxBytes == 0 || group.memoryUsage + groupRequired[g] <= group.maxBytes) continue;
+            size_t target = groupRequired[g] < group.maxBytes ? group.maxBytes - groupRequired[g] : 0;
+            for (const auto& [frame, texId] : lruList) {
+                if (group.memoryUsage <= target) {
+                    break;
+                }
+                if (textures_.budgetGroup[texId] == g && !evictionPinned(texId)) {
+                    evictTexture(texId);
+                }
+            }
+        }
+
+        if (budget == 0) {
+            return;
+        }
+        
         // Evict oldest until we have enough space
-        size_t targetMemory = options_.maxTextureMemory - requiredMemory;
-        for (const auto& [frame, texId] : lruList) {
-            if (totalMemoryUsage_ <= targetMemory) {
-                break;
+        size_t targetMemory = requiredMemory < budget ? budget - requiredMemory : 0;
+        for (int pass = 0; pass < 2 && totalMemoryUsage_ > targetMemory; ++pass) {
+            for (const auto& [frame, texId] : lruList) {
+                if (totalMemoryUsage_ <= targetMemory) {
+                    break;
+                }
+                if (!textures_.isResident(texId) || evictionPinned(texId)) continue;  // Pinned or went with its atlas page
+                uint8_t g = textures_.budgetGroup[texId];
+                const BudgetGroup& group = budgetGroups_[g];
+                bool evictable = (pass == 0) ? (group.maxBytes > 0 && group.memoryUsage > group.maxBytes)
+                                             : (group.memoryUsage >= group.minBytes + evictionBytes(texId) ||
+                                                (g < groupRequired.size() && groupRequired[g] > 0));
+                if (evictable) {
+                    evictTexture(texId);
+                }
             }
-            destroyTexture(texId);
         }
+        if (totalMemoryUsage_ > targetMemory && !pins_.empty()) {
+            logMessage(LogLevel::Warn, "evictIfNeeded: %.2f MB over target, pinned textures hold %.2f MB",
+                       static_cast<double>(totalMemoryUsage_ - targetMemory) / (1024.0 * 1024.0),
+                       static_cast<double>(pinnedMemory()) / (1024.0 * 1024.0));
+        }
+    }
+
+    // Resident bytes pinned textures keep from eviction; callers hold mutex_
+    size_t pinnedMemory() const {
+        size_t bytes = 0;
+        std::unordered_set<uint32_t> pages;
+        for (const auto& [texId, pin] : pins_) {
+            if (!textures_.isResident(texId)) continue;
+            uint32_t page = textures_.atlasPage[texId];
+            if (!page || pages.insert(page).second) {
+                bytes += evictionBytes(texId);
+            }
+        }
+        return bytes;
+    }
+
+    // Track kTexturePinned and the page's pinned member count; callers hold mutex_
+    void setPinned(uint32_t texId, bool pinned) {
+        bool was = (textures_.state[texId] & kTexturePinned) != 0;
+        if (was == pinned) return;
+        if (pinned) {
+            textures_.state[texId] |= kTexturePinned;
+        } else {
+            textures_.state[texId] &= ~kTexturePinned;
+        }
+        if (uint32_t page = textures_.atlasPage[texId]) {
+            atlasPages_[page - 1]->pinnedMembers += pinned ? 1 : -1;
+        }
+    }
+
+    // Drop leases that ended; called once per processRequests
+    void expirePinLeases() {
+        for (auto it = pins_.begin(); it != pins_.end();) {
+            PinRecord& pin = it->second;
+            if (pin.leased && static_cast<int32_t>(currentFrame_ - pin.leaseEndFrame) >= 0) {
+                pin.leased = false;
+                if (pin.count == 0) {
+                    setPinned(it->first, false);
+                    it = pins_.erase(it);
+                    continue;
+                }
+            }
+            ++it;
+        }
+    }
+
+    // Pinned textures keep their atlas page too
+    bool evictionPinned(uint32_t texId) const {
+        uint32_t page = textures_.atlasPage[texId];
+        return page ? atlasPages_[page - 1]->pinnedMembers > 0 : (textures_.state[texId] & kTexturePinned) != 0;
+    }
+
+    // Bytes destroying texId frees: its atlas page for members
+    size_t evictionBytes(uint32_t texId) const {
+        uint32_t page = textures_.atlasPage[texId];
+        return page ? atlasPages_[page - 1]->memoryUsage : textures_.memoryUsage[texId];
+    }
+
+    // Count a requested load for thrash detection; callers hold mutex_
+    void noteThrashLoad(uint32_t texId) {
+        if (options_.thrashWindowFrames == 0 || textures_.atlasPage[texId]) return;
+        TextureRecord& info = *textures_.records[texId];
+        windowLoads_++;
+        thrashLoads_++;
+        // Reloads of copies already shrunk to the current bias are what a higher bias can fix
+        if (info.evicted && currentFrame_ - info.evictedFrame <= options_.thrashWindowFrames &&
+            info.evictedMipBias >= mipBiasFor(texId)) {
+            windowReloads_++;
+            thrashReloads_++;
+        }
+        info.evicted = false;
+    }
+
+    // At the end of each window, raise the mip bias while reloads dominate the loads and
+    // relax it once they have all but stopped and a level less would still fit the budget
+    void updateThrashBias() {
+        if (options_.thrashWindowFrames == 0 || static_cast<int32_t>(currentFrame_ - thrashWindowEnd_) < 0) return;
+        thrashWindowEnd_ = currentFrame_ + options_.thrashWindowFrames;
+        float rate = windowLoads_ ? static_cast<float>(windowReloads_) / windowLoads_ : 0.0f;
+        lastReloadRate_ = rate;
+        if (windowLoads_ >= kMinThrashWindowLoads && rate > options_.thrashReloadThreshold) {
+            if (thrashMipBias_ < options_.maxThrashMipBias) {
+                thrashMipBias_++;
+                logMessage(LogLevel::Info, "thrash: %u of %u loads were reloads, mip bias raised to %u",
+                           windowReloads_, windowLoads_, thrashMipBias_);
+            }
+        } else if (thrashMipBias_ > 0 && rate < options_.thrashReloadThreshold * 0.25f && relaxedBiasFits()) {
+            thrashMipBias_--;
+            logMessage(LogLevel::Info, "thrash: reloads stopped, mip bias relaxed to %u", thrashMipBias_);
+        }
+        windowLoads_ = 0;
+        windowReloads_ = 0;
+    }
+
+    // Would the textures used within the last window fit if those loaded under the current
+    // bias were a level larger? Textures outside it can be evicted to make room.
+    bool relaxedBiasFits() const {
+        size_t budget = memoryBudget();
+        if (budget == 0) return true;
+        size_t projected = 0;
+        residency_.forEach([&](uint32_t texId) {
+            if (currentFrame_ - textures_.lastUsedFrame[texId] > options_.thrashWindowFrames) return;
+            const TextureRecord& info = *textures_.records[texId];
+            size_t bytes = textures_.memoryUsage[texId];
+            bool shrunk = info.loadedMipBias > info.baseMipBias && info.loadedMipBias >= mipBiasFor(texId);
+            projected += shrunk ? bytes * 4 : bytes;
+        });
+        return projected <= budget;
+    }
+
+    // Reload textures sampled this frame whose resident copy was loaded under another mip
+    // bias: shrinking them makes room right away, growing them undoes a relaxed bias. A few
+    // per frame, so a bias change does not stall one frame.
+    void queueMipBiasReloads(const std::vector<uint32_t>& used, std::vector<uint32_t>& toLoad,
+                             size_t& estimatedMemoryNeeded, std::vector<size_t>& groupMemoryNeeded) {
+        if (biasedResidentCount_ == 0 && thrashMipBias_ == 0) return;
+        size_t queued = 0;
+        for (uint32_t texId : used) {
+            if (queued == kMaxMipBiasReloadsPerFrame) break;
+            if (textures_.atlasPage[texId] || textures_.records[texId]->loadedMipBias == mipBiasFor(texId) ||
+                (textures_.state[texId] & kTextureLoading) ||
+                ((textures_.state[texId] & kTextureFailed) && !retryDue(texId))) continue;
+            size_t bytes = loadEstimate(texId);
+            size_t growth = bytes > textures_.memoryUsage[texId] ? bytes - textures_.memoryUsage[texId] : 0;
+            toLoad.push_back(texId);
+            estimatedMemoryNeeded += growth;
+            groupMemoryNeeded[textures_.budgetGroup[texId]] += growth;
+            queued++;
+        }
+    }
+
+    void initBackgroundEviction() {
+        float high = options_.evictionHighWatermark;
+        float low = options_.evictionLowWatermark;
+        if (high < 0.0f || high > 1.0f || low < 0.0f || low > high) {
+            logMessage(LogLevel::Warn, "DemandTextureLoader: ignoring eviction watermarks high=%.2f low=%.2f", high, low);
+            options_.evictionHighWatermark = 0.0f;
+        } else if (high > 0.0f && low == 0.0f) {
+            options_.evictionLowWatermark = high;
+        }
+        if (options_.idleEvictionFrames > 0 && !options_.trackUsage) {
+            logMessage(LogLevel::Warn, "DemandTextureLoader: idle eviction disabled (usage tracking unavailable)");
+            options_.idleEvictionFrames = 0;
+        }
+        nextIdleEvictionFrame_ = options_.idleEvictionFrames;
+    }
+
+    // What eviction works to: maxTextureMemory, capped by the arbiter's share (0 = unlimited)
+    size_t memoryBudget() const {
+        if (!options_.memoryArbiter) return options_.maxTextureMemory;
+        size_t share = arbiterBudget_.load(std::memory_order_relaxed);
+        return options_.maxTextureMemory > 0 ? std::min(options_.maxTextureMemory, share) : share;
+    }
+
+    bool overArbiterBudget() const {
+        return options_.memoryArbiter && totalMemoryUsage_ > memoryBudget();
+    }
+
+    // Tell the arbiter what this loader will hold once the batch loads and what it needs;
+    // callers hold mutex_, which the arbiter never waits on. Demand is pins and the batch plus
+    // what was sampled this launch, or what loaded in the last kDemandWindowFrames launches
+    // when sampling is not tracked.
+    void reportArbiterDemand(const std::vector<uint32_t>& used, size_t estimatedMemoryNeeded) {
+        size_t demand = pinnedMemory();
+        if (!h_usedFlags_) {
+            advanceLoadWindow();
+            size_t loaded = 0;
+            for (size_t bytes : recentLoadBytes_) {
+                loaded += bytes;
+            }
+            demand = std::min(demand + loaded, totalMemoryUsage_);
+        } else {
+            std::unordered_set<uint32_t> pages;
+            for (uint32_t texId : used) {
+                uint32_t page = textures_.atlasPage[texId];
+                if (!evictionPinned(texId) && (!page || pages.insert(page).second)) {
+                    demand += evictionBytes(texId);
+                }
+            }
+        }
+        arbiterBudget_.store(options_.memoryArbiter->report(*arbiterMember_, totalMemoryUsage_ + estimatedMemoryNeeded,
+                                                           demand + estimatedMemoryNeeded),
+                             std::memory_order_relaxed);
+    }
+
+    // Called from another loader's thread when its demand moved this loader's share, so it
+    // must not take mutex_. A share below usage is given back even if this loader is idle:
+    // the HIP backend queues a background eviction now, as processRequests() would; the CPU
+    // backend evicts at its next launchPrepare(), while no render thread samples.
+    void onArbiterBudget(size_t budget, bool evict) {
+        arbiterBudget_.store(budget, std::memory_order_relaxed);
+        if (!evict || !options_.enableEviction) return;
+        if (cpuBackend()) {
+            arbiterEvictPending_.store(true, std::memory_order_relaxed);
+        } else {
+            submitBackgroundEviction();
+        }
+    }
+
+    // Callers hold mutex_
+    void advanceLoadWindow() {
+        uint32_t behind = currentFrame_ - recentLoadFrame_;
+        for (uint32_t i = 0; i < std::min(behind, kDemandWindowFrames); ++i) {
+            recentLoadBytes_[(recentLoadFrame_ + 1 + i) % kDemandWindowFrames] = 0;
+        }
+        recentLoadFrame_ = currentFrame_;
+    }
+
+    void noteLoadedBytes(size_t bytes) {
+        advanceLoadWindow();
+        recentLoadBytes_[currentFrame_ % kDemandWindowFrames] += bytes;
+    }
+
+    size_t watermarkBytes(float fraction) const {
+        return static_cast<size_t>(static_cast<double>(memoryBudget()) * fraction);
+    }
+
+    // Queue a background eviction if usage is above the high mark or the arbiter's share,
+    // or idle textures may be due
+    void scheduleBackgroundEviction() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!options_.enableEviction) return;
+            size_t budget = memoryBudget();
+            bool overHigh = options_.evictionHighWatermark > 0.0f && budget > 0 &&
+                            totalMemoryUsage_ > watermarkBytes(options_.evictionHighWatermark);
+            bool idleDue = options_.idleEvictionFrames > 0 && residency_.count() > 0 &&
+                           static_cast<int32_t>(currentFrame_ - nextIdleEvictionFrame_) >= 0;
+            if (!overHigh && !overArbiterBudget() && !idleDue) return;
+        }
+        submitBackgroundEviction();
+    }
+
+    void submitBackgroundEviction() {
+        {
+            std::lock_guard<std::mutex> lock(evictionMutex_);
+            if (evictionRunning_) return;
+            evictionRunning_ = true;
+        }
+        loadPool_->submit([this]() {
+            runBackgroundEviction();
+            std::lock_guard<std::mutex> lock(evictionMutex_);
+            evictionRunning_ = false;
+            evictionCv_.notify_all();
+        });
+    }
+
+    void waitForBackgroundEviction() {
+        std::unique_lock<std::mutex> lock(evictionMutex_);
+        evictionCv_.wait(lock, [this]() { return !evictionRunning_; });
+    }
+
+    void runBackgroundEviction() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t before = totalMemoryUsage_;
+        if (options_.idleEvictionFrames > 0 && static_cast<int32_t>(currentFrame_ - nextIdleEvictionFrame_) >= 0) {
+            evictIdleTextures();
+        }
+        size_t budget = memoryBudget();
+        size_t high = watermarkBytes(options_.evictionHighWatermark);
+        std::vector<size_t> noGroupLoads(budgetGroups_.size(), 0);
+        if (options_.evictionHighWatermark > 0.0f && budget > 0 && totalMemoryUsage_ > high) {
+            // Evicting to the low mark is evicting as if a batch of (budget - low) bytes were due
+            evictIfNeeded(noGroupLoads, budget - watermarkBytes(options_.evictionLowWatermark));
+        } else if (options_.enableEviction && overArbiterBudget()) {
+            evictIfNeeded(noGroupLoads, 0);
+        }
+        logMessage(LogLevel::Debug, "backgroundEviction: frame=%u %.2f MB -> %.2f MB", currentFrame_,
+                   static_cast<double>(before) / (1024.0 * 1024.0), static_cast<double>(totalMemoryUsage_) / (1024.0 * 1024.0));
+    }
+
+    // Evict textures (atlas pages) not used for idleEvictionFrames launches; pins are kept.
+    // Usage only grows ages, so the earliest any survivor can go idle bounds the next scan.
+    void evictIdleTextures() {
+        uint32_t idleFrames = options_.idleEvictionFrames;
+        uint32_t nextDue = currentFrame_ + idleFrames;
+        std::vector<uint32_t> idle;
+        residency_.forEach([&](uint32_t texId) {
+            if (evictionPinned(texId)) return;
+            uint32_t page = textures_.atlasPage[texId];
+            uint32_t lastUsed = page ? atlasPages_[page - 1]->lastUsedFrame : textures_.lastUsedFrame[texId];
+            if (currentFrame_ - lastUsed >= idleFrames) {
+                idle.push_back(texId);
+            } else if (static_cast<int32_t>(lastUsed + idleFrames - nextDue) < 0) {
+                nextDue = lastUsed + idleFrames;
+            }
+        });
+        for (uint32_t texId : idle) {
+            if (textures_.isResident(texId)) {  // Members go with their page
+                evictTexture(texId);
+            }
+        }
+        nextIdleEvictionFrame_ = nextDue;
+        if (!idle.empty()) {
+            logMessage(LogLevel::Debug, "evictIdleTextures: %zu idle for %u frames", idle.size(), idleFrames);
+        }
+    }
+
+    void evictTexture(uint32_t texId) {
+        TextureRecord& info = *textures_.records[texId];
+        info.evicted = true;
+        info.evictedFrame = currentFrame_;
+        info.evictedMipBias = info.loadedMipBias;
+        BudgetGroup& group = budgetGroups_[textures_.budgetGroup[texId]];
+        size_t residentBefore = group.residentCount;
+        destroyTexture(texId);
+        group.evictionCount += residentBefore - group.residentCount;
     }
     
     LoaderOptions options_;
-    int device_;
+    int device_ = 0;
     std::mutex mutable mutex_;
+    std::unique_ptr<ThreadPool> loadPool_;  // Sized by options_.maxThreads
+    std::unique_ptr<AsyncFileReader> fileReader_;  // Null when options_.ioQueueDepth is 0
+    std::unique_ptr<SharedTexelCache> sharedCache_;  // Null unless options_.sharedCacheName is set
+    std::shared_ptr<MemoryArbiter::Member> arbiterMember_;  // Null unless options_.memoryArbiter is set
+    std::atomic<size_t> arbiterBudget_{0};  // This loader's share, set by reports and the arbiter's callback
+    std::atomic<bool> arbiterEvictPending_{false};  // CPU backend: share fell below usage, evict at launchPrepare
+    std::vector<std::shared_ptr<TexturePack>> packs_;  // Keeps packs mapped while their textures exist
     
     // Device pointers
     uint32_t* d_residentFlags_ = nullptr;
+    uint32_t* d_residentSummary_ = nullptr;  // Points into d_residentFlags_
     hipTextureObject_t* d_textures_ = nullptr;
     uint32_t* d_requests_ = nullptr;
     RequestStats* d_requestStats_ = nullptr;
     uint32_t* d_requestCount_ = nullptr;
     uint32_t* d_requestOverflow_ = nullptr;
+    uint32_t* d_usedFlags_ = nullptr;
+    bool mappedFeedback_ = false;  // d_requests_ and d_requestStats_ alias h_requests_ and h_requestStats_
     
     // Host pinned buffers
-    uint32_t* h_residentFlags_ = nullptr;
+    uint32_t* h_residentFlags_ = nullptr;  // Flag words, then summary words
     hipTextureObject_t* h_textures_ = nullptr;
     uint32_t* h_requests_ = nullptr;
     RequestStats* h_requestStats_ = nullptr;
+    uint32_t* h_usedFlags_ = nullptr;
     size_t flagWordCount_ = 0;
+    hipEvent_t uploadEvent_ = nullptr;  // Recorded after launchPrepare's table uploads
+    bool uploadsPending_ = false;       // uploadEvent_ may not have completed
+
+    // Residency over h_residentFlags_; launchPrepare uploads changed blocks only
+    static constexpr size_t kMaxTransferRuns = 16;
+    ResidencyBitmap residency_;
+    std::vector<ResidencyBitmap::Run> uploadRuns_;
+    std::vector<ResidencyBitmap::Run> usedRuns_;  // Blocks whose usage bits were cleared for this launch
+
+    // CPU backend storage behind the h_ buffers and CpuDemandTextureContext
+    std::vector<uint32_t> cpuResidentFlags_;
+    std::vector<uint32_t> cpuRequests_;
+    std::vector<uint32_t> cpuUsedCopy_;
+    RequestStats cpuRequestStats_;
+    std::vector<const CpuTexture*> cpuTextures_;
+    std::unique_ptr<std::atomic<uint32_t>[]> cpuRequestedFlags_;
+    std::unique_ptr<std::atomic<uint32_t>[]> cpuUsedFlags_;
+    mutable std::atomic<uint32_t> cpuRequestCount_{0};
+    mutable std::atomic<uint32_t> cpuRequestOverflow_{0};
     
     // Texture storage
-    std::vector<TextureMetadata> textures_;
+    TextureTable textures_;
     uint32_t nextTextureId_ = 0;
     uint32_t currentFrame_ = 0;
     size_t totalMemoryUsage_ = 0;
+
+    // Bytes loaded in each of the last kDemandWindowFrames launches; the arbiter demand of a
+    // loader that does not track usage, so it falls once the loader stops loading
+    static constexpr uint32_t kDemandWindowFrames = 64;
+    size_t recentLoadBytes_[kDemandWindowFrames] = {};
+    uint32_t recentLoadFrame_ = 0;  // Frame of the newest recentLoadBytes_ slot
+
+    // Evicted storage waiting for the launch that may sample it (retireTextureStorage)
+    std::deque<RetiredStorage> retired_;
+    size_t retiredMemory_ = 0;
+    uint32_t completedFrame_ = 0;  // Last frame processRequests() saw finish; frame 0 has no launch
     
     // Statistics
     size_t lastRequestCount_ = 0;
     bool lastRequestOverflow_ = false;
     LoaderError lastError_ = LoaderError::Success;
+
+    // Background eviction (LoaderOptions::evictionHighWatermark, idleEvictionFrames); the task
+    // runs on loadPool_ after processRequests(); on the CPU backend the next launchPrepare() waits for it
+    std::mutex evictionMutex_;
+    std::condition_variable evictionCv_;
+    bool evictionRunning_ = false;
+    uint32_t nextIdleEvictionFrame_ = 0;  // No resident texture can be idle before this frame
+
+    // Thrash detection (LoaderOptions::thrashWindowFrames)
+    static constexpr uint32_t kMinThrashWindowLoads = 4;        // Fewer loads say nothing about the rate
+    static constexpr size_t kMaxMipBiasReloadsPerFrame = 4;
+    uint32_t thrashMipBias_ = 0;
+    uint32_t thrashWindowEnd_ = 0;
+    uint32_t windowLoads_ = 0;
+    uint32_t windowReloads_ = 0;
+    uint64_t thrashLoads_ = 0;
+    uint64_t thrashReloads_ = 0;
+    float lastReloadRate_ = 0.0f;
+    size_t biasedResidentCount_ = 0;  // Resident textures loaded under a thrash bias
+
+    // Pinned textures (pinTexture); few, so kept apart from the texture table
+    std::unordered_map<uint32_t, PinRecord> pins_;
+
+    // Budget groups; TextureTable::budgetGroup indexes them, [0] is the default group
+    std::vector<BudgetGroup> budgetGroups_;
+
+    // Failed loads
+    size_t failedTextureCount_ = 0;
+    uint64_t suppressedRetries_ = 0;
+
+    // Miss-to-resident latency by size class; the extra last entry covers all classes
+    LatencyHistogram latencyFrames_[kTextureSizeClassCount + 1];
+    LatencyHistogram latencyMicros_[kTextureSizeClassCount + 1];  // Microseconds
+    uint64_t latencyPending_ = 0;
+
+    // Optional activity trace (startTrace/stopTrace)
+    std::unique_ptr<RequestTraceWriter> trace_;
+
+    // Atlas packing (options_.atlasMaxTextureSize); TextureTable::atlasPage indexes atlasPages_ from 1
+    static constexpr size_t kAtlasOpenPages = 4;  // Most recent pages tried before starting a new one
+    std::vector<std::unique_ptr<AtlasPage>> atlasPages_;
+    uint32_t atlasGutter_ = 0;                    // Per side, a multiple of atlasAlignment_
+    uint32_t atlasAlignment_ = 1;                 // Keeps rectangles on texel boundaries in every page level
+    int atlasMipLevels_ = 1;
+    AtlasMapping* h_atlas_ = nullptr;             // Pinned copy (CPU backend: cpuAtlas_, read by samplers)
+    AtlasMapping* d_atlas_ = nullptr;
+    std::vector<AtlasMapping> cpuAtlas_;
+    uint32_t atlasDirtyBegin_ = UINT32_MAX;       // Mappings changed since the last upload
+    uint32_t atlasDirtyEnd_ = 0;
 };
 
 // Public API implementation
@@ -947,6 +3250,11 @@ TextureHandle DemandTextureLoader::createTexture(const std::string& filename,
     return impl_->createTexture(filename, desc);
 }
 
+std::vector<TextureHandle> DemandTextureLoader::createTexturesFromPack(const std::string& packPath,
+                                                                      const TextureDesc& desc) {
+    return impl_->createTexturesFromPack(packPath, desc);
+}
+
 TextureHandle DemandTextureLoader::createTextureFromMemory(const void* data, 
                                                            int width, int height, int channels,
                                                            const TextureDesc& desc) {
@@ -957,6 +3265,10 @@ void DemandTextureLoader::launchPrepare(hipStream_t stream) {
     impl_->launchPrepare(stream);
 }
 
+CpuDemandTextureContext DemandTextureLoader::getCpuContext() const {
+    return impl_->getCpuContext();
+}
+
 DeviceContext DemandTextureLoader::getDeviceContext() const {
     return impl_->getDeviceContext();
 }
@@ -969,10 +3281,18 @@ size_t DemandTextureLoader::getResidentTextureCount() const {
     return impl_->getResidentTextureCount();
 }
 
+std::vector<uint32_t> DemandTextureLoader::getResidentTextureIds() const {
+    return impl_->getResidentTextureIds();
+}
+
 size_t DemandTextureLoader::getTotalTextureMemory() const {
     return impl_->getTotalTextureMemory();
 }
 
+size_t DemandTextureLoader::getRetiredTextureMemory() const {
+    return impl_->getRetiredTextureMemory();
+}
+
 size_t DemandTextureLoader::getRequestCount() const {
     return impl_->getRequestCount();
 }
@@ -985,6 +3305,82 @@ LoaderError DemandTextureLoader::getLastError() const {
     return impl_->getLastError();
 }
 
+size_t DemandTextureLoader::getFailedTextureCount() const {
+    return impl_->getFailedTextureCount();
+}
+
+uint64_t DemandTextureLoader::getSuppressedRetryCount() const {
+    return impl_->getSuppressedRetryCount();
+}
+
+LoaderError DemandTextureLoader::getTextureError(uint32_t textureId) const {
+    return impl_->getTextureError(textureId);
+}
+
+void DemandTextureLoader::retryFailedTextures() {
+    impl_->retryFailedTextures();
+}
+
+LatencyReport DemandTextureLoader::getLatencyReport() const {
+    return impl_->getLatencyReport();
+}
+
+TextureLatency DemandTextureLoader::getTextureLatency(uint32_t textureId) const {
+    return impl_->getTextureLatency(textureId);
+}
+
+void DemandTextureLoader::resetLatencyStats() {
+    impl_->resetLatencyStats();
+}
+
+AtlasStats DemandTextureLoader::getAtlasStats() const {
+    return impl_->getAtlasStats();
+}
+
+uint32_t DemandTextureLoader::createBudgetGroup(const std::string& name, size_t minBytes, size_t maxBytes) {
+    return impl_->createBudgetGroup(name, minBytes, maxBytes);
+}
+
+bool DemandTextureLoader::setBudgetGroupLimits(uint32_t group, size_t minBytes, size_t maxBytes) {
+    return impl_->setBudgetGroupLimits(group, minBytes, maxBytes);
+}
+
+std::vector<BudgetGroupStats> DemandTextureLoader::getBudgetGroupStats() const {
+    return impl_->getBudgetGroupStats();
+}
+
+bool DemandTextureLoader::pinTexture(uint32_t textureId, uint32_t frames) {
+    return impl_->pinTexture(textureId, frames);
+}
+
+bool DemandTextureLoader::unpinTexture(uint32_t textureId) {
+    return impl_->unpinTexture(textureId);
+}
+
+bool DemandTextureLoader::isTexturePinned(uint32_t textureId) const {
+    return impl_->isTexturePinned(textureId);
+}
+
+size_t DemandTextureLoader::getPinnedTextureCount() const {
+    return impl_->getPinnedTextureCount();
+}
+
+size_t DemandTextureLoader::getPinnedTextureMemory() const {
+    return impl_->getPinnedTextureMemory();
+}
+
+ThrashStats DemandTextureLoader::getThrashStats() const {
+    return impl_->getThrashStats();
+}
+
+uint32_t DemandTextureLoader::getTextureMipBias(uint32_t textureId) const {
+    return impl_->getTextureMipBias(textureId);
+}
+
+SharedCacheStats DemandTextureLoader::getSharedCacheStats() const {
+    return impl_->getSharedCacheStats();
+}
+
 void DemandTextureLoader::enableEviction(bool enable) {
     impl_->enableEviction(enable);
 }
@@ -997,6 +3393,26 @@ size_t DemandTextureLoader::getMaxTextureMemory() const {
     return impl_->getMaxTextureMemory();
 }
 
+size_t DemandTextureLoader::getMemoryBudget() const {
+    return impl_->getMemoryBudget();
+}
+
+bool DemandTextureLoader::startTrace(const std::string& path) {
+    return impl_->startTrace(path);
+}
+
+void DemandTextureLoader::stopTrace() {
+    impl_->stopTrace();
+}
+
+bool DemandTextureLoader::saveResidencySnapshot(const std::string& path) {
+    return impl_->saveResidencySnapshot(path);
+}
+
+size_t DemandTextureLoader::warmStart(const std::string& path) {
+    return impl_->warmStart(path);
+}
+
 void DemandTextureLoader::unloadTexture(uint32_t textureId) {
     impl_->unloadTexture(textureId);
 }
@@ -0,0 +1,64 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hip_demand {
+
+static uint32_t floorLog2(uint64_t value) {
+    uint32_t n = 0;
+    while (value >>= 1) {
+        n++;
+    }
+    return n;
+}
+
+size_t LatencyHistogram::bucketFor(uint64_t value) {
+    if (value < kLinearBuckets) {
+        return static_cast<size_t>(value);
+    }
+    // value in [2^e, 2^(e+1)), e >= 4; the next three bits pick the sub-bucket
+    uint32_t e = floorLog2(value);
+    size_t sub = static_cast<size_t>((value >> (e - 3)) & (kSubBuckets - 1));
+    return kLinearBuckets + (e - 4) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < kLinearBuckets) {
+        return bucket;
+    }
+    size_t e = 4 + (bucket - kLinearBuckets) / kSubBuckets;
+    uint64_t sub = (bucket - kLinearBuckets) % kSubBuckets;
+    uint64_t width = 1ull << (e - 3);
+    return (kSubBuckets + sub) * width + (width - 1);
+}
+
+void LatencyHistogram::add(uint64_t value) {
+    buckets_[bucketFor(value)]++;
+    count_++;
+    max_ = std::max(max_, value);
+}
+
+void LatencyHistogram::clear() {
+    buckets_.fill(0);
+    count_ = 0;
+    max_ = 0;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    p = std::min(std::max(p, 0.0), 1.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * static_cast<double>(count_))));
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kBucketCount; ++b) {
+        seen += buckets_[b];
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(b), max_);
+        }
+    }
+    return max_;
+}
+
+} // namespace hip_demand
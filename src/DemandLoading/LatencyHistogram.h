@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace hip_demand {
+
+// Log-linear histogram of non-negative integer samples (frames, microseconds).
+// Values below 16 have their own bucket; above that each power of two is split
+// into 8 buckets, so a reported percentile is within 12.5% of the true sample.
+// Fixed size (about 4 KB), no allocation on add().
+class LatencyHistogram {
+public:
+    void add(uint64_t value);
+    void clear();
+
+    uint64_t count() const { return count_; }
+    uint64_t max() const { return max_; }
+
+    // Smallest bucket bound covering fraction p (0..1) of the samples, capped at max(); 0 if empty
+    uint64_t percentile(double p) const;
+
+private:
+    static constexpr size_t kLinearBuckets = 16;
+    static constexpr size_t kSubBuckets = 8;
+    static constexpr size_t kBucketCount = kLinearBuckets + (64 - 4) * kSubBuckets;
+
+    static size_t bucketFor(uint64_t value);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+    std::array<uint64_t, kBucketCount> buckets_{};
+    uint64_t count_ = 0;
+    uint64_t max_ = 0;
+};
+
+} // namespace hip_demand
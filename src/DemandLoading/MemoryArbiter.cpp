@@ -0,0 +1,197 @@
+#include "DemandLoading/MemoryArbiter.h"
+#include "DemandLoading/Logging.h"
+
+#include <hip/hip_runtime.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace hip_demand {
+
+struct MemoryArbiter::Member {
+    uint32_t id = 0;
+    int priority = 0;
+    size_t usage = 0;
+    size_t demand = 0;
+    size_t budget = 0;
+    uint64_t evictionRequests = 0;
+    // Held while the callback runs, so leave() can wait out a call in flight
+    std::mutex callbackMutex;
+    BudgetCallback budgetChanged;
+};
+
+MemoryArbiter::MemoryArbiter(const MemoryArbiterOptions& options) : options_(options) {}
+
+MemoryArbiter::~MemoryArbiter() = default;
+
+size_t MemoryArbiter::getTotalBudget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totalBudget_;
+}
+
+std::vector<ArbiterLoaderStats> MemoryArbiter::getLoaderStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<ArbiterLoaderStats> stats;
+    stats.reserve(members_.size());
+    for (const auto& m : members_) {
+        stats.push_back({m->id, m->priority, m->usage, m->demand, m->budget, m->evictionRequests});
+    }
+    return stats;
+}
+
+std::shared_ptr<MemoryArbiter::Member> MemoryArbiter::join(int priority, BudgetCallback budgetChanged) {
+    auto member = std::make_shared<Member>();
+    member->priority = priority;
+    member->budgetChanged = std::move(budgetChanged);
+    std::vector<std::shared_ptr<Member>> notices;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        member->id = nextId_++;
+        members_.push_back(member);
+        rebalance(notices, member.get());
+    }
+    notify(notices);
+    return member;
+}
+
+void MemoryArbiter::leave(const std::shared_ptr<Member>& member) {
+    std::vector<std::shared_ptr<Member>> notices;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find(members_.begin(), members_.end(), member);
+        if (it == members_.end()) return;
+        members_.erase(it);
+        rebalance(notices, nullptr);
+    }
+    {
+        std::lock_guard<std::mutex> lock(member->callbackMutex);
+        member->budgetChanged = nullptr;
+    }
+    notify(notices);
+}
+
+size_t MemoryArbiter::report(Member& member, size_t usage, size_t demand) {
+    std::vector<std::shared_ptr<Member>> notices;
+    size_t budget;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        member.usage = usage;
+        // Demand sampled in one frame can miss textures used every few frames; let it fall slowly
+        member.demand = std::max(demand, member.demand - member.demand / 8);
+        rebalance(notices, &member);
+        budget = member.budget;
+    }
+    notify(notices);
+    return budget;
+}
+
+// Callers hold mutex_
+size_t MemoryArbiter::poolBytes() {
+    bool derive = options_.deriveFromFreeMemory || options_.totalBytes == 0;
+    if (!derive) return options_.totalBytes;
+
+    auto now = std::chrono::steady_clock::now();
+    if (!deviceQueried_ || now - lastDeviceQuery_ >= std::chrono::milliseconds(options_.deviceQueryIntervalMs)) {
+        size_t freeBytes = 0;
+        size_t totalBytes = 0;
+        if (hipMemGetInfo(&freeBytes, &totalBytes) == hipSuccess) {
+            // What the loaders hold is theirs to split too; freezing it with the free count
+            // keeps the pool steady while they load between queries
+            size_t held = 0;
+            for (const auto& m : members_) {
+                held += m->usage;
+            }
+            size_t available = freeBytes + held;
+            deviceBytes_ = available > options_.safetyMarginBytes ? available - options_.safetyMarginBytes : 0;
+        } else {
+            if (!deviceQueried_) {
+                logMessage(LogLevel::Warn, "MemoryArbiter: hipMemGetInfo failed; %s",
+                           options_.totalBytes ? "using totalBytes" : "the pool is unlimited");
+            }
+            deviceBytes_ = SIZE_MAX;
+        }
+        lastDeviceQuery_ = now;
+        deviceQueried_ = true;
+    }
+    return options_.totalBytes ? std::min(options_.totalBytes, deviceBytes_) : deviceBytes_;
+}
+
+// Callers hold mutex_. Queues a notice for every member but the reporter whose budget changed.
+void MemoryArbiter::rebalance(std::vector<std::shared_ptr<Member>>& notices, const Member* reporter) {
+    totalBudget_ = poolBytes();
+    size_t count = members_.size();
+    if (count == 0) return;
+
+    std::vector<size_t> budgets(count, 0);
+    size_t remaining = totalBudget_;
+
+    // A floor for everyone first, so the lowest priority keeps a little of its working set
+    size_t floor = std::min(options_.minLoaderBytes, totalBudget_ / count);
+    for (size_t i = 0; i < count; ++i) {
+        budgets[i] = std::min(floor, members_[i]->demand);
+        remaining -= budgets[i];
+    }
+
+    // Then whole priorities, highest first, until the pool runs out
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return members_[a]->priority > members_[b]->priority; });
+    for (size_t first = 0; first < count && remaining > 0;) {
+        size_t last = first;
+        size_t wanted = 0;
+        while (last < count && members_[order[last]]->priority == members_[order[first]]->priority) {
+            size_t i = order[last++];
+            wanted += members_[i]->demand - budgets[i];
+        }
+        if (wanted <= remaining) {
+            for (size_t k = first; k < last; ++k) budgets[order[k]] = members_[order[k]]->demand;
+            remaining -= wanted;
+        } else {
+            // The tier the pool runs out in shares what is left by unmet demand
+            size_t granted = 0;
+            for (size_t k = first; k < last; ++k) {
+                size_t i = order[k];
+                size_t share = static_cast<size_t>(static_cast<long double>(remaining) *
+                                                   (members_[i]->demand - budgets[i]) / wanted);
+                budgets[i] += share;
+                granted += share;
+            }
+            remaining -= granted;
+            break;
+        }
+        first = last;
+    }
+
+    // Slack goes to everyone evenly; it absorbs demand growth until the next report
+    size_t slack = remaining / count;
+    for (size_t i = 0; i < count; ++i) {
+        Member& m = *members_[i];
+        // Never 0: a loader reads a budget of 0 as unlimited
+        size_t budget = std::max<size_t>(budgets[i] + slack, 1);
+        if (budget == m.budget) continue;
+        bool evict = budget < m.usage && budget < m.budget;
+        if (evict) m.evictionRequests++;
+        m.budget = budget;
+        if (&m != reporter) {
+            notices.push_back(members_[i]);
+        }
+    }
+}
+
+// Concurrent rebalances may notify out of order, so each call passes the latest budget
+void MemoryArbiter::notify(const std::vector<std::shared_ptr<Member>>& notices) {
+    for (const auto& member : notices) {
+        std::lock_guard<std::mutex> callbackLock(member->callbackMutex);
+        if (!member->budgetChanged) continue;
+        size_t budget;
+        bool evict;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            budget = member->budget;
+            evict = budget < member->usage;
+        }
+        member->budgetChanged(budget, evict);
+    }
+}
+
+} // namespace hip_demand
@@ -0,0 +1,219 @@
+#include "DemandLoading/RequestTrace.h"
+
+#include <cstring>
+
+namespace hip_demand {
+
+static const char kTraceMagic[8] = {'H', 'D', 'T', 'R', 'A', 'C', 'E', '\0'};
+static const uint64_t kTraceVersion = 2;  // 2 added Latency records
+static const uint64_t kMinTraceVersion = 1;
+
+// Guards against reading absurd lengths from a corrupt file
+static const uint64_t kMaxTraceString = 1u << 16;
+static const uint64_t kMaxTraceRequests = 1u << 28;
+
+RequestTraceWriter::~RequestTraceWriter() {
+    close();
+}
+
+bool RequestTraceWriter::open(const std::string& path) {
+    close();
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+        return false;
+    }
+    out_.write(kTraceMagic, sizeof(kTraceMagic));
+    putVarint(kTraceVersion);
+    eventCount_ = 0;
+    return out_.good();
+}
+
+void RequestTraceWriter::close() {
+    if (out_.is_open()) {
+        out_.close();
+    }
+}
+
+void RequestTraceWriter::putVarint(uint64_t value) {
+    char buf[10];
+    int n = 0;
+    do {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        if (value) byte |= 0x80;
+        buf[n++] = static_cast<char>(byte);
+    } while (value);
+    out_.write(buf, n);
+}
+
+void RequestTraceWriter::putString(const std::string& s) {
+    putVarint(s.size());
+    out_.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+void RequestTraceWriter::writeTexture(uint32_t frame, uint32_t textureId, uint32_t width, uint32_t height,
+                                      uint32_t channels, uint64_t estimatedBytes, const std::string& filename) {
+    out_.put(static_cast<char>(TraceEventType::Texture));
+    putVarint(frame);
+    putVarint(textureId);
+    putVarint(width);
+    putVarint(height);
+    putVarint(channels);
+    putVarint(estimatedBytes);
+    putString(filename);
+    eventCount_++;
+}
+
+void RequestTraceWriter::writeRequests(uint32_t frame, const std::vector<uint32_t>& textureIds) {
+    out_.put(static_cast<char>(TraceEventType::Requests));
+    putVarint(frame);
+    putVarint(textureIds.size());
+    for (uint32_t id : textureIds) {
+        putVarint(id);
+    }
+    eventCount_++;
+}
+
+void RequestTraceWriter::writeLoad(uint32_t frame, uint32_t textureId, uint64_t bytes, uint32_t micros, bool success) {
+    out_.put(static_cast<char>(TraceEventType::Load));
+    putVarint(frame);
+    putVarint(textureId);
+    putVarint(bytes);
+    putVarint(micros);
+    putVarint(success ? 1 : 0);
+    eventCount_++;
+}
+
+void RequestTraceWriter::writeEvict(uint32_t frame, uint32_t textureId, uint64_t bytes) {
+    out_.put(static_cast<char>(TraceEventType::Evict));
+    putVarint(frame);
+    putVarint(textureId);
+    putVarint(bytes);
+    eventCount_++;
+}
+
+void RequestTraceWriter::writeBudget(uint32_t frame, uint64_t maxTextureMemory) {
+    out_.put(static_cast<char>(TraceEventType::Budget));
+    putVarint(frame);
+    putVarint(maxTextureMemory);
+    eventCount_++;
+}
+
+void RequestTraceWriter::writeLatency(uint32_t frame, uint32_t textureId, uint64_t estimatedBytes, uint32_t missFrame,
+                                      uint32_t queueMicros, uint32_t totalMicros) {
+    out_.put(static_cast<char>(TraceEventType::Latency));
+    putVarint(frame);
+    putVarint(textureId);
+    putVarint(estimatedBytes);
+    putVarint(missFrame);
+    putVarint(queueMicros);
+    putVarint(totalMicros);
+    eventCount_++;
+}
+
+bool RequestTraceReader::open(const std::string& path) {
+    error_ = false;
+    in_.open(path, std::ios::binary);
+    if (!in_) {
+        return false;
+    }
+    char magic[sizeof(kTraceMagic)];
+    uint64_t version = 0;
+    if (!in_.read(magic, sizeof(magic)) || std::memcmp(magic, kTraceMagic, sizeof(magic)) != 0 ||
+        !getVarint(version) || version < kMinTraceVersion || version > kTraceVersion) {
+        in_.close();
+        return false;
+    }
+    return true;
+}
+
+bool RequestTraceReader::getVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in_.get();
+        if (c == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RequestTraceReader::getString(std::string& s) {
+    uint64_t size = 0;
+    if (!getVarint(size) || size > kMaxTraceString) {
+        return false;
+    }
+    s.resize(size);
+    return size == 0 || in_.read(&s[0], static_cast<std::streamsize>(size));
+}
+
+bool RequestTraceReader::next(TraceEvent& event) {
+    if (!in_.is_open() || error_) {
+        return false;
+    }
+    int type = in_.get();
+    if (type == std::char_traits<char>::eof()) {
+        return false;
+    }
+
+    event = TraceEvent();
+    event.type = static_cast<TraceEventType>(type);
+    uint64_t frame = 0, id = 0, a = 0, b = 0, c = 0, d = 0;
+    bool ok = getVarint(frame);
+    event.frame = static_cast<uint32_t>(frame);
+
+    switch (event.type) {
+        case TraceEventType::Texture:
+            ok = ok && getVarint(id) && getVarint(a) && getVarint(b) && getVarint(c) &&
+                 getVarint(event.bytes) && getString(event.filename);
+            event.textureId = static_cast<uint32_t>(id);
+            event.width = static_cast<uint32_t>(a);
+            event.height = static_cast<uint32_t>(b);
+            event.channels = static_cast<uint32_t>(c);
+            break;
+        case TraceEventType::Requests:
+            ok = ok && getVarint(a) && a <= kMaxTraceRequests;
+            if (ok) {
+                event.textureIds.resize(a);
+                for (uint64_t i = 0; ok && i < a; ++i) {
+                    ok = getVarint(id);
+                    event.textureIds[i] = static_cast<uint32_t>(id);
+                }
+            }
+            break;
+        case TraceEventType::Load:
+            ok = ok && getVarint(id) && getVarint(event.bytes) && getVarint(c) && getVarint(d);
+            event.textureId = static_cast<uint32_t>(id);
+            event.micros = static_cast<uint32_t>(c);
+            event.success = (d != 0);
+            break;
+        case TraceEventType::Evict:
+            ok = ok && getVarint(id) && getVarint(event.bytes);
+            event.textureId = static_cast<uint32_t>(id);
+            break;
+        case TraceEventType::Budget:
+            ok = ok && getVarint(event.bytes);
+            break;
+        case TraceEventType::Latency:
+            ok = ok && getVarint(id) && getVarint(event.bytes) && getVarint(a) && getVarint(c) && getVarint(d);
+            event.textureId = static_cast<uint32_t>(id);
+            event.missFrame = static_cast<uint32_t>(a);
+            event.queueMicros = static_cast<uint32_t>(c);
+            event.micros = static_cast<uint32_t>(d);
+            break;
+        default:
+            ok = false;
+            break;
+    }
+
+    if (!ok) {
+        error_ = true;
+    }
+    return ok;
+}
+
+} // namespace hip_demand
@@ -0,0 +1,89 @@
+#include "ResidencyBitmap.h"
+
+#include <algorithm>
+
+namespace hip_demand {
+
+// Runs separated by at most this many clean blocks are uploaded as one copy;
+// a few KB of redundant transfer is cheaper than another API call.
+static const size_t kRunMergeGap = 4;
+
+void ResidencyBitmap::attach(uint32_t* words, uint32_t* summary, size_t maxTextures) {
+    words_ = words;
+    summary_ = summary;
+    wordCount_ = wordCountFor(maxTextures);
+    summaryCount_ = summaryCountFor(maxTextures);
+    count_ = 0;
+    std::fill_n(words_, wordCount_, 0u);
+    std::fill_n(summary_, summaryCount_, 0u);
+    dirty_.assign((summaryCount_ + 31) / 32, 0u);
+}
+
+void ResidencyBitmap::set(uint32_t texId) {
+    const size_t w = texId / 32;
+    const uint32_t bit = 1u << (texId % 32);
+    if (words_[w] & bit) return;
+    words_[w] |= bit;
+    summary_[w / 32] |= 1u << (w % 32);
+    dirty_[w / 1024] |= 1u << ((w / 32) % 32);
+    count_++;
+}
+
+void ResidencyBitmap::clear(uint32_t texId) {
+    const size_t w = texId / 32;
+    const uint32_t bit = 1u << (texId % 32);
+    if (!(words_[w] & bit)) return;
+    words_[w] &= ~bit;
+    if (words_[w] == 0) {
+        summary_[w / 32] &= ~(1u << (w % 32));
+    }
+    dirty_[w / 1024] |= 1u << ((w / 32) % 32);
+    count_--;
+}
+
+void ResidencyBitmap::touch(uint32_t texId) {
+    const size_t w = texId / 32;
+    dirty_[w / 1024] |= 1u << ((w / 32) % 32);
+}
+
+void ResidencyBitmap::takeDirtyRuns(std::vector<Run>& runs, size_t maxRuns) {
+    std::vector<size_t> blocks;
+    for (size_t d = 0; d < dirty_.size(); ++d) {
+        for (uint32_t bits = dirty_[d]; bits; bits &= bits - 1) {
+            blocks.push_back(d * 32 + countTrailingZeros(bits));
+        }
+        dirty_[d] = 0;
+    }
+    coalesce(blocks, runs, maxRuns);
+}
+
+void ResidencyBitmap::markAllDirty() {
+    for (size_t block = 0; block < summaryCount_; ++block) {
+        dirty_[block / 32] |= 1u << (block % 32);
+    }
+}
+
+void ResidencyBitmap::residentRuns(std::vector<Run>& runs, size_t maxRuns) const {
+    std::vector<size_t> blocks;
+    for (size_t s = 0; s < summaryCount_; ++s) {
+        if (summary_[s]) blocks.push_back(s);
+    }
+    coalesce(blocks, runs, maxRuns);
+}
+
+void ResidencyBitmap::coalesce(const std::vector<size_t>& blocks, std::vector<Run>& runs, size_t maxRuns) {
+    // Widen the bridged gap until the run count fits
+    for (size_t gap = kRunMergeGap;; gap *= 2) {
+        runs.clear();
+        for (size_t block : blocks) {
+            if (!runs.empty() && block <= runs.back().firstBlock + runs.back().blockCount + gap) {
+                runs.back().blockCount = block - runs.back().firstBlock + 1;
+            } else {
+                runs.push_back(Run{block, 1});
+            }
+        }
+        if (runs.size() <= std::max<size_t>(maxRuns, 1)) return;
+    }
+}
+
+} // namespace hip_demand
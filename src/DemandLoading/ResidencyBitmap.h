@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hip_demand {
+
+// Two-level residency bitmap over caller-owned (pinned) storage.
+// Level 0 holds one bit per texture, 32 per word. Level 1 (the summary) holds one
+// bit per level-0 word, set while that word is nonzero, so one summary word
+// covers a block of 1024 textures. Blocks changed since the last upload are
+// tracked so only those have to be copied to the device.
+class ResidencyBitmap {
+public:
+    static constexpr uint32_t kTexturesPerBlock = 32 * 32;
+
+    // Contiguous range of blocks
+    struct Run {
+        size_t firstBlock;
+        size_t blockCount;
+    };
+
+    static size_t wordCountFor(size_t maxTextures) { return (maxTextures + 31) / 32; }
+    static size_t summaryCountFor(size_t maxTextures) { return (wordCountFor(maxTextures) + 31) / 32; }
+
+    // words and summary must hold wordCountFor() and summaryCountFor() entries; both are cleared
+    void attach(uint32_t* words, uint32_t* summary, size_t maxTextures);
+
+    void set(uint32_t texId);
+    void clear(uint32_t texId);
+    void touch(uint32_t texId);  // Mark texId's block changed, e.g. after its texture object was replaced
+
+    size_t count() const { return count_; }
+    size_t wordCount() const { return wordCount_; }
+    size_t blockCount() const { return summaryCount_; }
+
+    // Calls fn(texId) for every resident texture in ascending id order; cost scales
+    // with the number of occupied blocks, not maxTextures
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t s = 0; s < summaryCount_; ++s) {
+            for (uint32_t summaryBits = summary_[s]; summaryBits; summaryBits &= summaryBits - 1) {
+                size_t w = s * 32 + countTrailingZeros(summaryBits);
+                for (uint32_t bits = words_[w]; bits; bits &= bits - 1) {
+                    fn(static_cast<uint32_t>(w * 32 + countTrailingZeros(bits)));
+                }
+            }
+        }
+    }
+
+    // Blocks changed since the previous call, coalesced into at most maxRuns runs
+    // (nearby runs are merged, bridging a few clean blocks). Resets the changed set.
+    void takeDirtyRuns(std::vector<Run>& runs, size_t maxRuns);
+
+    // Force the next takeDirtyRuns() to cover every block (e.g. after a failed upload)
+    void markAllDirty();
+
+    // Blocks holding at least one resident texture, coalesced the same way
+    void residentRuns(std::vector<Run>& runs, size_t maxRuns) const;
+
+    static uint32_t countTrailingZeros(uint32_t bits) {
+        uint32_t n = 0;
+        while (!(bits & 1u)) {
+            bits >>= 1;
+            n++;
+        }
+        return n;
+    }
+
+private:
+    static void coalesce(const std::vector<size_t>& blocks, std::vector<Run>& runs, size_t maxRuns);
+
+    uint32_t* words_ = nullptr;
+    uint32_t* summary_ = nullptr;
+    size_t wordCount_ = 0;
+    size_t summaryCount_ = 0;
+    size_t count_ = 0;
+    std::vector<uint32_t> dirty_;  // One bit per block
+};
+
+} // namespace hip_demand
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "DemandLoading/DemandTextureLoader.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace hip_demand {
+
+// Missing, unreadable or invalid sources fail the same way on every attempt
+inline bool isPermanentFailure(LoaderError error) {
+    return error == LoaderError::FileNotFound || error == LoaderError::ImageLoadFailed ||
+           error == LoaderError::InvalidParameter;
+}
+
+// Frames to wait after the failureCount-th consecutive transient failure:
+// baseFrames doubled per earlier failure, capped at maxFrames (both at least 1)
+inline uint64_t retryBackoffFrames(uint32_t failureCount, uint32_t baseFrames, uint32_t maxFrames) {
+    uint32_t shift = std::min<uint32_t>(failureCount > 0 ? failureCount - 1 : 0, 31);
+    return std::min<uint64_t>(static_cast<uint64_t>(std::max(baseFrames, 1u)) << shift, std::max(maxFrames, 1u));
+}
+
+} // namespace hip_demand
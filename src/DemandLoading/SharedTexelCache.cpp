@@ -0,0 +1,452 @@
+#include "SharedTexelCache.h"
+#include "DemandLoading/Logging.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HIP_DEMAND_POSIX_SHM 1
+#endif
+
+namespace hip_demand {
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared index words must be lock-free to work across processes");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared index words must be lock-free to work across processes");
+
+namespace {
+
+constexpr uint64_t kSegmentMagic = 0x63786574706968ull;  // "hiptexc"
+constexpr uint32_t kSegmentVersion = 2;
+constexpr uint32_t kSegmentReady = 0x59444552u;        // "REDY"
+constexpr size_t kMinSegmentBytes = 16ull << 20;
+constexpr size_t kBytesPerSlot = 64 << 10;              // Index sized for images of ~64 KB on average
+constexpr uint32_t kMinSlots = 1024;
+constexpr uint32_t kMaxSlots = 1u << 20;
+constexpr uint32_t kMaxProbes = 64;
+constexpr int kMaxAttempts = 16;
+constexpr int kOpenWaitMillis = 5000;                   // For another process to finish creating the segment
+constexpr uint64_t kAlignment = 64;
+constexpr uint64_t kClaimBit = 1ull << 63;
+
+// Ahead of every image in the ring
+struct ImageHeader {
+    uint64_t hash;
+    uint64_t check;
+    uint32_t width;
+    uint32_t height;
+    uint64_t reserved;
+};
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Shared by all processes on the node (CLOCK_MONOTONIC on Linux); wraps every ~49 days
+uint32_t nowMillis() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+}
+
+uint32_t currentPid() {
+#if defined(HIP_DEMAND_POSIX_SHM)
+    return static_cast<uint32_t>(::getpid()) & 0x7fffffffu;
+#else
+    return 0;
+#endif
+}
+
+bool isClaim(uint64_t ref) { return (ref & kClaimBit) != 0; }
+
+} // namespace
+
+struct SharedTexelCache::SegmentHeader {
+    uint64_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> ready;
+    uint64_t segmentBytes;
+    uint64_t ringOffset;
+    uint64_t ringBytes;
+    uint32_t slotCount;  // Power of two
+    std::atomic<uint32_t> attached;  // Processes mapping the segment; a crashed one is never subtracted
+    alignas(64) std::atomic<uint64_t> head;  // Ring position after the newest reservation; only grows
+};
+
+// ref: 0 = nothing, claim bit | pid << 32 | claim millis, or ring position + 1 of the image
+struct SharedTexelCache::Slot {
+    std::atomic<uint64_t> hash;
+    std::atomic<uint64_t> ref;
+};
+
+std::unique_ptr<SharedTexelCache> SharedTexelCache::open(const std::string& name, size_t segmentBytes, uint32_t claimTimeoutMs,
+                                                         bool removeWhenUnused) {
+#if defined(HIP_DEMAND_POSIX_SHM)
+    std::string shmName = (!name.empty() && name[0] == '/') ? name : "/" + name;
+    int fd = ::shm_open(shmName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+    bool creator = fd >= 0;
+    if (!creator) {
+        if (errno == EEXIST) {
+            fd = ::shm_open(shmName.c_str(), O_RDWR, 0);
+        }
+        if (fd < 0) {
+            logMessage(LogLevel::Warn, "SharedTexelCache: shm_open(%s) failed: %s", shmName.c_str(), std::strerror(errno));
+            return nullptr;
+        }
+    }
+
+    size_t bytes = 0;
+    if (creator) {
+        bytes = std::max(segmentBytes, kMinSegmentBytes);
+        int err = (::ftruncate(fd, static_cast<off_t>(bytes)) == 0) ? 0 : errno;
+#if defined(__linux__)
+        // Back every page now: touching a page tmpfs cannot supply later raises SIGBUS
+        if (err == 0) err = ::posix_fallocate(fd, 0, static_cast<off_t>(bytes));
+#endif
+        if (err != 0) {
+            logMessage(LogLevel::Warn, "SharedTexelCache: cannot size %s to %zu bytes: %s", shmName.c_str(), bytes, std::strerror(err));
+            ::close(fd);
+            ::shm_unlink(shmName.c_str());
+            return nullptr;
+        }
+    } else {
+        // The creator may not have sized it yet
+        for (int waited = 0; waited < kOpenWaitMillis && bytes == 0; ++waited) {
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                bytes = static_cast<size_t>(st.st_size);
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        if (bytes < kMinSegmentBytes) {
+            logMessage(LogLevel::Warn, "SharedTexelCache: %s exists but is not a cache segment (%zu bytes)", shmName.c_str(), bytes);
+            ::close(fd);
+            return nullptr;
+        }
+    }
+
+    void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        logMessage(LogLevel::Warn, "SharedTexelCache: mmap of %s failed: %s", shmName.c_str(), std::strerror(errno));
+        if (creator) ::shm_unlink(shmName.c_str());
+        return nullptr;
+    }
+
+    SegmentHeader* header = static_cast<SegmentHeader*>(base);
+    if (creator) {
+        // The pages are zero: every slot starts empty
+        uint32_t slots = kMinSlots;
+        while (slots < kMaxSlots && static_cast<size_t>(slots) * kBytesPerSlot < bytes) {
+            slots <<= 1;
+        }
+        header->magic = kSegmentMagic;
+        header->version = kSegmentVersion;
+        header->segmentBytes = bytes;
+        header->slotCount = slots;
+        header->ringOffset = alignUp(alignUp(sizeof(SegmentHeader), kAlignment) + static_cast<uint64_t>(slots) * sizeof(Slot), kAlignment);
+        header->ringBytes = (bytes - header->ringOffset) / kAlignment * kAlignment;
+        header->head.store(0, std::memory_order_relaxed);
+        header->attached.store(1, std::memory_order_relaxed);
+        header->ready.store(kSegmentReady, std::memory_order_release);
+    } else {
+        for (int waited = 0; waited < kOpenWaitMillis && header->ready.load(std::memory_order_acquire) != kSegmentReady; ++waited) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (header->ready.load(std::memory_order_acquire) != kSegmentReady || header->magic != kSegmentMagic ||
+            header->version != kSegmentVersion || header->segmentBytes != bytes) {
+            logMessage(LogLevel::Warn, "SharedTexelCache: %s is not a compatible cache segment; remove it to recreate", shmName.c_str());
+            ::munmap(base, bytes);
+            return nullptr;
+        }
+        header->attached.fetch_add(1, std::memory_order_relaxed);
+    }
+    logMessage(LogLevel::Info, "SharedTexelCache: %s %s, %.1f MB ring, %u slots", creator ? "created" : "attached to",
+               shmName.c_str(), static_cast<double>(header->ringBytes) / (1024.0 * 1024.0), header->slotCount);
+    return std::unique_ptr<SharedTexelCache>(new SharedTexelCache(base, bytes, claimTimeoutMs, shmName, removeWhenUnused));
+#else
+    (void)name;
+    (void)segmentBytes;
+    (void)claimTimeoutMs;
+    (void)removeWhenUnused;
+    logMessage(LogLevel::Warn, "SharedTexelCache: needs POSIX shared memory; not available on this platform");
+    return nullptr;
+#endif
+}
+
+SharedTexelCache::SharedTexelCache(void* base, size_t mappedBytes, uint32_t claimTimeoutMs, const std::string& shmName,
+                                   bool removeWhenUnused)
+    : header_(static_cast<SegmentHeader*>(base)),
+      mappedBytes_(mappedBytes),
+      claimTimeoutMs_(claimTimeoutMs),
+      shmName_(shmName),
+      removeWhenUnused_(removeWhenUnused) {
+    uint8_t* bytes = static_cast<uint8_t*>(base);
+    slots_ = reinterpret_cast<Slot*>(bytes + alignUp(sizeof(SegmentHeader), kAlignment));
+    ring_ = bytes + header_->ringOffset;
+}
+
+SharedTexelCache::~SharedTexelCache() {
+#if defined(HIP_DEMAND_POSIX_SHM)
+    // By default the segment outlives the process, so the next loader on the node finds
+    // it warm. A process that attaches between the last detach and the unlink keeps a
+    // private copy; the next one creates a fresh segment.
+    bool last = header_->attached.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    ::munmap(header_, mappedBytes_);
+    if (last && removeWhenUnused_) {
+        ::shm_unlink(shmName_.c_str());
+        logMessage(LogLevel::Info, "SharedTexelCache: removed %s, no process uses it", shmName_.c_str());
+    }
+#endif
+}
+
+bool SharedTexelCache::makeKey(const std::string& path, const std::string& reader, unsigned int level, SharedTexelKey& key) {
+#if defined(HIP_DEMAND_POSIX_SHM)
+    struct stat st;
+    std::string entry;
+    if (::stat(path.c_str(), &st) != 0) {
+        size_t hash = path.rfind('#');
+        if (hash == std::string::npos || ::stat(path.substr(0, hash).c_str(), &st) != 0) {
+            return false;
+        }
+        entry = path.substr(hash + 1);
+    }
+#if defined(__APPLE__)
+    int64_t mtimeNanos = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    int64_t mtimeNanos = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    uint64_t fields[5] = {static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino),
+                          static_cast<uint64_t>(st.st_size), static_cast<uint64_t>(mtimeNanos), level};
+    std::string identity(reinterpret_cast<const char*>(fields), sizeof(fields));
+    identity += reader;
+    identity.push_back('\0');
+    identity += entry;
+    key.hash = fnv1a(identity.data(), identity.size(), 0xcbf29ce484222325ull);
+    key.check = fnv1a(identity.data(), identity.size(), 0x84222325cbf29ce4ull);
+    if (key.hash == 0) key.hash = 1;  // 0 marks an empty slot
+    return true;
+#else
+    (void)path;
+    (void)reader;
+    (void)level;
+    (void)key;
+    return false;
+#endif
+}
+
+uint8_t* SharedTexelCache::ringAt(uint64_t position) const {
+    return ring_ + position % header_->ringBytes;
+}
+
+// An image at position is intact until a reservation reaches a full ring past it
+bool SharedTexelCache::live(uint64_t position) const {
+    return header_->head.load(std::memory_order_acquire) <= position + header_->ringBytes;
+}
+
+bool SharedTexelCache::claimExpired(uint64_t ref) const {
+    uint32_t claimedAt = static_cast<uint32_t>(ref);
+    if (nowMillis() - claimedAt > claimTimeoutMs_) return true;
+#if defined(HIP_DEMAND_POSIX_SHM)
+    pid_t pid = static_cast<pid_t>((ref >> 32) & 0x7fffffffu);
+    if (static_cast<uint32_t>(pid) != currentPid() && ::kill(pid, 0) != 0 && errno == ESRCH) {
+        return true;  // The decoding process died
+    }
+#endif
+    return false;
+}
+
+// Free for another key: never used, given up, claimed by a process that is gone, or overwritten
+bool SharedTexelCache::stale(uint64_t ref) const {
+    if (ref == 0) return true;
+    if (isClaim(ref)) return claimExpired(ref);
+    return !live(ref - 1);
+}
+
+SharedTexelCache::ReadResult SharedTexelCache::readImage(uint64_t ref, const SharedTexelKey& key, std::unique_ptr<uint8_t[]>& pixels,
+                                                         int& width, int& height) const {
+    uint64_t position = ref - 1;
+    ImageHeader image;
+    std::memcpy(&image, ringAt(position), sizeof(image));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!live(position)) return ReadResult::Lapped;
+    if (image.hash != key.hash) return ReadResult::Replaced;
+    if (image.check != key.check) return ReadResult::Collision;
+    uint64_t bytes = static_cast<uint64_t>(image.width) * image.height * 4;
+    if (image.width == 0 || image.height == 0 || position % header_->ringBytes + sizeof(image) + bytes > header_->ringBytes) {
+        return ReadResult::Collision;
+    }
+    std::unique_ptr<uint8_t[]> copy(new uint8_t[bytes]);
+    std::memcpy(copy.get(), ringAt(position) + sizeof(image), bytes);
+    // A writer reserves before it writes, so an unchanged verdict means the copy is whole
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!live(position)) return ReadResult::Lapped;
+    pixels = std::move(copy);
+    width = static_cast<int>(image.width);
+    height = static_cast<int>(image.height);
+    return ReadResult::Ok;
+}
+
+bool SharedTexelCache::tryClaim(uint32_t slot, uint64_t expected, const SharedTexelKey& key, SharedTexelClaim& claim) {
+    uint64_t word = kClaimBit | (static_cast<uint64_t>(currentPid()) << 32) | nowMillis();
+    if (!slots_[slot].ref.compare_exchange_strong(expected, word, std::memory_order_acq_rel)) {
+        return false;
+    }
+    // Seen with the claim in place, so a reader of the new hash never finds the old image
+    slots_[slot].hash.store(key.hash, std::memory_order_release);
+    claim.slot = slot;
+    claim.word = word;
+    claim.key = key;
+    return true;
+}
+
+void SharedTexelCache::waitForClaim(uint32_t slot, uint64_t hash, uint64_t ref) {
+    const Slot& s = slots_[slot];
+    while (s.hash.load(std::memory_order_acquire) == hash && s.ref.load(std::memory_order_acquire) == ref &&
+           !claimExpired(ref)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool SharedTexelCache::contains(const SharedTexelKey& key) const {
+    const uint32_t mask = header_->slotCount - 1;
+    uint32_t slot = static_cast<uint32_t>(key.hash) & mask;
+    for (uint32_t probe = 0; probe < kMaxProbes; ++probe, slot = (slot + 1) & mask) {
+        uint64_t hash = slots_[slot].hash.load(std::memory_order_acquire);
+        uint64_t ref = slots_[slot].ref.load(std::memory_order_acquire);
+        if (hash == key.hash && !stale(ref)) return true;
+        if (hash == 0 && ref == 0) return false;
+    }
+    return false;
+}
+
+SharedTexelResult SharedTexelCache::acquire(const SharedTexelKey& key, std::unique_ptr<uint8_t[]>& pixels,
+                                            int& width, int& height, SharedTexelClaim& claim) {
+    const uint32_t mask = header_->slotCount - 1;
+    bool waited = false;
+    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+        // Probe to the key or the first never-used slot; a new claim takes the first stale slot on the way
+        uint32_t candidate = UINT32_MAX;
+        uint64_t candidateRef = 0;
+        bool restart = false;
+        uint32_t slot = static_cast<uint32_t>(key.hash) & mask;
+        for (uint32_t probe = 0; probe < kMaxProbes && !restart; ++probe, slot = (slot + 1) & mask) {
+            const Slot& s = slots_[slot];
+            uint64_t hash = s.hash.load(std::memory_order_acquire);
+            uint64_t ref = s.ref.load(std::memory_order_acquire);
+            if (hash == 0 && ref != 0 && !stale(ref)) {
+                // Claimed a moment ago; the hash follows the claim
+                for (int spin = 0; spin < 1000 && hash == 0; ++spin) {
+                    std::this_thread::yield();
+                    hash = s.hash.load(std::memory_order_acquire);
+                }
+                ref = s.ref.load(std::memory_order_acquire);
+            }
+            if (hash == key.hash) {
+                if (isClaim(ref) && !claimExpired(ref)) {
+                    waited = true;
+                    waitForClaim(slot, key.hash, ref);
+                    restart = true;
+                    continue;
+                }
+                if (ref != 0 && !isClaim(ref)) {
+                    ReadResult result = readImage(ref, key, pixels, width, height);
+                    if (result == ReadResult::Ok) {
+                        hits_.fetch_add(1, std::memory_order_relaxed);
+                        if (waited) waits_.fetch_add(1, std::memory_order_relaxed);
+                        return SharedTexelResult::Hit;
+                    }
+                    if (result == ReadResult::Collision) continue;  // Another key with the same hash
+                    if (result == ReadResult::Replaced) {
+                        restart = true;
+                        continue;
+                    }
+                }
+                if (!tryClaim(slot, ref, key, claim)) {
+                    restart = true;
+                    continue;
+                }
+                if (waited) waits_.fetch_add(1, std::memory_order_relaxed);
+                return SharedTexelResult::Claimed;
+            }
+            if (hash == 0 && ref == 0) {
+                bool reuse = candidate != UINT32_MAX;
+                if (!tryClaim(reuse ? candidate : slot, reuse ? candidateRef : 0, key, claim)) {
+                    restart = true;
+                    continue;
+                }
+                if (waited) waits_.fetch_add(1, std::memory_order_relaxed);
+                return SharedTexelResult::Claimed;
+            }
+            if (candidate == UINT32_MAX && stale(ref)) {
+                candidate = slot;
+                candidateRef = ref;
+            }
+        }
+        if (restart) continue;
+        if (candidate == UINT32_MAX) break;  // Every slot on the probe path holds a live image
+        if (tryClaim(candidate, candidateRef, key, claim)) {
+            if (waited) waits_.fetch_add(1, std::memory_order_relaxed);
+            return SharedTexelResult::Claimed;
+        }
+    }
+    bypasses_.fetch_add(1, std::memory_order_relaxed);
+    return SharedTexelResult::Uncached;
+}
+
+void SharedTexelCache::publish(SharedTexelClaim& claim, const uint8_t* pixels, int width, int height) {
+    if (!claim.held()) return;
+    uint64_t bytes = static_cast<uint64_t>(width) * height * 4;
+    uint64_t length = alignUp(sizeof(ImageHeader) + bytes, kAlignment);
+    const uint64_t ringBytes = header_->ringBytes;
+    if (width <= 0 || height <= 0 || length > ringBytes / 4) {
+        // One image would push out a large share of the cache
+        abandon(claim);
+        bypasses_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Reserve [position, position + length); an image never wraps, so skip the ring's tail if needed
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    uint64_t position;
+    do {
+        uint64_t offset = head % ringBytes;
+        position = (offset + length > ringBytes) ? head + (ringBytes - offset) : head;
+    } while (!header_->head.compare_exchange_weak(head, position + length, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+    ImageHeader image = {claim.key.hash, claim.key.check, static_cast<uint32_t>(width), static_cast<uint32_t>(height), 0};
+    uint8_t* dst = ringAt(position);
+    std::memcpy(dst, &image, sizeof(image));
+    std::memcpy(dst + sizeof(image), pixels, bytes);
+
+    // Fails if the claim expired and another process took the slot; the image is then unreachable
+    uint64_t expected = claim.word;
+    if (slots_[claim.slot].ref.compare_exchange_strong(expected, position + 1, std::memory_order_release, std::memory_order_relaxed)) {
+        publishes_.fetch_add(1, std::memory_order_relaxed);
+    }
+    claim = SharedTexelClaim();
+}
+
+void SharedTexelCache::abandon(SharedTexelClaim& claim) {
+    if (!claim.held()) return;
+    uint64_t expected = claim.word;
+    slots_[claim.slot].ref.compare_exchange_strong(expected, 0, std::memory_order_release, std::memory_order_relaxed);
+    claim = SharedTexelClaim();
+}
+
+} // namespace hip_demand
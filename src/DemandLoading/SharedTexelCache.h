@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace hip_demand {
+
+// Identity of one decoded image: the file (device, inode, size, modification time,
+// pack entry), the reader that decoded it and the mip level the load started at.
+// hash picks the index slot; check guards against hash collisions.
+struct SharedTexelKey {
+    uint64_t hash = 0;
+    uint64_t check = 0;
+};
+
+// A decode this process promised to publish (see SharedTexelCache::acquire)
+struct SharedTexelClaim {
+    uint32_t slot = UINT32_MAX;  // UINT32_MAX = nothing claimed
+    uint64_t word = 0;
+    SharedTexelKey key;
+    bool held() const { return slot != UINT32_MAX; }
+};
+
+enum class SharedTexelResult {
+    Hit,      // The image was copied out of the cache
+    Claimed,  // Not cached; the caller decodes it and calls publish() or abandon()
+    Uncached  // Not cached and no slot to claim; decode without publishing
+};
+
+// Decoded RGBA8 images shared by the loaders of every process on a node, in one
+// POSIX shared memory segment. A fixed open-addressed index maps keys to images in
+// a ring that new images overwrite oldest first. Each index slot is two words, the
+// key hash and a reference that is either an image's ring position or a claim (pid
+// and time) by the process decoding it; every transition is a single CAS, so no
+// process ever holds a lock another one waits on. Readers copy an image out and
+// then check that the ring has not lapped it. A claim whose process died or that
+// is older than claimTimeoutMs is taken over.
+class SharedTexelCache {
+public:
+    // Open the segment, creating it with segmentBytes if no process has yet. Later
+    // processes use the existing segment whatever its size. Null (and a warning) if
+    // shared memory is unavailable or the segment is not a compatible cache. With
+    // removeWhenUnused the segment is unlinked when this process detaches last;
+    // otherwise it persists until removed by hand.
+    static std::unique_ptr<SharedTexelCache> open(const std::string& name, size_t segmentBytes, uint32_t claimTimeoutMs,
+                                                  bool removeWhenUnused = false);
+
+    ~SharedTexelCache();
+
+    SharedTexelCache(const SharedTexelCache&) = delete;
+    SharedTexelCache& operator=(const SharedTexelCache&) = delete;
+
+    // False if the file cannot be stat'ed. Pack entries ("pack#entry") use the pack file.
+    static bool makeKey(const std::string& path, const std::string& reader, unsigned int level, SharedTexelKey& key);
+
+    // Cached or being decoded right now; a hint, the image may be overwritten any time
+    bool contains(const SharedTexelKey& key) const;
+
+    // Copy key's image into pixels (width * height RGBA8 texels) on a hit. While another
+    // process holds the claim on the key this waits for it to publish or give up.
+    SharedTexelResult acquire(const SharedTexelKey& key, std::unique_ptr<uint8_t[]>& pixels,
+                              int& width, int& height, SharedTexelClaim& claim);
+    void publish(SharedTexelClaim& claim, const uint8_t* pixels, int width, int height);
+    void abandon(SharedTexelClaim& claim);
+
+    size_t segmentBytes() const { return mappedBytes_; }
+
+    // This process's traffic
+    uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+    uint64_t publishes() const { return publishes_.load(std::memory_order_relaxed); }
+    uint64_t waits() const { return waits_.load(std::memory_order_relaxed); }
+    uint64_t bypasses() const { return bypasses_.load(std::memory_order_relaxed); }
+
+private:
+    struct SegmentHeader;
+    struct Slot;
+    enum class ReadResult { Ok, Lapped, Replaced, Collision };
+
+    SharedTexelCache(void* base, size_t mappedBytes, uint32_t claimTimeoutMs, const std::string& shmName,
+                     bool removeWhenUnused);
+
+    bool stale(uint64_t ref) const;
+    bool claimExpired(uint64_t ref) const;
+    bool live(uint64_t position) const;
+    ReadResult readImage(uint64_t ref, const SharedTexelKey& key, std::unique_ptr<uint8_t[]>& pixels,
+                         int& width, int& height) const;
+    bool tryClaim(uint32_t slot, uint64_t expected, const SharedTexelKey& key, SharedTexelClaim& claim);
+    void waitForClaim(uint32_t slot, uint64_t hash, uint64_t ref);
+    uint8_t* ringAt(uint64_t position) const;
+
+    SegmentHeader* header_ = nullptr;
+    Slot* slots_ = nullptr;
+    uint8_t* ring_ = nullptr;
+    size_t mappedBytes_ = 0;
+    uint32_t claimTimeoutMs_ = 0;
+    std::string shmName_;
+    bool removeWhenUnused_ = false;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> publishes_{0};
+    std::atomic<uint64_t> waits_{0};
+    std::atomic<uint64_t> bypasses_{0};
+};
+
+} // namespace hip_demand
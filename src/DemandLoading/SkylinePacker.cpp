@@ -0,0 +1,94 @@
+#include "SkylinePacker.h"
+
+#include <algorithm>
+
+namespace hip_demand {
+
+static uint32_t alignUp(uint32_t value, uint32_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void SkylinePacker::reset(uint32_t width, uint32_t height, uint32_t alignment) {
+    alignment_ = std::max(alignment, 1u);
+    width_ = width / alignment_ * alignment_;
+    height_ = height / alignment_ * alignment_;
+    skyline_.assign(1, Segment{0, 0, width_});
+    usedWidth_ = 0;
+    usedHeight_ = 0;
+    placedArea_ = 0;
+}
+
+uint32_t SkylinePacker::fitAt(size_t i, uint32_t width) const {
+    if (skyline_[i].x + width > width_) return UINT32_MAX;
+    uint32_t y = 0;
+    uint32_t remaining = width;
+    for (size_t j = i; remaining > 0; ++j) {
+        // Segments cover [0, width_) contiguously, so this stays in range
+        y = std::max(y, skyline_[j].y);
+        remaining -= std::min(remaining, skyline_[j].width);
+    }
+    return y;
+}
+
+bool SkylinePacker::insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y) {
+    width = alignUp(std::max(width, 1u), alignment_);
+    height = alignUp(std::max(height, 1u), alignment_);
+    if (width > width_ || height > height_) return false;
+
+    size_t best = skyline_.size();
+    uint32_t bestBottom = UINT32_MAX;
+    uint32_t bestWaste = UINT32_MAX;
+    for (size_t i = 0; i < skyline_.size(); ++i) {
+        uint32_t top = fitAt(i, width);
+        if (top == UINT32_MAX || top + height > height_) continue;
+        // Area trapped under the rectangle between it and the skyline
+        uint32_t waste = 0;
+        uint32_t remaining = width;
+        for (size_t j = i; remaining > 0; ++j) {
+            uint32_t span = std::min(remaining, skyline_[j].width);
+            waste += (top - skyline_[j].y) * span;
+            remaining -= span;
+        }
+        if (top + height < bestBottom || (top + height == bestBottom && waste < bestWaste)) {
+            best = i;
+            bestBottom = top + height;
+            bestWaste = waste;
+        }
+    }
+    if (best == skyline_.size()) return false;
+
+    x = skyline_[best].x;
+    y = bestBottom - height;
+
+    // The new segment replaces whatever it covers
+    Segment placed{x, bestBottom, width};
+    size_t end = best;
+    uint32_t right = x + width;
+    while (end < skyline_.size() && skyline_[end].x + skyline_[end].width <= right) {
+        ++end;
+    }
+    if (end < skyline_.size() && skyline_[end].x < right) {
+        uint32_t cut = right - skyline_[end].x;
+        skyline_[end].x = right;
+        skyline_[end].width -= cut;
+    }
+    skyline_.erase(skyline_.begin() + best, skyline_.begin() + end);
+    skyline_.insert(skyline_.begin() + best, placed);
+
+    // Merge neighbours of equal height
+    for (size_t i = 0; i + 1 < skyline_.size();) {
+        if (skyline_[i].y == skyline_[i + 1].y) {
+            skyline_[i].width += skyline_[i + 1].width;
+            skyline_.erase(skyline_.begin() + i + 1);
+        } else {
+            ++i;
+        }
+    }
+
+    usedWidth_ = std::max(usedWidth_, right);
+    usedHeight_ = std::max(usedHeight_, bestBottom);
+    placedArea_ += static_cast<uint64_t>(width) * height;
+    return true;
+}
+
+} // namespace hip_demand
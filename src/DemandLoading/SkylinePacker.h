@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hip_demand {
+
+// Online rectangle packer for atlas pages. The skyline is the upper outline of
+// everything placed so far, kept as horizontal segments; each rectangle goes
+// where its bottom edge ends lowest (ties: least width left over), which is
+// the bottom-left rule. Positions and sizes are rounded up to the alignment so
+// rectangles stay on texel boundaries in the page's coarser mip levels.
+class SkylinePacker {
+public:
+    void reset(uint32_t width, uint32_t height, uint32_t alignment);
+
+    // Place a width x height rectangle; false if it does not fit
+    bool insert(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y);
+
+    uint32_t width() const { return width_; }
+    uint32_t height() const { return height_; }
+
+    // Bounding box of everything placed so far
+    uint32_t usedWidth() const { return usedWidth_; }
+    uint32_t usedHeight() const { return usedHeight_; }
+
+    uint64_t placedArea() const { return placedArea_; }  // Sum of the aligned rectangle areas
+
+private:
+    struct Segment {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+    };
+
+    // Lowest y at which a rectangle of the given width can start at segment i, or UINT32_MAX
+    uint32_t fitAt(size_t i, uint32_t width) const;
+
+    std::vector<Segment> skyline_;
+    uint32_t width_ = 0;
+    uint32_t height_ = 0;
+    uint32_t alignment_ = 1;
+    uint32_t usedWidth_ = 0;
+    uint32_t usedHeight_ = 0;
+    uint64_t placedArea_ = 0;
+};
+
+} // namespace hip_demand
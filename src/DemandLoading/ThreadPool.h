@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hip_demand {
+
+// Fixed-size worker pool used by the loader for texture loads and background work.
+class ThreadPool {
+public:
+    // numThreads == 0 picks std::thread::hardware_concurrency().
+    explicit ThreadPool(unsigned int numThreads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int size() const { return static_cast<unsigned int>(workers_.size()); }
+
+    // Queue a task; it runs on some worker thread.
+    void submit(std::function<void()> task);
+
+    // Run fn(i) for every i in [0, count) on the workers and the calling thread.
+    // Returns once all indices are done. Safe to call from a worker thread.
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+};
+
+} // namespace hip_demand
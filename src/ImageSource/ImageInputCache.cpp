@@ -0,0 +1,267 @@
+#include "ImageInputCache.h"
+#include "DemandLoading/Logging.h"
+
+namespace hip_demand {
+
+// ---------------------------------------------------------------------------
+// Handle
+
+ImageInputCache::Handle::Handle(Handle&& other) noexcept
+    : cache_(other.cache_)
+    , filename_(std::move(other.filename_))
+    , input_(std::move(other.input_))
+    , spec_(std::move(other.spec_))
+{
+    other.cache_ = nullptr;
+}
+
+ImageInputCache::Handle& ImageInputCache::Handle::operator=(Handle&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        cache_ = other.cache_;
+        filename_ = std::move(other.filename_);
+        input_ = std::move(other.input_);
+        spec_ = std::move(other.spec_);
+        other.cache_ = nullptr;
+    }
+    return *this;
+}
+
+ImageInputCache::Handle::~Handle()
+{
+    release();
+}
+
+void ImageInputCache::Handle::release()
+{
+    if (cache_ && input_)
+        cache_->release(filename_, std::move(input_), false);
+    cache_ = nullptr;
+}
+
+void ImageInputCache::Handle::discard()
+{
+    if (cache_ && input_)
+        cache_->release(filename_, std::move(input_), true);
+    cache_ = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// ImageInputCache
+
+ImageInputCache& ImageInputCache::instance()
+{
+    // Intentionally leaked: handles may be returned during static destruction.
+    static ImageInputCache* cache = new ImageInputCache();
+    return *cache;
+}
+
+ImageInputCache::ImageInputCache(size_t maxOpenHandles)
+    : maxOpenHandles_(maxOpenHandles > 0 ? maxOpenHandles : 1)
+{
+}
+
+ImageInputCache::~ImageInputCache()
+{
+    clear();
+}
+
+ImageInputCache::Handle ImageInputCache::acquire(const std::string& filename, std::string* error)
+{
+    Handle handle;
+    handle.filename_ = filename;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(filename);
+        if (it != entries_.end() && !it->second.idle.empty())
+        {
+            Entry& entry = it->second;
+            handle.input_ = std::move(entry.idle.back());
+            entry.idle.pop_back();
+            entry.checkedOut++;
+            handle.spec_ = entry.spec;
+            handle.cache_ = this;
+            touchLocked(entry);
+            hits_++;
+            return handle;
+        }
+        misses_++;
+    }
+
+    // Open outside the lock; this is the slow path that parses the header.
+    std::unique_ptr<OIIO::ImageInput> input = OIIO::ImageInput::open(filename);
+    if (!input)
+    {
+        if (error) *error = "Failed to open image: " + filename;
+        return handle;
+    }
+
+    std::vector<std::unique_ptr<OIIO::ImageInput>> toClose;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [it, inserted] = entries_.try_emplace(filename);
+        Entry& entry = it->second;
+        if (inserted)
+        {
+            lru_.push_front(filename);
+            entry.lruPos = lru_.begin();
+            entry.spec = input->spec();
+        }
+        else
+        {
+            touchLocked(entry);
+        }
+        entry.checkedOut++;
+        openHandles_++;
+        handle.spec_ = entry.spec;
+        evictLocked(toClose);
+    }
+
+    handle.input_ = std::move(input);
+    handle.cache_ = this;
+    return handle;
+}
+
+void ImageInputCache::release(const std::string& filename, std::unique_ptr<OIIO::ImageInput> input, bool discard)
+{
+    std::vector<std::unique_ptr<OIIO::ImageInput>> toClose;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(filename);
+        if (it == entries_.end())
+        {
+            // Entry was dropped by clear(); just close the handle.
+            openHandles_--;
+            toClose.push_back(std::move(input));
+        }
+        else
+        {
+            Entry& entry = it->second;
+            entry.checkedOut--;
+            if (discard || openHandles_ > maxOpenHandles_)
+            {
+                openHandles_--;
+                toClose.push_back(std::move(input));
+                eraseIfUnusedLocked(it);
+            }
+            else
+            {
+                entry.idle.push_back(std::move(input));
+                touchLocked(entry);
+            }
+        }
+    }
+    // toClose destroyed here, outside the lock
+}
+
+void ImageInputCache::touchLocked(Entry& entry)
+{
+    lru_.splice(lru_.begin(), lru_, entry.lruPos);
+}
+
+void ImageInputCache::eraseIfUnusedLocked(std::unordered_map<std::string, Entry>::iterator it)
+{
+    if (it->second.checkedOut == 0 && it->second.idle.empty())
+    {
+        lru_.erase(it->second.lruPos);
+        entries_.erase(it);
+    }
+}
+
+void ImageInputCache::evictLocked(std::vector<std::unique_ptr<OIIO::ImageInput>>& toClose)
+{
+    auto pos = lru_.end();
+    while (openHandles_ > maxOpenHandles_ && pos != lru_.begin())
+    {
+        --pos;
+        auto it = entries_.find(*pos);
+        Entry& entry = it->second;
+        while (!entry.idle.empty() && openHandles_ > maxOpenHandles_)
+        {
+            toClose.push_back(std::move(entry.idle.back()));
+            entry.idle.pop_back();
+            openHandles_--;
+            evictions_++;
+        }
+        if (entry.checkedOut == 0 && entry.idle.empty())
+        {
+            // Erasing invalidates pos; step past it first.
+            auto next = std::next(pos);
+            lru_.erase(pos);
+            entries_.erase(it);
+            pos = next;
+        }
+    }
+    if (!toClose.empty())
+        logMessage(LogLevel::Debug, "ImageInputCache: closed %zu idle handles (open=%zu cap=%zu)",
+                   toClose.size(), openHandles_, maxOpenHandles_);
+}
+
+void ImageInputCache::setMaxOpenHandles(size_t maxOpenHandles)
+{
+    std::vector<std::unique_ptr<OIIO::ImageInput>> toClose;
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxOpenHandles_ = maxOpenHandles > 0 ? maxOpenHandles : 1;
+    evictLocked(toClose);
+}
+
+size_t ImageInputCache::getMaxOpenHandles() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxOpenHandles_;
+}
+
+void ImageInputCache::invalidate(const std::string& filename)
+{
+    std::vector<std::unique_ptr<OIIO::ImageInput>> toClose;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(filename);
+    if (it == entries_.end()) return;
+
+    Entry& entry = it->second;
+    openHandles_ -= entry.idle.size();
+    for (auto& input : entry.idle)
+        toClose.push_back(std::move(input));
+    entry.idle.clear();
+    eraseIfUnusedLocked(it);
+}
+
+void ImageInputCache::clear()
+{
+    std::vector<std::unique_ptr<OIIO::ImageInput>> toClose;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+        Entry& entry = it->second;
+        openHandles_ -= entry.idle.size();
+        for (auto& input : entry.idle)
+            toClose.push_back(std::move(input));
+        entry.idle.clear();
+        if (entry.checkedOut == 0)
+        {
+            lru_.erase(entry.lruPos);
+            it = entries_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+ImageInputCache::Stats ImageInputCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.openHandles = openHandles_;
+    stats.cachedFiles = entries_.size();
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    return stats;
+}
+
+}  // namespace hip_demand
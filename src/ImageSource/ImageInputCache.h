@@ -0,0 +1,117 @@
+#pragma once
+
+/// \file ImageInputCache.h
+/// Process-wide LRU cache of open OpenImageIO ImageInput handles (internal)
+
+#include <OpenImageIO/imageio.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace hip_demand {
+
+/// Keeps ImageInput handles open between reads so headers are parsed once per
+/// file and repeated level/tile reads skip the open. Each file can have several
+/// handles so concurrent reads of the same file do not serialize on one
+/// ImageInput. The total number of open handles is capped; idle handles of the
+/// least recently used files are closed first.
+class ImageInputCache
+{
+  public:
+    /// Exclusive use of one open ImageInput; returned to the cache on destruction.
+    class Handle
+    {
+      public:
+        Handle() = default;
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(Handle&& other) noexcept;
+        ~Handle();
+
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+
+        explicit operator bool() const { return input_ != nullptr; }
+        OIIO::ImageInput* operator->() const { return input_.get(); }
+        OIIO::ImageInput* get() const { return input_.get(); }
+
+        /// Header of subimage 0, miplevel 0 as parsed when the file was first opened.
+        const OIIO::ImageSpec& spec() const { return spec_; }
+
+        /// Close the handle instead of returning it to the cache (e.g. after a read error).
+        void discard();
+
+      private:
+        friend class ImageInputCache;
+
+        ImageInputCache* cache_ = nullptr;
+        std::string filename_;
+        std::unique_ptr<OIIO::ImageInput> input_;
+        OIIO::ImageSpec spec_;
+
+        void release();
+    };
+
+    struct Stats
+    {
+        size_t openHandles = 0;
+        size_t cachedFiles = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    /// The process-wide cache used by OIIOReader.
+    static ImageInputCache& instance();
+
+    explicit ImageInputCache(size_t maxOpenHandles = 256);
+    ~ImageInputCache();
+
+    ImageInputCache(const ImageInputCache&) = delete;
+    ImageInputCache& operator=(const ImageInputCache&) = delete;
+
+    /// Check out an open handle for the file. Reuses an idle handle when one is
+    /// available, otherwise opens a new one. Returns an empty handle on failure.
+    Handle acquire(const std::string& filename, std::string* error = nullptr);
+
+    /// Cap on open handles across all files. A checked-out handle is never
+    /// closed, so the cap can be exceeded briefly while many reads are in flight.
+    void setMaxOpenHandles(size_t maxOpenHandles);
+    size_t getMaxOpenHandles() const;
+
+    /// Close all idle handles of a file (e.g. after it changed on disk).
+    void invalidate(const std::string& filename);
+
+    /// Close all idle handles.
+    void clear();
+
+    Stats getStats() const;
+
+  private:
+    struct Entry
+    {
+        OIIO::ImageSpec spec;
+        std::vector<std::unique_ptr<OIIO::ImageInput>> idle;
+        size_t checkedOut = 0;
+        std::list<std::string>::iterator lruPos;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> lru_;  // front = most recently used
+    size_t maxOpenHandles_;
+    size_t openHandles_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t evictions_ = 0;
+
+    void release(const std::string& filename, std::unique_ptr<OIIO::ImageInput> input, bool discard);
+    void touchLocked(Entry& entry);
+    void eraseIfUnusedLocked(std::unordered_map<std::string, Entry>::iterator it);
+    void evictLocked(std::vector<std::unique_ptr<OIIO::ImageInput>>& toClose);
+};
+
+}  // namespace hip_demand
@@ -0,0 +1,88 @@
+#include "ImageSource/ImageSource.h"
+#include "ImageSource/TextureInfo.h"
+#include <cstring>
+#include <vector>
+
+namespace hip_demand {
+
+bool isValidRegion(const TextureInfo& info, unsigned int mipLevel,
+                   unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+    if (!info.isValid || mipLevel >= info.numMipLevels || width == 0 || height == 0)
+        return false;
+
+    unsigned long long levelWidth = getMipLevelDimension(info.width, mipLevel);
+    unsigned long long levelHeight = getMipLevelDimension(info.height, mipLevel);
+    return static_cast<unsigned long long>(x) + width <= levelWidth &&
+           static_cast<unsigned long long>(y) + height <= levelHeight;
+}
+
+void copyImageRows(const char* src, size_t srcRowPitch,
+                   char* dest, size_t destRowPitch,
+                   size_t rowBytes, unsigned int rows)
+{
+    if (srcRowPitch == rowBytes && destRowPitch == rowBytes)
+    {
+        std::memcpy(dest, src, rowBytes * rows);
+        return;
+    }
+    for (unsigned int row = 0; row < rows; ++row)
+        std::memcpy(dest + row * destRowPitch, src + row * srcRowPitch, rowBytes);
+}
+
+void downsampleImageBox(const unsigned char* src, unsigned int srcWidth, unsigned int srcHeight,
+                        unsigned char* dest, unsigned int destWidth, unsigned int destHeight,
+                        unsigned int numChannels)
+{
+    for (unsigned int y = 0; y < destHeight; ++y)
+    {
+        for (unsigned int x = 0; x < destWidth; ++x)
+        {
+            unsigned int sx = x * 2;
+            unsigned int sy = y * 2;
+
+            for (unsigned int c = 0; c < numChannels; ++c)
+            {
+                unsigned int sum = 0;
+                unsigned int count = 0;
+
+                for (unsigned int dy = 0; dy < 2 && (sy + dy) < srcHeight; ++dy)
+                {
+                    for (unsigned int dx = 0; dx < 2 && (sx + dx) < srcWidth; ++dx)
+                    {
+                        sum += src[(static_cast<size_t>(sy + dy) * srcWidth + (sx + dx)) * numChannels + c];
+                        count++;
+                    }
+                }
+
+                dest[(static_cast<size_t>(y) * destWidth + x) * numChannels + c] = static_cast<unsigned char>(sum / count);
+            }
+        }
+    }
+}
+
+bool ImageSource::readRegion(unsigned int mipLevel,
+                             unsigned int x, unsigned int y,
+                             unsigned int width, unsigned int height,
+                             char* dest, size_t rowPitch)
+{
+    const TextureInfo& info = getInfo();
+    if (!isOpen() || !isValidRegion(info, mipLevel, x, y, width, height))
+        return false;
+
+    unsigned int levelWidth = getMipLevelDimension(info.width, mipLevel);
+    unsigned int levelHeight = getMipLevelDimension(info.height, mipLevel);
+    size_t pixelBytes = info.numChannels;
+    size_t levelPitch = levelWidth * pixelBytes;
+
+    std::vector<char> level(levelPitch * levelHeight);
+    if (!readMipLevel(level.data(), mipLevel, levelWidth, levelHeight))
+        return false;
+
+    size_t rowBytes = width * pixelBytes;
+    copyImageRows(level.data() + y * levelPitch + x * pixelBytes, levelPitch,
+                  dest, rowPitch ? rowPitch : rowBytes, rowBytes, height);
+    return true;
+}
+
+}  // namespace hip_demand
@@ -0,0 +1,306 @@
+#include "ImageSource/ImageSourceRegistry.h"
+#include "ImageSource/PackImageSource.h"
+#include "ImageSource/StbReader.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <mutex>
+
+#ifdef USE_OIIO
+#include "ImageSource/OIIOReader.h"
+#endif
+
+namespace hip_demand {
+
+namespace {
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<ImageSourceReaderDesc> readers;  // sorted by descending priority
+};
+
+void insertSorted(std::vector<ImageSourceReaderDesc>& readers, const ImageSourceReaderDesc& desc)
+{
+    readers.erase(std::remove_if(readers.begin(), readers.end(),
+                                 [&](const ImageSourceReaderDesc& r) { return r.name == desc.name; }),
+                  readers.end());
+    auto pos = std::find_if(readers.begin(), readers.end(),
+                            [&](const ImageSourceReaderDesc& r) { return r.priority < desc.priority; });
+    readers.insert(pos, desc);
+}
+
+void registerBuiltinReaders(std::vector<ImageSourceReaderDesc>& readers)
+{
+    // stb_image is always available as the baseline decoder.
+    ImageSourceReaderDesc stb;
+    stb.name = "stb";
+    stb.extensions = {"png", "jpg", "jpeg", "bmp", "tga", "gif", "psd", "hdr", "pic", "pnm", "ppm", "pgm"};
+    stb.signatures = {
+        std::string("\x89PNG", 4),
+        std::string("\xFF\xD8\xFF", 3),
+        std::string("BM", 2),
+        std::string("GIF8", 4),
+        std::string("8BPS", 4),
+        std::string("#?RADIANCE", 10),
+        std::string("#?RGBE", 6),
+        std::string("\x53\x80\xF6\x34", 4),
+        std::string("P5", 2),
+        std::string("P6", 2),
+    };
+    stb.priority = 0;
+    stb.decodesFromMemory = true;
+    stb.factory = [](const std::string& filename) { return std::make_unique<StbReader>(filename); };
+    insertSorted(readers, stb);
+
+    // Entries of a texture pack, named "pack#entry"; the signature is the pack header.
+    ImageSourceReaderDesc pack;
+    pack.name = "pack";
+    pack.extensions = {"hdpack"};
+    pack.signatures = {std::string("HDTPACK\0", 8)};
+    pack.priority = 0;
+    pack.factory = [](const std::string& filename) { return std::make_unique<PackImageSource>(filename); };
+    insertSorted(readers, pack);
+
+#ifdef USE_OIIO
+    // OIIO handles everything stb does plus HDR/production formats, so prefer it.
+    ImageSourceReaderDesc oiio;
+    oiio.name = "oiio";
+    oiio.extensions = {"*"};
+    oiio.signatures = {
+        std::string("\x89PNG", 4),
+        std::string("\xFF\xD8\xFF", 3),
+        std::string("BM", 2),
+        std::string("GIF8", 4),
+        std::string("8BPS", 4),
+        std::string("#?RADIANCE", 10),
+        std::string("#?RGBE", 6),
+        std::string("\x76\x2F\x31\x01", 4),  // OpenEXR
+        std::string("II*\0", 4),             // TIFF little-endian
+        std::string("MM\0*", 4),             // TIFF big-endian
+        std::string("SDPX", 4),
+        std::string("XPDS", 4),
+    };
+    oiio.priority = 10;
+    oiio.factory = [](const std::string& filename) { return std::make_unique<OIIOReader>(filename); };
+    insertSorted(readers, oiio);
+#endif
+}
+
+Registry& registry()
+{
+    static Registry* instance = [] {
+        auto* r = new Registry();
+        registerBuiltinReaders(r->readers);
+        return r;
+    }();
+    return *instance;
+}
+
+std::string lowerExtension(const std::string& filename)
+{
+    size_t dot = filename.find_last_of('.');
+    size_t slash = filename.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return std::string();
+
+    std::string ext = filename.substr(dot + 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext;
+}
+
+std::string readFileHeader(std::ifstream& file, size_t maxBytes)
+{
+    std::string header;
+    if (maxBytes == 0) return header;
+
+    header.resize(maxBytes);
+    file.read(&header[0], static_cast<std::streamsize>(maxBytes));
+    header.resize(static_cast<size_t>(file.gcount()));
+    return header;
+}
+
+bool matchesSignature(const ImageSourceReaderDesc& desc, const std::string& header)
+{
+    for (const std::string& sig : desc.signatures)
+    {
+        if (!sig.empty() && header.size() >= sig.size() && header.compare(0, sig.size(), sig) == 0)
+            return true;
+    }
+    return false;
+}
+
+std::vector<std::string> rankReaders(const std::string& filename, const std::string& header,
+                                     std::string* detectedBy)
+{
+    const std::string ext = lowerExtension(filename);
+
+    Registry& r = registry();
+    std::vector<ImageSourceReaderDesc> readers;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        readers = r.readers;
+    }
+
+    const bool formatKnown = std::any_of(readers.begin(), readers.end(),
+                                         [&](const ImageSourceReaderDesc& d) { return matchesSignature(d, header); });
+
+    std::vector<std::string> bySignature;
+    std::vector<std::string> byExtension;
+    std::vector<std::string> byWildcard;
+    for (const auto& desc : readers)
+    {
+        if (matchesSignature(desc, header))
+        {
+            bySignature.push_back(desc.name);
+            continue;
+        }
+
+        // A reader that declares signatures cannot decode a header identified as another format.
+        if (formatKnown && !desc.signatures.empty())
+            continue;
+
+        bool extMatch = false;
+        bool wildcard = false;
+        for (const auto& e : desc.extensions)
+        {
+            if (e == "*") wildcard = true;
+            else if (!ext.empty() && e == ext) extMatch = true;
+        }
+
+        if (extMatch)
+            byExtension.push_back(desc.name);
+        else if (wildcard)
+            byWildcard.push_back(desc.name);
+    }
+
+    if (detectedBy)
+        *detectedBy = bySignature.empty() ? std::string() : bySignature.front();
+
+    std::vector<std::string> result;
+    result.insert(result.end(), bySignature.begin(), bySignature.end());
+    result.insert(result.end(), byExtension.begin(), byExtension.end());
+    result.insert(result.end(), byWildcard.begin(), byWildcard.end());
+    return result;
+}
+
+}  // namespace
+
+void registerImageSource(const ImageSourceReaderDesc& desc)
+{
+    if (desc.name.empty() || !desc.factory) return;
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    insertSorted(r.readers, desc);
+}
+
+bool unregisterImageSource(const std::string& name)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto it = std::remove_if(r.readers.begin(), r.readers.end(),
+                             [&](const ImageSourceReaderDesc& d) { return d.name == name; });
+    if (it == r.readers.end()) return false;
+    r.readers.erase(it, r.readers.end());
+    return true;
+}
+
+std::vector<std::string> getRegisteredImageSources()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<std::string> names;
+    for (const auto& desc : r.readers)
+        names.push_back(desc.name);
+    return names;
+}
+
+ImageSourceSniff sniffImageSource(const std::string& filename)
+{
+    size_t maxSignature = 0;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& desc : r.readers)
+            for (const auto& sig : desc.signatures)
+                maxSignature = std::max(maxSignature, sig.size());
+    }
+
+    ImageSourceSniff sniff;
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        // "pack#entry" is sniffed as the pack file it names
+        std::string packPath;
+        std::string entryName;
+        if (TexturePack::splitEntryPath(filename, packPath, entryName))
+        {
+            ImageSourceSniff packSniff = sniffImageSource(packPath);
+            if (packSniff.detectedBy == "pack")
+                return packSniff;
+        }
+        return sniff;
+    }
+
+    sniff.readable = true;
+    sniff.header = readFileHeader(file, maxSignature);
+    file.close();
+
+    sniff.readers = rankReaders(filename, sniff.header, &sniff.detectedBy);
+    return sniff;
+}
+
+std::vector<std::string> findImageSources(const std::string& filename, const std::string& header)
+{
+    return rankReaders(filename, header, nullptr);
+}
+
+std::vector<std::string> findImageSources(const std::string& filename)
+{
+    return sniffImageSource(filename).readers;
+}
+
+bool imageSourceDecodesFromMemory(const std::string& readerName)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& desc : r.readers)
+    {
+        if (desc.name == readerName)
+            return desc.decodesFromMemory;
+    }
+    return false;
+}
+
+std::unique_ptr<ImageSource> createImageSource(const std::string& filename,
+                                               const std::string& readerName)
+{
+    ImageSourceFactory factory;
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (const auto& desc : r.readers)
+        {
+            if (desc.name == readerName)
+            {
+                factory = desc.factory;
+                break;
+            }
+        }
+    }
+    return factory ? factory(filename) : nullptr;
+}
+
+std::unique_ptr<ImageSource> createImageSource(const std::string& filename)
+{
+    for (const std::string& name : findImageSources(filename))
+    {
+        if (auto source = createImageSource(filename, name))
+            return source;
+    }
+    return nullptr;
+}
+
+}  // namespace hip_demand
@@ -1,11 +1,46 @@
 #include "ImageSource/OIIOReader.h"
+#include "ImageInputCache.h"
 #include <OpenImageIO/imageio.h>
 #include <algorithm>
 #include <chrono>
 #include <cstring>
+#include <stdexcept>
 
 namespace hip_demand {
 
+namespace {
+
+// Box-filter a rectangle of one level down to the next level. The source
+// rectangle starts at twice the destination origin and is clipped to its
+// level, so the result matches generateMipLevel for the covered pixels.
+void downsampleRegion(const unsigned char* src, unsigned int srcWidth, unsigned int srcHeight,
+                      unsigned char* dst, unsigned int dstWidth, unsigned int dstHeight,
+                      unsigned int channels)
+{
+    for (unsigned int y = 0; y < dstHeight; ++y)
+    {
+        for (unsigned int x = 0; x < dstWidth; ++x)
+        {
+            for (unsigned int c = 0; c < channels; ++c)
+            {
+                unsigned int sum = 0;
+                unsigned int count = 0;
+                for (unsigned int dy = 0; dy < 2 && (2 * y + dy) < srcHeight; ++dy)
+                {
+                    for (unsigned int dx = 0; dx < 2 && (2 * x + dx) < srcWidth; ++dx)
+                    {
+                        sum += src[((2 * y + dy) * srcWidth + (2 * x + dx)) * channels + c];
+                        count++;
+                    }
+                }
+                dst[(y * dstWidth + x) * channels + c] = static_cast<unsigned char>(sum / count);
+            }
+        }
+    }
+}
+
+}  // namespace
+
 OIIOReader::OIIOReader(const std::string& filename)
     : filename_(filename)
 {
@@ -18,71 +53,100 @@ OIIOReader::~OIIOReader()
 
 void OIIOReader::open(TextureInfo* info)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (isOpen_)
     {
-        if (info) *info = info_;
-        return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (isOpen_)
+        {
+            if (info) *info = info_;
+            return;
+        }
     }
-    
+
     auto start = std::chrono::high_resolution_clock::now();
-    
-    // Open image with OIIO
-    auto inp = OIIO::ImageInput::open(filename_);
+
+    // Borrow an open ImageInput; the header is parsed only on a cache miss
+    std::string error;
+    ImageInputCache::Handle inp = ImageInputCache::instance().acquire(filename_, &error);
     if (!inp)
     {
-        throw std::runtime_error("Failed to open image: " + filename_);
+        throw std::runtime_error(error);
     }
-    
-    const OIIO::ImageSpec& spec = inp->spec();
-    
-    // Fill texture info
-    info_.width = spec.width;
-    info_.height = spec.height;
-    info_.numChannels = spec.nchannels;
-    info_.numMipLevels = calculateNumMipLevels(spec.width, spec.height);
-    info_.isValid = true;
-    info_.isTiled = false;
-    
+
+    const OIIO::ImageSpec& spec = inp.spec();
+
+    TextureInfo newInfo;
+    newInfo.width = spec.width;
+    newInfo.height = spec.height;
+    newInfo.numChannels = spec.nchannels;
+    newInfo.numMipLevels = calculateNumMipLevels(spec.width, spec.height);
+    newInfo.isValid = true;
+    newInfo.isTiled = spec.tile_width > 0;
+
     // Determine format
     switch (spec.format.basetype)
     {
         case OIIO::TypeDesc::UINT8:
-            info_.format = PixelFormat::UINT8;
+            newInfo.format = PixelFormat::UINT8;
             break;
         case OIIO::TypeDesc::UINT16:
-            info_.format = PixelFormat::UINT16;
+            newInfo.format = PixelFormat::UINT16;
             break;
         case OIIO::TypeDesc::HALF:
-            info_.format = PixelFormat::FLOAT16;
+            newInfo.format = PixelFormat::FLOAT16;
             break;
         case OIIO::TypeDesc::FLOAT:
-            info_.format = PixelFormat::FLOAT32;
+            newInfo.format = PixelFormat::FLOAT32;
             break;
         default:
             // Default to UINT8 and let OIIO convert
-            info_.format = PixelFormat::UINT8;
+            newInfo.format = PixelFormat::UINT8;
             break;
     }
-    
-    inp->close();
-    
-    isOpen_ = true;
-    
-    if (info) *info = info_;
-    
+
+    // Count mip levels stored in the file so they can be read directly
+    unsigned int stored = 1;
+    while (stored < newInfo.numMipLevels && inp->seek_subimage(0, static_cast<int>(stored)))
+        stored++;
+    inp->seek_subimage(0, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!isOpen_)
+        {
+            info_ = newInfo;
+            storedMipLevels_ = stored;
+            isOpen_ = true;
+        }
+        if (info) *info = info_;
+    }
+
     auto end = std::chrono::high_resolution_clock::now();
-    totalReadTime_ += std::chrono::duration<double>(end - start).count();
+    addStats(0, std::chrono::duration<double>(end - start).count());
+}
+
+void OIIOReader::openWithInfo(const TextureInfo& cachedInfo)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (isOpen_) return;
+    if (!cachedInfo.isValid)
+    {
+        throw std::runtime_error("Invalid cached info for image: " + filename_);
+    }
+
+    // Trust the header from registration; the first read borrows a handle from the cache.
+    info_ = cachedInfo;
+    storedMipLevels_ = 0;
+    isOpen_ = true;
 }
 
 void OIIOReader::close()
 {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+
     if (!isOpen_) return;
-    
-    mipLevels_.clear();
+
+    mipChain_.reset();
     isOpen_ = false;
 }
 
@@ -97,57 +161,93 @@ const TextureInfo& OIIOReader::getInfo() const
     return info_;
 }
 
-bool OIIOReader::loadImage()
+bool OIIOReader::readStoredLevel(char* dest, unsigned int mipLevel, unsigned int width, unsigned int height,
+                                 unsigned int numChannels)
 {
-    if (!isOpen_) return false;
-    
     auto start = std::chrono::high_resolution_clock::now();
-    
-    // Open image
-    auto inp = OIIO::ImageInput::open(filename_);
+
+    ImageInputCache::Handle inp = ImageInputCache::instance().acquire(filename_);
     if (!inp) return false;
-    
-    const OIIO::ImageSpec& spec = inp->spec();
-    
-    // Read base level (level 0)
-    size_t baseSize = spec.width * spec.height * info_.numChannels;
-    std::vector<unsigned char> baseLevel(baseSize);
-    
-    // Read and convert to UINT8 RGBA
-    bool success = inp->read_image(0, 0, 0, spec.nchannels, OIIO::TypeDesc::UINT8, baseLevel.data());
-    inp->close();
-    
-    if (!success) return false;
-    
-    bytesRead_ += baseSize;
-    
-    // Store base level
-    mipLevels_.resize(info_.numMipLevels);
-    mipLevels_[0] = std::move(baseLevel);
-    
+
+    OIIO::ImageSpec levelSpec = inp->spec(0, static_cast<int>(mipLevel));
+    if (levelSpec.width != static_cast<int>(width) || levelSpec.height != static_cast<int>(height))
+        return false;
+
+    int channels = static_cast<int>(numChannels);
+    bool success = inp->read_image(0, static_cast<int>(mipLevel), 0, channels, OIIO::TypeDesc::UINT8, dest);
+    if (!success)
+    {
+        inp.discard();
+        return false;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    addStats(static_cast<unsigned long long>(width) * height * channels,
+             std::chrono::duration<double>(end - start).count());
+    return true;
+}
+
+std::shared_ptr<const OIIOReader::MipChain> OIIOReader::getMipChain()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (mipChain_) return mipChain_;
+    }
+
+    // Only one thread generates; the others wait here and pick up its result.
+    std::lock_guard<std::mutex> generateLock(generateMutex_);
+    TextureInfo info;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (mipChain_) return mipChain_;
+        if (!isOpen_) return nullptr;
+        info = info_;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    ImageInputCache::Handle inp = ImageInputCache::instance().acquire(filename_);
+    if (!inp) return nullptr;
+
+    const OIIO::ImageSpec& spec = inp.spec();
+    if (static_cast<unsigned int>(spec.width) != info.width || static_cast<unsigned int>(spec.height) != info.height)
+        return nullptr;
+
+    auto chain = std::make_shared<MipChain>(info.numMipLevels);
+
+    // Read and convert base level (level 0) to UINT8
+    size_t baseSize = static_cast<size_t>(spec.width) * spec.height * info.numChannels;
+    (*chain)[0].resize(baseSize);
+    bool success = inp->read_image(0, 0, 0, static_cast<int>(info.numChannels), OIIO::TypeDesc::UINT8, (*chain)[0].data());
+    if (!success)
+    {
+        inp.discard();
+        return nullptr;
+    }
+
     // Generate remaining mip levels
     int width = spec.width;
     int height = spec.height;
-    
-    for (unsigned int level = 1; level < info_.numMipLevels; ++level)
+    for (unsigned int level = 1; level < info.numMipLevels; ++level)
     {
         int prevWidth = width;
         int prevHeight = height;
         width = std::max(1, width / 2);
         height = std::max(1, height / 2);
-        
-        size_t levelSize = width * height * info_.numChannels;
-        mipLevels_[level].resize(levelSize);
-        
-        generateMipLevel(mipLevels_[level - 1].data(), prevWidth, prevHeight,
-                        mipLevels_[level].data(), width, height,
-                        info_.numChannels);
+
+        (*chain)[level].resize(static_cast<size_t>(width) * height * info.numChannels);
+        generateMipLevel((*chain)[level - 1].data(), prevWidth, prevHeight,
+                         (*chain)[level].data(), width, height,
+                         static_cast<int>(info.numChannels));
     }
-    
+
     auto end = std::chrono::high_resolution_clock::now();
-    totalReadTime_ += std::chrono::duration<double>(end - start).count();
-    
-    return true;
+    addStats(baseSize, std::chrono::duration<double>(end - start).count());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!isOpen_) return nullptr;
+    mipChain_ = chain;
+    return mipChain_;
 }
 
 void OIIOReader::generateMipLevel(const unsigned char* srcData, int srcWidth, int srcHeight,
@@ -161,12 +261,12 @@ void OIIOReader::generateMipLevel(const unsigned char* srcData, int srcWidth, in
         {
             int sx = x * 2;
             int sy = y * 2;
-            
+
             for (int c = 0; c < channels; ++c)
             {
                 int sum = 0;
                 int count = 0;
-                
+
                 for (int dy = 0; dy < 2 && (sy + dy) < srcHeight; ++dy)
                 {
                     for (int dx = 0; dx < 2 && (sx + dx) < srcWidth; ++dx)
@@ -175,7 +275,7 @@ void OIIOReader::generateMipLevel(const unsigned char* srcData, int srcWidth, in
                         count++;
                     }
                 }
-                
+
                 dstData[(y * dstWidth + x) * channels + c] = sum / count;
             }
         }
@@ -188,76 +288,247 @@ bool OIIOReader::readMipLevel(char* dest,
                               unsigned int expectedHeight,
                               hipStream_t stream)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (!isOpen_ || mipLevel >= info_.numMipLevels)
+    unsigned int stored = 0;
+    unsigned int channels = 0;
+    std::shared_ptr<const MipChain> chain;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!isOpen_ || mipLevel >= info_.numMipLevels)
+            return false;
+
+        // Verify dimensions
+        unsigned int w = std::max(1u, info_.width >> mipLevel);
+        unsigned int h = std::max(1u, info_.height >> mipLevel);
+        if (w != expectedWidth || h != expectedHeight)
+            return false;
+
+        chain = mipChain_;
+        stored = storedMipLevels_;
+        channels = info_.numChannels;
+    }
+
+    // Level 0 and levels stored in the file are read directly, without building a chain
+    if (!chain && (mipLevel == 0 || mipLevel < stored))
+    {
+        if (readStoredLevel(dest, mipLevel, expectedWidth, expectedHeight, channels))
+            return true;
+    }
+
+    if (!chain) chain = getMipChain();
+    if (!chain) return false;
+
+    const auto& level = (*chain)[mipLevel];
+    std::memcpy(dest, level.data(), level.size());
+    return true;
+}
+
+bool OIIOReader::readStoredRegion(unsigned int mipLevel, unsigned int x, unsigned int y,
+                                  unsigned int width, unsigned int height,
+                                  char* dest, size_t rowPitch, unsigned int numChannels)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+
+    ImageInputCache::Handle inp = ImageInputCache::instance().acquire(filename_);
+    if (!inp) return false;
+
+    const int level = static_cast<int>(mipLevel);
+    const int channels = static_cast<int>(numChannels);
+    OIIO::ImageSpec spec = inp->spec(0, level);
+    if (static_cast<unsigned long long>(x) + width > static_cast<unsigned long long>(spec.width) ||
+        static_cast<unsigned long long>(y) + height > static_cast<unsigned long long>(spec.height))
+        return false;
+
+    const size_t pixelBytes = numChannels;
+    const size_t rowBytes = width * pixelBytes;
+    if (rowPitch == 0) rowPitch = rowBytes;
+
+    // OIIO coordinates are relative to the data window origin
+    const int xbegin = spec.x + static_cast<int>(x);
+    const int ybegin = spec.y + static_cast<int>(y);
+    const int yend = ybegin + static_cast<int>(height);
+
+    bool success = false;
+    unsigned long long bytes = 0;
+
+    if (spec.tile_width > 0 && spec.tile_height > 0)
+    {
+        // Expand to tile boundaries (or the image edge) and read just those tiles
+        const int tw = spec.tile_width;
+        const int th = spec.tile_height;
+        const int txbegin = spec.x + (static_cast<int>(x) / tw) * tw;
+        const int tybegin = spec.y + (static_cast<int>(y) / th) * th;
+        const int txend = std::min(spec.x + ((static_cast<int>(x + width) + tw - 1) / tw) * tw, spec.x + spec.width);
+        const int tyend = std::min(spec.y + ((static_cast<int>(y + height) + th - 1) / th) * th, spec.y + spec.height);
+
+        const size_t tilePitch = static_cast<size_t>(txend - txbegin) * pixelBytes;
+        std::vector<char> tiles(tilePitch * (tyend - tybegin));
+        success = inp->read_tiles(0, level, txbegin, txend, tybegin, tyend, spec.z, spec.z + 1,
+                                  0, channels, OIIO::TypeDesc::UINT8, tiles.data());
+        if (success)
+        {
+            const char* src = tiles.data() + (ybegin - tybegin) * tilePitch + (xbegin - txbegin) * pixelBytes;
+            copyImageRows(src, tilePitch, dest, rowPitch, rowBytes, height);
+            bytes = tiles.size();
+        }
+    }
+    else if (x == 0 && width == static_cast<unsigned int>(spec.width))
+    {
+        // Full-width band: read the scanlines straight into dest
+        success = inp->read_scanlines(0, level, ybegin, yend, spec.z, 0, channels, OIIO::TypeDesc::UINT8, dest,
+                                      static_cast<OIIO::stride_t>(pixelBytes), static_cast<OIIO::stride_t>(rowPitch));
+        bytes = static_cast<unsigned long long>(rowBytes) * height;
+    }
+    else
+    {
+        // Read only the covering scanlines, then crop horizontally
+        const size_t linePitch = static_cast<size_t>(spec.width) * pixelBytes;
+        std::vector<char> lines(linePitch * height);
+        success = inp->read_scanlines(0, level, ybegin, yend, spec.z, 0, channels, OIIO::TypeDesc::UINT8, lines.data());
+        if (success)
+        {
+            copyImageRows(lines.data() + x * pixelBytes, linePitch, dest, rowPitch, rowBytes, height);
+            bytes = lines.size();
+        }
+    }
+
+    if (!success)
+    {
+        inp.discard();
         return false;
-    
-    // Load image if not already loaded
-    if (mipLevels_.empty())
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    addStats(bytes, std::chrono::duration<double>(end - start).count());
+    return true;
+}
+
+bool OIIOReader::readRegion(unsigned int mipLevel,
+                            unsigned int x, unsigned int y,
+                            unsigned int width, unsigned int height,
+                            char* dest, size_t rowPitch)
+{
+    TextureInfo info;
+    unsigned int stored = 0;
+    std::shared_ptr<const MipChain> chain;
     {
-        if (!loadImage())
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!isOpen_ || !isValidRegion(info_, mipLevel, x, y, width, height))
             return false;
+        info = info_;
+        stored = storedMipLevels_;
+        chain = mipChain_;
+    }
+
+    const size_t pixelBytes = info.numChannels;
+    const size_t rowBytes = width * pixelBytes;
+    if (rowPitch == 0) rowPitch = rowBytes;
+
+    // A chain generated earlier already holds every level in memory
+    if (chain)
+    {
+        const size_t levelPitch = getMipLevelDimension(info.width, mipLevel) * pixelBytes;
+        const char* src = reinterpret_cast<const char*>((*chain)[mipLevel].data()) + y * levelPitch + x * pixelBytes;
+        copyImageRows(src, levelPitch, dest, rowPitch, rowBytes, height);
+        return true;
     }
-    
-    // Verify dimensions
-    unsigned int w = info_.width >> mipLevel;
-    unsigned int h = info_.height >> mipLevel;
-    w = std::max(1u, w);
-    h = std::max(1u, h);
-    
-    if (w != expectedWidth || h != expectedHeight)
+
+    if (mipLevel == 0 || mipLevel < stored)
+        return readStoredRegion(mipLevel, x, y, width, height, dest, rowPitch, info.numChannels);
+
+    // Level not stored in the file: read the level-0 rectangle that covers the
+    // requested one and box-filter it down, so I/O still scales with the region.
+    unsigned int rx = x << mipLevel;
+    unsigned int ry = y << mipLevel;
+    unsigned int rw = static_cast<unsigned int>(std::min<unsigned long long>(
+        static_cast<unsigned long long>(x + width) << mipLevel, info.width) - rx);
+    unsigned int rh = static_cast<unsigned int>(std::min<unsigned long long>(
+        static_cast<unsigned long long>(y + height) << mipLevel, info.height) - ry);
+
+    std::vector<unsigned char> current(static_cast<size_t>(rw) * rh * pixelBytes);
+    if (!readStoredRegion(0, rx, ry, rw, rh, reinterpret_cast<char*>(current.data()), 0, info.numChannels))
         return false;
-    
-    // Copy data
-    size_t size = w * h * info_.numChannels;
-    std::memcpy(dest, mipLevels_[mipLevel].data(), size);
-    
+
+    for (unsigned int level = 1; level <= mipLevel; ++level)
+    {
+        unsigned int shift = mipLevel - level;
+        unsigned int lx = x << shift;
+        unsigned int ly = y << shift;
+        unsigned int lw = static_cast<unsigned int>(std::min<unsigned long long>(
+            static_cast<unsigned long long>(x + width) << shift, getMipLevelDimension(info.width, level)) - lx);
+        unsigned int lh = static_cast<unsigned int>(std::min<unsigned long long>(
+            static_cast<unsigned long long>(y + height) << shift, getMipLevelDimension(info.height, level)) - ly);
+
+        std::vector<unsigned char> next(static_cast<size_t>(lw) * lh * pixelBytes);
+        downsampleRegion(current.data(), rw, rh, next.data(), lw, lh, info.numChannels);
+        current = std::move(next);
+        rw = lw;
+        rh = lh;
+    }
+
+    copyImageRows(reinterpret_cast<const char*>(current.data()), rowBytes, dest, rowPitch, rowBytes, height);
     return true;
 }
 
 bool OIIOReader::readBaseColor(float4& dest)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    if (!isOpen_) return false;
-    
-    // Load image if not already loaded
-    if (mipLevels_.empty())
+    std::shared_ptr<const MipChain> chain = getMipChain();
+    if (!chain) return false;
+
+    unsigned int numChannels;
     {
-        if (!loadImage())
-            return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        numChannels = info_.numChannels;
     }
-    
+
     // Get 1x1 mip level (last level)
-    unsigned int lastLevel = info_.numMipLevels - 1;
-    const unsigned char* data = mipLevels_[lastLevel].data();
-    
+    const unsigned char* data = chain->back().data();
+
     // Convert to float4
     dest.x = data[0] / 255.0f;
-    dest.y = (info_.numChannels > 1) ? data[1] / 255.0f : dest.x;
-    dest.z = (info_.numChannels > 2) ? data[2] / 255.0f : dest.x;
-    dest.w = (info_.numChannels > 3) ? data[3] / 255.0f : 1.0f;
-    
+    dest.y = (numChannels > 1) ? data[1] / 255.0f : dest.x;
+    dest.z = (numChannels > 2) ? data[2] / 255.0f : dest.x;
+    dest.w = (numChannels > 3) ? data[3] / 255.0f : 1.0f;
+
     return true;
 }
 
 unsigned long long OIIOReader::getNumBytesRead() const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(statsMutex_);
     return bytesRead_;
 }
 
 double OIIOReader::getTotalReadTime() const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<std::mutex> lock(statsMutex_);
     return totalReadTime_;
 }
 
-// Factory function implementation
-std::unique_ptr<ImageSource> createImageSource(const std::string& filename)
+void OIIOReader::addStats(unsigned long long bytes, double seconds)
+{
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    bytesRead_ += bytes;
+    totalReadTime_ += seconds;
+}
+
+void OIIOReader::setMaxOpenFiles(size_t maxOpenFiles)
+{
+    ImageInputCache::instance().setMaxOpenHandles(maxOpenFiles);
+}
+
+size_t OIIOReader::getMaxOpenFiles()
+{
+    return ImageInputCache::instance().getMaxOpenHandles();
+}
+
+size_t OIIOReader::getOpenFileCount()
+{
+    return ImageInputCache::instance().getStats().openHandles;
+}
+
+void OIIOReader::invalidateFile(const std::string& filename)
 {
-    return std::make_unique<OIIOReader>(filename);
+    ImageInputCache::instance().invalidate(filename);
 }
 
 }  // namespace hip_demand
@@ -0,0 +1,248 @@
+#include "ImageSource/PackImageSource.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+#include "stb_image.h"
+
+namespace hip_demand {
+
+PackImageSource::PackImageSource(const std::string& filename)
+    : filename_(filename)
+{
+}
+
+PackImageSource::~PackImageSource()
+{
+    close();
+}
+
+void PackImageSource::openEntry()
+{
+    std::string packPath;
+    std::string entryName;
+    if (!TexturePack::splitEntryPath(filename_, packPath, entryName))
+    {
+        throw std::runtime_error("Not a texture pack entry: " + filename_);
+    }
+
+    std::string error;
+    std::shared_ptr<TexturePack> pack = TexturePack::openShared(packPath, &error);
+    if (!pack)
+    {
+        throw std::runtime_error(error);
+    }
+    long long index = pack->findEntry(entryName);
+    if (index < 0)
+    {
+        throw std::runtime_error("No entry '" + entryName + "' in texture pack " + packPath);
+    }
+
+    pack_ = std::move(pack);
+    entry_ = &pack_->getEntry(static_cast<size_t>(index));
+    storedLevels_ = (entry_->kind == PackEntryKind::Decoded) ? entry_->numMipLevels : 0;
+}
+
+void PackImageSource::open(TextureInfo* info)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (isOpen_)
+    {
+        if (info) *info = info_;
+        return;
+    }
+
+    openEntry();
+    info_ = TexturePack::getTextureInfo(*entry_);
+    isOpen_ = true;
+
+    if (info) *info = info_;
+}
+
+void PackImageSource::openWithInfo(const TextureInfo& cachedInfo)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (isOpen_) return;
+    if (!cachedInfo.isValid)
+    {
+        throw std::runtime_error("Invalid cached info for image: " + filename_);
+    }
+
+    // The index is in memory already, so this only checks the entry is still there
+    openEntry();
+    info_ = TexturePack::getTextureInfo(*entry_);
+    if (info_.width != cachedInfo.width || info_.height != cachedInfo.height ||
+        info_.numChannels != cachedInfo.numChannels)
+    {
+        pack_.reset();
+        entry_ = nullptr;
+        throw std::runtime_error("Texture pack entry changed: " + filename_);
+    }
+    isOpen_ = true;
+}
+
+void PackImageSource::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!isOpen_) return;
+
+    mipLevels_.clear();
+    entry_ = nullptr;
+    pack_.reset();
+    isOpen_ = false;
+}
+
+bool PackImageSource::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return isOpen_;
+}
+
+const TextureInfo& PackImageSource::getInfo() const
+{
+    return info_;
+}
+
+const unsigned char* PackImageSource::levelData(unsigned int mipLevel)
+{
+    const unsigned char* payload = pack_->getPayload(*entry_);
+    if (mipLevel < storedLevels_)
+    {
+        size_t offset = 0;
+        for (unsigned int level = 0; level < mipLevel; ++level)
+        {
+            offset += static_cast<size_t>(getMipLevelDimension(info_.width, level)) *
+                      getMipLevelDimension(info_.height, level) * info_.numChannels;
+        }
+        return payload + offset;
+    }
+
+    if (storedLevels_ == 0 && mipLevels_.empty())
+    {
+        // Encoded entry: decode the base level from the mapping
+        if (entry_->size > static_cast<uint64_t>(INT_MAX)) return nullptr;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        int w = 0, h = 0, c = 0;
+        unsigned char* pixels = stbi_load_from_memory(payload, static_cast<int>(entry_->size), &w, &h, &c,
+                                                      static_cast<int>(info_.numChannels));
+        if (!pixels) return nullptr;
+        if (static_cast<unsigned int>(w) != info_.width || static_cast<unsigned int>(h) != info_.height)
+        {
+            stbi_image_free(pixels);
+            return nullptr;
+        }
+        size_t baseSize = static_cast<size_t>(w) * h * info_.numChannels;
+        mipLevels_.emplace_back(pixels, pixels + baseSize);
+        stbi_image_free(pixels);
+
+        bytesRead_ += entry_->size;
+        auto end = std::chrono::high_resolution_clock::now();
+        totalReadTime_ += std::chrono::duration<double>(end - start).count();
+    }
+
+    while (storedLevels_ + mipLevels_.size() <= mipLevel)
+    {
+        unsigned int level = storedLevels_ + static_cast<unsigned int>(mipLevels_.size());
+        const unsigned char* prev = levelData(level - 1);
+        if (!prev) return nullptr;
+
+        unsigned int width = getMipLevelDimension(info_.width, level);
+        unsigned int height = getMipLevelDimension(info_.height, level);
+        std::vector<unsigned char> next(static_cast<size_t>(width) * height * info_.numChannels);
+        downsampleImageBox(prev, getMipLevelDimension(info_.width, level - 1),
+                           getMipLevelDimension(info_.height, level - 1),
+                           next.data(), width, height, info_.numChannels);
+        mipLevels_.push_back(std::move(next));
+    }
+    return mipLevels_[mipLevel - storedLevels_].data();
+}
+
+bool PackImageSource::readMipLevel(char* dest,
+                                   unsigned int mipLevel,
+                                   unsigned int expectedWidth,
+                                   unsigned int expectedHeight,
+                                   hipStream_t /*stream*/)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!isOpen_ || mipLevel >= info_.numMipLevels)
+        return false;
+
+    unsigned int w = getMipLevelDimension(info_.width, mipLevel);
+    unsigned int h = getMipLevelDimension(info_.height, mipLevel);
+    if (w != expectedWidth || h != expectedHeight)
+        return false;
+
+    const unsigned char* src = levelData(mipLevel);
+    if (!src)
+        return false;
+
+    size_t size = static_cast<size_t>(w) * h * info_.numChannels;
+    std::memcpy(dest, src, size);
+    if (mipLevel < storedLevels_)
+        bytesRead_ += size;
+    return true;
+}
+
+bool PackImageSource::readRegion(unsigned int mipLevel,
+                                 unsigned int x, unsigned int y,
+                                 unsigned int width, unsigned int height,
+                                 char* dest, size_t rowPitch)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!isOpen_ || !isValidRegion(info_, mipLevel, x, y, width, height))
+        return false;
+
+    const unsigned char* level = levelData(mipLevel);
+    if (!level)
+        return false;
+
+    size_t levelPitch = static_cast<size_t>(getMipLevelDimension(info_.width, mipLevel)) * info_.numChannels;
+    size_t rowBytes = static_cast<size_t>(width) * info_.numChannels;
+    const char* src = reinterpret_cast<const char*>(level) + y * levelPitch + static_cast<size_t>(x) * info_.numChannels;
+    copyImageRows(src, levelPitch, dest, rowPitch ? rowPitch : rowBytes, rowBytes, height);
+    if (mipLevel < storedLevels_)
+        bytesRead_ += rowBytes * height;
+    return true;
+}
+
+bool PackImageSource::readBaseColor(float4& dest)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!isOpen_) return false;
+
+    const unsigned char* data = levelData(info_.numMipLevels - 1);
+    if (!data) return false;
+
+    dest.x = data[0] / 255.0f;
+    dest.y = (info_.numChannels > 2) ? data[1] / 255.0f : dest.x;
+    dest.z = (info_.numChannels > 2) ? data[2] / 255.0f : dest.x;
+    if (info_.numChannels == 2)
+        dest.w = data[1] / 255.0f;
+    else
+        dest.w = (info_.numChannels > 3) ? data[3] / 255.0f : 1.0f;
+
+    return true;
+}
+
+unsigned long long PackImageSource::getNumBytesRead() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytesRead_;
+}
+
+double PackImageSource::getTotalReadTime() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totalReadTime_;
+}
+
+}  // namespace hip_demand
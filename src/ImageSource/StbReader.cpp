@@ -0,0 +1,247 @@
+#include "ImageSource/StbReader.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace hip_demand {
+
+StbReader::StbReader(const std::string& filename)
+    : filename_(filename)
+{
+}
+
+StbReader::~StbReader()
+{
+    close();
+}
+
+void StbReader::open(TextureInfo* info)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (isOpen_)
+    {
+        if (info) *info = info_;
+        return;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    int w = 0, h = 0, c = 0;
+    bool ok = fileData_
+        ? stbi_info_from_memory(reinterpret_cast<const stbi_uc*>(fileData_->data()),
+                                static_cast<int>(fileData_->size()), &w, &h, &c) != 0
+        : stbi_info(filename_.c_str(), &w, &h, &c) != 0;
+    if (!ok)
+    {
+        throw std::runtime_error("Failed to open image: " + filename_);
+    }
+
+    info_.width = w;
+    info_.height = h;
+    info_.numChannels = c;
+    info_.format = PixelFormat::UINT8;
+    info_.numMipLevels = calculateNumMipLevels(w, h);
+    info_.isValid = true;
+    info_.isTiled = false;
+
+    isOpen_ = true;
+
+    if (info) *info = info_;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    totalReadTime_ += std::chrono::duration<double>(end - start).count();
+}
+
+void StbReader::openWithInfo(const TextureInfo& cachedInfo)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (isOpen_) return;
+    if (!cachedInfo.isValid)
+    {
+        throw std::runtime_error("Invalid cached info for image: " + filename_);
+    }
+
+    info_ = cachedInfo;
+    isOpen_ = true;
+}
+
+bool StbReader::setFileData(std::shared_ptr<const std::vector<char>> data)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // stb takes an int length
+    if (!data || data->size() > static_cast<size_t>(INT_MAX)) return false;
+    fileData_ = std::move(data);
+    return true;
+}
+
+void StbReader::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    fileData_.reset();
+    if (!isOpen_) return;
+
+    mipLevels_.clear();
+    isOpen_ = false;
+}
+
+bool StbReader::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return isOpen_;
+}
+
+const TextureInfo& StbReader::getInfo() const
+{
+    return info_;
+}
+
+bool StbReader::loadImage()
+{
+    if (!isOpen_) return false;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    int w = 0, h = 0, c = 0;
+    unsigned char* pixels = nullptr;
+    if (fileData_)
+    {
+        pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(fileData_->data()),
+                                       static_cast<int>(fileData_->size()), &w, &h, &c,
+                                       static_cast<int>(info_.numChannels));
+        fileData_.reset();
+    }
+    else
+    {
+        pixels = stbi_load(filename_.c_str(), &w, &h, &c, static_cast<int>(info_.numChannels));
+    }
+    if (!pixels) return false;
+
+    if (static_cast<unsigned int>(w) != info_.width || static_cast<unsigned int>(h) != info_.height)
+    {
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    size_t baseSize = static_cast<size_t>(w) * h * info_.numChannels;
+    mipLevels_.resize(1);
+    mipLevels_[0].assign(pixels, pixels + baseSize);
+    stbi_image_free(pixels);
+
+    bytesRead_ += baseSize;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    totalReadTime_ += std::chrono::duration<double>(end - start).count();
+
+    return true;
+}
+
+void StbReader::buildMipLevels(unsigned int lastLevel)
+{
+    for (unsigned int level = static_cast<unsigned int>(mipLevels_.size()); level <= lastLevel; ++level)
+    {
+        unsigned int prevWidth = std::max(1u, info_.width >> (level - 1));
+        unsigned int prevHeight = std::max(1u, info_.height >> (level - 1));
+        unsigned int width = std::max(1u, info_.width >> level);
+        unsigned int height = std::max(1u, info_.height >> level);
+
+        std::vector<unsigned char> next(static_cast<size_t>(width) * height * info_.numChannels);
+        downsampleImageBox(mipLevels_[level - 1].data(), prevWidth, prevHeight,
+                           next.data(), width, height, info_.numChannels);
+        mipLevels_.push_back(std::move(next));
+    }
+}
+
+bool StbReader::readMipLevel(char* dest,
+                             unsigned int mipLevel,
+                             unsigned int expectedWidth,
+                             unsigned int expectedHeight,
+                             hipStream_t /*stream*/)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!isOpen_ || mipLevel >= info_.numMipLevels)
+        return false;
+
+    unsigned int w = std::max(1u, info_.width >> mipLevel);
+    unsigned int h = std::max(1u, info_.height >> mipLevel);
+    if (w != expectedWidth || h != expectedHeight)
+        return false;
+
+    if (mipLevels_.empty() && !loadImage())
+        return false;
+
+    buildMipLevels(mipLevel);
+
+    std::memcpy(dest, mipLevels_[mipLevel].data(), mipLevels_[mipLevel].size());
+    return true;
+}
+
+bool StbReader::readRegion(unsigned int mipLevel,
+                           unsigned int x, unsigned int y,
+                           unsigned int width, unsigned int height,
+                           char* dest, size_t rowPitch)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!isOpen_ || !isValidRegion(info_, mipLevel, x, y, width, height))
+        return false;
+
+    if (mipLevels_.empty() && !loadImage())
+        return false;
+
+    buildMipLevels(mipLevel);
+
+    size_t levelPitch = static_cast<size_t>(getMipLevelDimension(info_.width, mipLevel)) * info_.numChannels;
+    size_t rowBytes = static_cast<size_t>(width) * info_.numChannels;
+    const char* src = reinterpret_cast<const char*>(mipLevels_[mipLevel].data()) +
+                      y * levelPitch + static_cast<size_t>(x) * info_.numChannels;
+    copyImageRows(src, levelPitch, dest, rowPitch ? rowPitch : rowBytes, rowBytes, height);
+    return true;
+}
+
+bool StbReader::readBaseColor(float4& dest)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!isOpen_) return false;
+
+    if (mipLevels_.empty() && !loadImage())
+        return false;
+
+    unsigned int lastLevel = info_.numMipLevels - 1;
+    buildMipLevels(lastLevel);
+    const unsigned char* data = mipLevels_[lastLevel].data();
+
+    dest.x = data[0] / 255.0f;
+    dest.y = (info_.numChannels > 2) ? data[1] / 255.0f : dest.x;
+    dest.z = (info_.numChannels > 2) ? data[2] / 255.0f : dest.x;
+    if (info_.numChannels == 2)
+        dest.w = data[1] / 255.0f;
+    else
+        dest.w = (info_.numChannels > 3) ? data[3] / 255.0f : 1.0f;
+
+    return true;
+}
+
+unsigned long long StbReader::getNumBytesRead() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytesRead_;
+}
+
+double StbReader::getTotalReadTime() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totalReadTime_;
+}
+
+}  // namespace hip_demand
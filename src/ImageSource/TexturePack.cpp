@@ -0,0 +1,379 @@
+#include "ImageSource/TexturePack.h"
+#include "ImageSource/ImageSource.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace hip_demand {
+
+namespace {
+
+const char kPackMagic[8] = {'H', 'D', 'T', 'P', 'A', 'C', 'K', '\0'};
+const uint32_t kPackVersion = 1;
+const size_t kHeaderBytes = 8 + 4 + 4 + 8 + 8 + 8;
+const size_t kEntryFixedBytes = 8 + 8 + 4 + 4 + 2 + 2 + 1 + 1 + 2;
+
+// Little-endian field access, independent of host byte order
+uint64_t getLE(const unsigned char* p, int bytes)
+{
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i)
+        value = (value << 8) | p[i];
+    return value;
+}
+
+void putLE(std::string& out, uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+    {
+        out.push_back(static_cast<char>(value & 0xff));
+        value >>= 8;
+    }
+}
+
+uint64_t alignUp(uint64_t value)
+{
+    return (value + kPackAlignment - 1) / kPackAlignment * kPackAlignment;
+}
+
+// Bytes of an 8-bit mip chain
+uint64_t mipChainBytes(unsigned int width, unsigned int height, unsigned int channels, unsigned int levels)
+{
+    uint64_t total = 0;
+    for (unsigned int level = 0; level < levels; ++level)
+    {
+        total += static_cast<uint64_t>(std::max(1u, width >> level)) * std::max(1u, height >> level) * channels;
+    }
+    return total;
+}
+
+void setError(std::string* error, const std::string& message)
+{
+    if (error) *error = message;
+}
+
+}  // namespace
+
+TexturePack::~TexturePack()
+{
+#ifdef _WIN32
+    if (base_) UnmapViewOfFile(base_);
+    if (mapping_) CloseHandle(static_cast<HANDLE>(mapping_));
+#else
+    if (base_) munmap(const_cast<unsigned char*>(base_), static_cast<size_t>(size_));
+#endif
+}
+
+std::shared_ptr<TexturePack> TexturePack::open(const std::string& path, std::string* error)
+{
+    std::shared_ptr<TexturePack> pack(new TexturePack());
+    if (!pack->map(path, error) || !pack->parseIndex(error))
+        return nullptr;
+    return pack;
+}
+
+std::shared_ptr<TexturePack> TexturePack::openShared(const std::string& path, std::string* error)
+{
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::weak_ptr<TexturePack>> packs;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto pack = packs[path].lock())
+        return pack;
+    auto pack = open(path, error);
+    if (pack)
+        packs[path] = pack;
+    else
+        packs.erase(path);
+    return pack;
+}
+
+bool TexturePack::map(const std::string& path, std::string* error)
+{
+    path_ = path;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        setError(error, "Cannot open pack: " + path);
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        setError(error, "Empty or unreadable pack: " + path);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+    {
+        setError(error, "Cannot map pack: " + path);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        setError(error, "Cannot map pack: " + path);
+        return false;
+    }
+    mapping_ = mapping;
+    base_ = static_cast<const unsigned char*>(view);
+    size_ = static_cast<uint64_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        setError(error, "Cannot open pack: " + path);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        ::close(fd);
+        setError(error, "Empty or unreadable pack: " + path);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // The mapping keeps the file alive
+    if (view == MAP_FAILED)
+    {
+        setError(error, "Cannot map pack: " + path);
+        return false;
+    }
+    base_ = static_cast<const unsigned char*>(view);
+    size_ = static_cast<uint64_t>(st.st_size);
+#endif
+    return true;
+}
+
+bool TexturePack::parseIndex(std::string* error)
+{
+    if (size_ < kHeaderBytes || std::memcmp(base_, kPackMagic, sizeof(kPackMagic)) != 0)
+    {
+        setError(error, "Not a texture pack: " + path_);
+        return false;
+    }
+    const unsigned char* h = base_ + sizeof(kPackMagic);
+    uint32_t version = static_cast<uint32_t>(getLE(h, 4));
+    uint32_t count = static_cast<uint32_t>(getLE(h + 4, 4));
+    uint64_t indexOffset = getLE(h + 8, 8);
+    uint64_t indexSize = getLE(h + 16, 8);
+    uint64_t fileSize = getLE(h + 24, 8);
+    if (version != kPackVersion)
+    {
+        setError(error, "Unsupported texture pack version in " + path_);
+        return false;
+    }
+    if (fileSize != size_ || indexOffset > size_ || indexSize > size_ - indexOffset)
+    {
+        setError(error, "Truncated texture pack: " + path_);
+        return false;
+    }
+
+    const unsigned char* p = base_ + indexOffset;
+    const unsigned char* end = p + indexSize;
+    entries_.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (static_cast<size_t>(end - p) < kEntryFixedBytes)
+            break;
+        PackEntry e;
+        e.offset = getLE(p, 8);
+        e.size = getLE(p + 8, 8);
+        e.width = static_cast<unsigned int>(getLE(p + 16, 4));
+        e.height = static_cast<unsigned int>(getLE(p + 20, 4));
+        e.numChannels = static_cast<unsigned int>(getLE(p + 24, 2));
+        e.numMipLevels = static_cast<unsigned int>(getLE(p + 26, 2));
+        e.kind = static_cast<PackEntryKind>(p[28]);
+        size_t nameLength = static_cast<size_t>(getLE(p + 30, 2));
+        p += kEntryFixedBytes;
+        if (static_cast<size_t>(end - p) < nameLength)
+            break;
+        e.name.assign(reinterpret_cast<const char*>(p), nameLength);
+        p += nameLength;
+
+        bool valid = e.offset <= indexOffset && e.size <= indexOffset - e.offset && e.width > 0 && e.height > 0 &&
+                     e.numChannels >= 1 && e.numChannels <= 4 &&
+                     (e.kind == PackEntryKind::Encoded ||
+                      (e.kind == PackEntryKind::Decoded && e.numMipLevels >= 1 &&
+                       e.size >= mipChainBytes(e.width, e.height, e.numChannels, e.numMipLevels)));
+        if (!valid)
+        {
+            setError(error, "Corrupt entry '" + e.name + "' in texture pack " + path_);
+            return false;
+        }
+        byName_.emplace(e.name, entries_.size());
+        entries_.push_back(std::move(e));
+    }
+    if (entries_.size() != count)
+    {
+        setError(error, "Truncated texture pack index: " + path_);
+        return false;
+    }
+    return true;
+}
+
+long long TexturePack::findEntry(const std::string& name) const
+{
+    auto it = byName_.find(name);
+    return it == byName_.end() ? -1 : static_cast<long long>(it->second);
+}
+
+TextureInfo TexturePack::getTextureInfo(const PackEntry& entry)
+{
+    TextureInfo info;
+    info.width = entry.width;
+    info.height = entry.height;
+    info.numChannels = entry.numChannels;
+    info.format = PixelFormat::UINT8;
+    info.numMipLevels = calculateNumMipLevels(entry.width, entry.height);
+    info.isValid = true;
+    info.isTiled = false;
+    return info;
+}
+
+std::string TexturePack::makeEntryPath(const std::string& packPath, const std::string& entryName)
+{
+    return packPath + "#" + entryName;
+}
+
+bool TexturePack::splitEntryPath(const std::string& entryPath, std::string& packPath, std::string& entryName)
+{
+    // Pack paths may not contain '#'; entry names may
+    size_t hash = entryPath.find('#');
+    if (hash == std::string::npos || hash == 0)
+        return false;
+    packPath = entryPath.substr(0, hash);
+    entryName = entryPath.substr(hash + 1);
+    return true;
+}
+
+TexturePackWriter::~TexturePackWriter()
+{
+    if (out_.is_open())
+        out_.close();
+}
+
+bool TexturePackWriter::open(const std::string& path)
+{
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_)
+        return false;
+    // Header is written by finish(); payloads start at the first aligned offset
+    std::string zeros(static_cast<size_t>(kPackAlignment), '\0');
+    out_.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    position_ = kPackAlignment;
+    entries_.clear();
+    names_.clear();
+    failed_ = !out_.good();
+    return !failed_;
+}
+
+bool TexturePackWriter::addPayload(PackEntry entry, const void* data)
+{
+    if (!out_.is_open() || failed_ || entry.name.empty() || entry.name.size() > 0xffff ||
+        names_.count(entry.name) != 0)
+        return false;
+
+    entry.offset = position_;
+    out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(entry.size));
+    uint64_t next = alignUp(position_ + entry.size);
+    std::string padding(static_cast<size_t>(next - position_ - entry.size), '\0');
+    out_.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+    position_ = next;
+    if (!out_)
+    {
+        failed_ = true;
+        return false;
+    }
+    names_.emplace(entry.name, entries_.size());
+    entries_.push_back(std::move(entry));
+    return true;
+}
+
+bool TexturePackWriter::addEncoded(const std::string& name, const void* data, size_t size,
+                                   unsigned int width, unsigned int height, unsigned int numChannels)
+{
+    if (!data || size == 0 || width == 0 || height == 0 || numChannels < 1 || numChannels > 4)
+        return false;
+    PackEntry entry;
+    entry.name = name;
+    entry.size = size;
+    entry.width = width;
+    entry.height = height;
+    entry.numChannels = numChannels;
+    entry.numMipLevels = 1;
+    entry.kind = PackEntryKind::Encoded;
+    return addPayload(std::move(entry), data);
+}
+
+bool TexturePackWriter::addDecoded(const std::string& name, const void* levels, size_t size,
+                                   unsigned int width, unsigned int height, unsigned int numChannels,
+                                   unsigned int numMipLevels)
+{
+    if (!levels || width == 0 || height == 0 || numChannels < 1 || numChannels > 4 || numMipLevels < 1 ||
+        numMipLevels > 0xffff || size != mipChainBytes(width, height, numChannels, numMipLevels))
+        return false;
+    PackEntry entry;
+    entry.name = name;
+    entry.size = size;
+    entry.width = width;
+    entry.height = height;
+    entry.numChannels = numChannels;
+    entry.numMipLevels = numMipLevels;
+    entry.kind = PackEntryKind::Decoded;
+    return addPayload(std::move(entry), levels);
+}
+
+bool TexturePackWriter::finish()
+{
+    if (!out_.is_open())
+        return false;
+
+    std::string index;
+    for (const PackEntry& e : entries_)
+    {
+        putLE(index, e.offset, 8);
+        putLE(index, e.size, 8);
+        putLE(index, e.width, 4);
+        putLE(index, e.height, 4);
+        putLE(index, e.numChannels, 2);
+        putLE(index, e.numMipLevels, 2);
+        putLE(index, static_cast<uint64_t>(e.kind), 1);
+        putLE(index, 0, 1);
+        putLE(index, e.name.size(), 2);
+        index += e.name;
+    }
+    out_.write(index.data(), static_cast<std::streamsize>(index.size()));
+
+    std::string header(kPackMagic, sizeof(kPackMagic));
+    putLE(header, kPackVersion, 4);
+    putLE(header, entries_.size(), 4);
+    putLE(header, position_, 8);
+    putLE(header, index.size(), 8);
+    putLE(header, position_ + index.size(), 8);
+    out_.seekp(0);
+    out_.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out_.close();
+    bool ok = !failed_ && !out_.fail();
+    failed_ = true;  // Closed; further adds fail
+    return ok;
+}
+
+}  // namespace hip_demand
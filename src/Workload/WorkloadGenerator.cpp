@@ -0,0 +1,378 @@
+#include "Workload/WorkloadGenerator.h"
+#include "DemandLoading/RequestTrace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+// Static so the implementation cannot clash with an application's own copy
+#define STB_IMAGE_WRITE_STATIC
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+namespace hip_demand {
+
+static const char* extensionFor(SyntheticImageFormat format) {
+    switch (format) {
+        case SyntheticImageFormat::TGA: return ".tga";
+        case SyntheticImageFormat::BMP: return ".bmp";
+        case SyntheticImageFormat::JPG: return ".jpg";
+        default: return ".png";
+    }
+}
+
+static uint32_t floorLog2(uint32_t v) {
+    uint32_t log = 0;
+    while (v > 1) {
+        v >>= 1;
+        log++;
+    }
+    return log;
+}
+
+std::vector<SyntheticTexture> generateCorpus(const CorpusSpec& spec) {
+    std::mt19937_64 rng(spec.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    uint32_t minLog = floorLog2(std::max(1u, spec.minSize));
+    uint32_t maxLog = std::max(minLog, floorLog2(std::max(1u, spec.maxSize)));
+    std::uniform_int_distribution<uint32_t> octave(minLog, maxLog);
+    std::discrete_distribution<uint32_t> weighted(spec.sizeWeights.begin(), spec.sizeWeights.end());
+    std::vector<uint32_t> channelChoices = spec.channels.empty() ? std::vector<uint32_t>{4} : spec.channels;
+    std::uniform_int_distribution<size_t> channelPick(0, channelChoices.size() - 1);
+    uint32_t tilesPerAsset = std::max(1u, spec.tilesPerAsset);
+
+    std::vector<SyntheticTexture> corpus(spec.textureCount);
+    std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint32_t> classCounts;
+    float assetX = 0.0f, assetY = 0.0f;
+
+    for (uint32_t i = 0; i < spec.textureCount; ++i) {
+        SyntheticTexture& tex = corpus[i];
+
+        uint32_t log = maxLog;
+        if (spec.sizeDistribution == SizeDistribution::LogUniform) {
+            log = octave(rng);
+        } else if (spec.sizeDistribution == SizeDistribution::Weighted && !spec.sizeWeights.empty()) {
+            log = std::min(maxLog, minLog + weighted(rng));
+        }
+        uint32_t edge = 1u << log;
+        bool wide = unit(rng) < spec.wideFraction;
+        tex.width = edge;
+        tex.height = wide ? std::max(1u, edge / 2) : edge;
+        tex.channels = channelChoices[channelPick(rng)];
+
+        // Tiles of one asset sit close together in the world
+        tex.asset = i / tilesPerAsset;
+        if (i % tilesPerAsset == 0) {
+            assetX = static_cast<float>(unit(rng));
+            assetY = static_cast<float>(unit(rng));
+        }
+        tex.x = std::fmod(assetX + 0.01f * static_cast<float>(unit(rng)), 1.0f);
+        tex.y = std::fmod(assetY + 0.01f * static_cast<float>(unit(rng)), 1.0f);
+
+        uint32_t& count = classCounts[std::make_tuple(tex.width, tex.height, tex.channels)];
+        uint32_t fileIndex = spec.filesPerClass ? count % spec.filesPerClass : count;
+        count++;
+
+        std::ostringstream name;
+        name << spec.directory << "/tex_" << tex.width << "x" << tex.height << "_c" << tex.channels << "_"
+             << fileIndex << extensionFor(spec.format);
+        tex.filename = name.str();
+    }
+    return corpus;
+}
+
+// Procedural content: gradients and a checker tinted per file, so files differ
+// and compress like ordinary textures rather than flat color
+static void fillImage(std::vector<uint8_t>& pixels, uint32_t width, uint32_t height, uint32_t channels,
+                      uint32_t tint) {
+    pixels.resize(static_cast<size_t>(width) * height * channels);
+    uint32_t checker = std::max(1u, width / 8);
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t x = 0; x < width; ++x) {
+            uint8_t* p = &pixels[(static_cast<size_t>(y) * width + x) * channels];
+            bool dark = ((x / checker) + (y / checker)) & 1;
+            uint8_t rgb[3] = {
+                static_cast<uint8_t>((x * 255 / std::max(1u, width - 1)) ^ (tint & 0xff)),
+                static_cast<uint8_t>((y * 255 / std::max(1u, height - 1)) ^ ((tint >> 8) & 0xff)),
+                static_cast<uint8_t>(dark ? (tint >> 16) & 0x7f : 0x80 | ((tint >> 16) & 0x7f))
+            };
+            for (uint32_t c = 0; c < channels; ++c) {
+                p[c] = (c < 3) ? rgb[c] : 255;
+            }
+        }
+    }
+}
+
+size_t writeCorpusImages(const std::vector<SyntheticTexture>& corpus, SyntheticImageFormat format,
+                         unsigned int threads, std::string* error) {
+    namespace fs = std::filesystem;
+
+    // One entry per distinct file that is not on disk yet
+    std::vector<const SyntheticTexture*> files;
+    {
+        std::map<std::string, bool> seen;
+        for (const SyntheticTexture& tex : corpus) {
+            if (seen.emplace(tex.filename, true).second && !fs::exists(tex.filename)) {
+                files.push_back(&tex);
+            }
+        }
+    }
+
+    std::error_code ec;
+    for (const SyntheticTexture* tex : files) {
+        fs::path parent = fs::path(tex->filename).parent_path();
+        if (!parent.empty()) fs::create_directories(parent, ec);
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> written{0};
+    std::mutex errorMutex;
+    auto worker = [&]() {
+        std::vector<uint8_t> pixels;
+        for (size_t i; (i = next.fetch_add(1)) < files.size();) {
+            const SyntheticTexture& tex = *files[i];
+            fillImage(pixels, tex.width, tex.height, tex.channels,
+                      static_cast<uint32_t>(std::hash<std::string>()(tex.filename)));
+            int w = static_cast<int>(tex.width);
+            int h = static_cast<int>(tex.height);
+            int c = static_cast<int>(tex.channels);
+            int ok = 0;
+            switch (format) {
+                case SyntheticImageFormat::TGA: ok = stbi_write_tga(tex.filename.c_str(), w, h, c, pixels.data()); break;
+                case SyntheticImageFormat::BMP: ok = stbi_write_bmp(tex.filename.c_str(), w, h, c, pixels.data()); break;
+                case SyntheticImageFormat::JPG: ok = stbi_write_jpg(tex.filename.c_str(), w, h, c, pixels.data(), 90); break;
+                default: ok = stbi_write_png(tex.filename.c_str(), w, h, c, pixels.data(), w * c); break;
+            }
+            if (ok) {
+                written++;
+            } else if (error) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                *error = "Failed to write " + tex.filename;
+            }
+        }
+    };
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads && t < files.size(); ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& t : pool) t.join();
+    return written;
+}
+
+bool writeCorpusManifest(const std::string& path, const std::vector<SyntheticTexture>& corpus) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+    for (const SyntheticTexture& tex : corpus) {
+        out << tex.width << " " << tex.height << " " << tex.channels << " " << tex.filename << "\n";
+    }
+    return out.good();
+}
+
+bool readCorpusManifest(const std::string& path, std::vector<SyntheticTexture>& corpus) {
+    std::ifstream in(path);
+    if (!in) return false;
+    corpus.clear();
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::istringstream fields(line);
+        SyntheticTexture tex;
+        if (!(fields >> tex.width >> tex.height >> tex.channels)) return false;
+        fields.get();  // single separator; the filename may contain spaces
+        std::getline(fields, tex.filename);
+        corpus.push_back(std::move(tex));
+    }
+    return true;
+}
+
+uint64_t estimateTextureBytes(uint32_t width, uint32_t height) {
+    // Same accounting as DemandTextureLoader for RGBA8 mipmapped textures
+    uint64_t total = 0;
+    while (width > 0 && height > 0) {
+        total += static_cast<uint64_t>(width) * height * 4;
+        width /= 2;
+        height /= 2;
+    }
+    return total;
+}
+
+AccessGenerator::AccessGenerator(const AccessSpec& spec, const std::vector<SyntheticTexture>& corpus)
+    : spec_(spec), corpus_(corpus), rng_(spec.seed) {
+    if (spec_.pattern == AccessPattern::Zipf) {
+        buildZipf(corpus_.size());
+    } else if (spec_.pattern == AccessPattern::Udim) {
+        for (uint32_t i = 0; i < corpus_.size(); ++i) {
+            if (i == 0 || corpus_[i].asset != corpus_[i - 1].asset) {
+                assetStart_.push_back(i);
+                assetTiles_.push_back(0);
+            }
+            assetTiles_.back()++;
+        }
+        buildZipf(assetStart_.size());
+    } else if (spec_.pattern == AccessPattern::Flythrough) {
+        double radius = std::max(1e-4, spec_.viewRadius);
+        gridSize_ = static_cast<uint32_t>(std::min(1024.0, std::max(1.0, std::floor(1.0 / radius))));
+        grid_.resize(static_cast<size_t>(gridSize_) * gridSize_);
+        for (uint32_t i = 0; i < corpus_.size(); ++i) {
+            uint32_t cx = std::min(gridSize_ - 1, static_cast<uint32_t>(corpus_[i].x * gridSize_));
+            uint32_t cy = std::min(gridSize_ - 1, static_cast<uint32_t>(corpus_[i].y * gridSize_));
+            grid_[static_cast<size_t>(cy) * gridSize_ + cx].push_back(i);
+        }
+    }
+    startShot();
+}
+
+void AccessGenerator::buildZipf(size_t n) {
+    zipfCdf_.resize(n);
+    double sum = 0.0;
+    for (size_t rank = 0; rank < n; ++rank) {
+        sum += 1.0 / std::pow(static_cast<double>(rank + 1), spec_.zipfExponent);
+        zipfCdf_[rank] = sum;
+    }
+    ranking_.resize(n);
+    for (size_t i = 0; i < n; ++i) ranking_[i] = static_cast<uint32_t>(i);
+}
+
+void AccessGenerator::startShot() {
+    if (!ranking_.empty()) {
+        std::shuffle(ranking_.begin(), ranking_.end(), rng_);
+    }
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    cameraOrigin_[0] = unit(rng_);
+    cameraOrigin_[1] = unit(rng_);
+    cameraPhase_ = 0.0;
+}
+
+uint32_t AccessGenerator::sampleZipf() {
+    std::uniform_real_distribution<double> u(0.0, zipfCdf_.back());
+    size_t rank = std::upper_bound(zipfCdf_.begin(), zipfCdf_.end(), u(rng_)) - zipfCdf_.begin();
+    return ranking_[std::min(rank, ranking_.size() - 1)];
+}
+
+void AccessGenerator::sampleFlythrough(std::vector<uint32_t>& ids) {
+    // Camera drifts along x with a gentle sine in y; the world wraps around
+    cameraPhase_ += spec_.cameraSpeed;
+    double px = cameraOrigin_[0] + cameraPhase_;
+    double py = cameraOrigin_[1] + 0.1 * std::sin(12.566 * cameraPhase_);
+    px -= std::floor(px);
+    py -= std::floor(py);
+
+    auto wrapDist = [](double a, double b) {
+        double d = std::fabs(a - b);
+        return std::min(d, 1.0 - d);
+    };
+    double r = spec_.viewRadius;
+    int reach = static_cast<int>(std::ceil(r * gridSize_));
+    int cx = static_cast<int>(px * gridSize_);
+    int cy = static_cast<int>(py * gridSize_);
+    int n = static_cast<int>(gridSize_);
+
+    // Cells within reach of the camera; each cell once even when the view spans the world
+    int lo = -reach, hi = reach;
+    if (2 * reach + 1 >= n) {
+        lo = 0;
+        hi = n - 1;
+        cx = cy = 0;
+    }
+
+    std::vector<uint32_t> visible;
+    for (int dy = lo; dy <= hi; ++dy) {
+        for (int dx = lo; dx <= hi; ++dx) {
+            int gx = ((cx + dx) % n + n) % n;
+            int gy = ((cy + dy) % n + n) % n;
+            for (uint32_t id : grid_[static_cast<size_t>(gy) * gridSize_ + gx]) {
+                double ddx = wrapDist(corpus_[id].x, px);
+                double ddy = wrapDist(corpus_[id].y, py);
+                if (ddx * ddx + ddy * ddy <= r * r) visible.push_back(id);
+            }
+        }
+    }
+
+    // Keep a random subset when more is visible than one frame samples
+    if (visible.size() > spec_.accessesPerFrame) {
+        for (size_t i = 0; i < spec_.accessesPerFrame; ++i) {
+            std::uniform_int_distribution<size_t> pick(i, visible.size() - 1);
+            std::swap(visible[i], visible[pick(rng_)]);
+        }
+        visible.resize(spec_.accessesPerFrame);
+    }
+    ids.insert(ids.end(), visible.begin(), visible.end());
+}
+
+void AccessGenerator::sampleUdim(std::vector<uint32_t>& ids) {
+    uint32_t drawn = 0;
+    while (drawn < spec_.accessesPerFrame && !assetStart_.empty()) {
+        uint32_t asset = sampleZipf();
+        uint32_t tiles = assetTiles_[asset];
+        std::uniform_int_distribution<uint32_t> runLength(1, tiles);
+        uint32_t length = runLength(rng_);
+        std::uniform_int_distribution<uint32_t> runStart(0, tiles - length);
+        uint32_t first = assetStart_[asset] + runStart(rng_);
+        for (uint32_t t = 0; t < length; ++t) ids.push_back(first + t);
+        drawn += length;
+    }
+}
+
+bool AccessGenerator::nextFrame(std::vector<uint32_t>& ids) {
+    ids.clear();
+    if (frame_ >= spec_.frames || corpus_.empty()) {
+        return false;
+    }
+    if (spec_.shotLength > 0 && frame_ > 0 && frame_ % spec_.shotLength == 0) {
+        startShot();
+    }
+
+    switch (spec_.pattern) {
+        case AccessPattern::Uniform: {
+            std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(corpus_.size() - 1));
+            for (uint32_t i = 0; i < spec_.accessesPerFrame; ++i) ids.push_back(pick(rng_));
+            break;
+        }
+        case AccessPattern::Zipf:
+            for (uint32_t i = 0; i < spec_.accessesPerFrame; ++i) ids.push_back(sampleZipf());
+            break;
+        case AccessPattern::Flythrough:
+            sampleFlythrough(ids);
+            break;
+        case AccessPattern::Udim:
+            sampleUdim(ids);
+            break;
+    }
+
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    frame_++;
+    return true;
+}
+
+bool writeWorkloadTrace(const std::string& path, const std::vector<SyntheticTexture>& corpus,
+                        AccessGenerator& access) {
+    RequestTraceWriter writer;
+    if (!writer.open(path)) return false;
+
+    for (uint32_t i = 0; i < corpus.size(); ++i) {
+        const SyntheticTexture& tex = corpus[i];
+        writer.writeTexture(0, i, tex.width, tex.height, tex.channels,
+                            estimateTextureBytes(tex.width, tex.height), tex.filename);
+    }
+
+    // Frames are numbered from 1, as launchPrepare() does
+    std::vector<uint32_t> ids;
+    while (access.nextFrame(ids)) {
+        writer.writeRequests(access.getFrame(), ids);
+    }
+    return writer.good();
+}
+
+} // namespace hip_demand
@@ -0,0 +1,45 @@
+#pragma once
+
+// Minimal assertion helpers for the unit tests: each test is a plain
+// executable that returns nonzero when any check failed, so ctest needs no
+// framework.
+
+#include <cmath>
+#include <cstdio>
+
+namespace hip_demand_test {
+
+inline int& failureCount() {
+    static int count = 0;
+    return count;
+}
+
+inline int finish(const char* name) {
+    if (failureCount() != 0) {
+        std::printf("%s: %d check(s) failed\n", name, failureCount());
+        return 1;
+    }
+    std::printf("%s: passed\n", name);
+    return 0;
+}
+
+} // namespace hip_demand_test
+
+#define CHECK(cond)                                                              \
+    do {                                                                         \
+        if (!(cond)) {                                                           \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++hip_demand_test::failureCount();                                   \
+        }                                                                        \
+    } while (0)
+
+#define CHECK_NEAR(a, b, eps)                                                         \
+    do {                                                                              \
+        const double checkA_ = (a);                                                   \
+        const double checkB_ = (b);                                                   \
+        if (!(std::fabs(checkA_ - checkB_) <= (eps))) {                               \
+            std::printf("%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__,    \
+                        __LINE__, #a, #b, checkA_, checkB_);                          \
+            ++hip_demand_test::failureCount();                                        \
+        }                                                                             \
+    } while (0)
@@ -0,0 +1,112 @@
+// Address modes and filtering of the host sampler (CpuTextureSampling).
+
+#include "DemandLoading/CpuTextureSampling.h"
+#include "TestCheck.h"
+
+#include <cstdint>
+#include <cstring>
+
+using namespace hip_demand;
+
+namespace {
+
+// 4x1 RGBA8 texture whose red channel is 0, 1, 2, 3 (over 255) from left to right
+CpuTexture makeRamp(hipTextureAddressMode mode, hipTextureFilterMode filter) {
+    CpuTexture tex;
+    tex.storage.reset(new uint8_t[4 * 4]);
+    std::memset(tex.storage.get(), 0, 4 * 4);
+    for (int x = 0; x < 4; ++x) {
+        tex.storage[x * 4 + 0] = static_cast<uint8_t>(x);
+        tex.storage[x * 4 + 3] = 255;
+    }
+    tex.levels.push_back(CpuMipLevel{tex.storage.get(), 4, 1});
+    tex.addressMode[0] = mode;
+    tex.addressMode[1] = mode;
+    tex.filterMode = filter;
+    tex.mipmapFilterMode = hipFilterModePoint;
+    return tex;
+}
+
+// Texel index the point sampler returned, or -1 for transparent black
+int texelAt(const CpuTexture& tex, float u) {
+    float4 c = sampleCpuTexture(tex, u, 0.5f, 0.0f);
+    if (c.w == 0.0f) return -1;
+    return static_cast<int>(c.x * 255.0f + 0.5f);
+}
+
+void testWrap() {
+    CpuTexture tex = makeRamp(hipAddressModeWrap, hipFilterModePoint);
+    CHECK(texelAt(tex, 0.125f) == 0);
+    CHECK(texelAt(tex, 0.875f) == 3);
+    CHECK(texelAt(tex, 1.125f) == 0);
+    CHECK(texelAt(tex, -0.125f) == 3);
+    CHECK(texelAt(tex, -3.875f) == 0);
+    CHECK(texelAt(tex, 1000.375f) == 1);
+}
+
+void testClamp() {
+    CpuTexture tex = makeRamp(hipAddressModeClamp, hipFilterModePoint);
+    CHECK(texelAt(tex, -0.5f) == 0);
+    CHECK(texelAt(tex, -1000.0f) == 0);
+    CHECK(texelAt(tex, 1.5f) == 3);
+    CHECK(texelAt(tex, 1000.0f) == 3);
+    CHECK(texelAt(tex, 0.625f) == 2);
+}
+
+void testMirror() {
+    CpuTexture tex = makeRamp(hipAddressModeMirror, hipFilterModePoint);
+    CHECK(texelAt(tex, 0.125f) == 0);
+    CHECK(texelAt(tex, 1.125f) == 3);  // Reflected back from the right edge
+    CHECK(texelAt(tex, 1.875f) == 0);
+    CHECK(texelAt(tex, -0.125f) == 0); // Reflected from the left edge
+    CHECK(texelAt(tex, -0.875f) == 3);
+    CHECK(texelAt(tex, 2.125f) == 0);  // Period of two widths
+}
+
+void testBorder() {
+    CpuTexture tex = makeRamp(hipAddressModeBorder, hipFilterModePoint);
+    CHECK(texelAt(tex, 0.375f) == 1);
+    CHECK(texelAt(tex, -0.125f) == -1);
+    CHECK(texelAt(tex, 1.125f) == -1);
+
+    // Linear filtering at the edge blends toward transparent black
+    CpuTexture linear = makeRamp(hipAddressModeBorder, hipFilterModeLinear);
+    float4 c = sampleCpuTexture(linear, 0.0f, 0.5f, 0.0f);
+    CHECK_NEAR(c.w, 0.5, 1e-5);
+}
+
+void testLinear() {
+    CpuTexture tex = makeRamp(hipAddressModeClamp, hipFilterModeLinear);
+    // Halfway between texel 1 and texel 2 centers
+    float4 c = sampleCpuTexture(tex, 0.5f, 0.5f, 0.0f);
+    CHECK_NEAR(c.x * 255.0f, 1.5, 1e-3);
+    // Clamp repeats the edge texel, so the left edge stays at texel 0
+    c = sampleCpuTexture(tex, 0.0f, 0.5f, 0.0f);
+    CHECK_NEAR(c.x * 255.0f, 0.0, 1e-3);
+
+    CpuTexture wrap = makeRamp(hipAddressModeWrap, hipFilterModeLinear);
+    // The left edge of a wrapped texture blends the first and last texels
+    c = sampleCpuTexture(wrap, 0.0f, 0.5f, 0.0f);
+    CHECK_NEAR(c.x * 255.0f, 1.5, 1e-3);
+}
+
+void testUnnormalized() {
+    CpuTexture tex = makeRamp(hipAddressModeClamp, hipFilterModePoint);
+    tex.normalizedCoords = false;
+    float4 c = sampleCpuTexture(tex, 2.5f, 0.5f, 0.0f);
+    CHECK_NEAR(c.x * 255.0f, 2.0, 1e-3);
+    c = sampleCpuTexture(tex, 9.0f, 0.5f, 0.0f);
+    CHECK_NEAR(c.x * 255.0f, 3.0, 1e-3);
+}
+
+} // namespace
+
+int main() {
+    testWrap();
+    testClamp();
+    testMirror();
+    testBorder();
+    testLinear();
+    testUnnormalized();
+    return hip_demand_test::finish("test_cpu_sampling");
+}
@@ -0,0 +1,81 @@
+// Percentiles of LatencyHistogram: exact below 16, within 12.5% above.
+
+#include "DemandLoading/LatencyHistogram.h"
+#include "TestCheck.h"
+
+#include <cstdint>
+
+using namespace hip_demand;
+
+namespace {
+
+void testEmpty() {
+    LatencyHistogram h;
+    CHECK(h.count() == 0);
+    CHECK(h.max() == 0);
+    CHECK(h.percentile(0.5) == 0);
+    CHECK(h.percentile(1.0) == 0);
+}
+
+void testSmallValuesExact() {
+    LatencyHistogram h;
+    for (uint64_t v = 0; v < 10; ++v) {
+        h.add(v);
+    }
+    CHECK(h.count() == 10);
+    CHECK(h.max() == 9);
+    CHECK(h.percentile(0.1) == 0);
+    CHECK(h.percentile(0.5) == 4);
+    CHECK(h.percentile(0.9) == 8);
+    CHECK(h.percentile(1.0) == 9);
+}
+
+void testLargeValuesWithinBucketError() {
+    LatencyHistogram h;
+    for (uint64_t v = 1; v <= 100000; ++v) {
+        h.add(v);
+    }
+    const double ps[] = {0.5, 0.9, 0.99, 0.999};
+    for (double p : ps) {
+        const double truth = p * 100000.0;
+        const double got = static_cast<double>(h.percentile(p));
+        CHECK(got >= truth);
+        CHECK(got <= truth * 1.125 + 1.0);
+    }
+    CHECK(h.percentile(1.0) == 100000);
+}
+
+void testCappedAtMax() {
+    LatencyHistogram h;
+    h.add(1000);
+    // The bucket bound is above 1000, but the reported value never exceeds a real sample
+    CHECK(h.percentile(0.5) == 1000);
+    CHECK(h.percentile(1.0) == 1000);
+
+    h.add(UINT64_MAX);
+    CHECK(h.max() == UINT64_MAX);
+    CHECK(h.percentile(1.0) == UINT64_MAX);
+}
+
+void testClear() {
+    LatencyHistogram h;
+    h.add(5);
+    h.add(500);
+    h.clear();
+    CHECK(h.count() == 0);
+    CHECK(h.max() == 0);
+    CHECK(h.percentile(0.99) == 0);
+    h.add(7);
+    CHECK(h.percentile(0.5) == 7);
+}
+
+} // namespace
+
+int main() {
+    testEmpty();
+    testSmallValuesExact();
+    testLargeValuesWithinBucketError();
+    testCappedAtMax();
+    testClear();
+    return hip_demand_test::finish("test_latency_histogram");
+}
@@ -0,0 +1,151 @@
+// MemoryArbiter rebalancing: floors, priority tiers, proportional splits,
+// slack, demand decay, eviction requests and leave(). A fixed totalBytes
+// keeps the pool independent of the device.
+
+#include "DemandLoading/MemoryArbiter.h"
+#include "TestCheck.h"
+
+#include <cstddef>
+#include <vector>
+
+using namespace hip_demand;
+
+namespace {
+
+// Budget callbacks a member received
+struct Notices {
+    std::vector<size_t> budgets;
+    std::vector<bool> evicts;
+
+    MemoryArbiter::BudgetCallback callback() {
+        return [this](size_t budget, bool evict) {
+            budgets.push_back(budget);
+            evicts.push_back(evict);
+        };
+    }
+};
+
+MemoryArbiterOptions poolOf(size_t totalBytes, size_t minLoaderBytes) {
+    MemoryArbiterOptions options;
+    options.totalBytes = totalBytes;
+    options.minLoaderBytes = minLoaderBytes;
+    return options;
+}
+
+ArbiterLoaderStats statsFor(const MemoryArbiter& arbiter, uint32_t id) {
+    for (const ArbiterLoaderStats& s : arbiter.getLoaderStats()) {
+        if (s.id == id) return s;
+    }
+    CHECK(!"no such loader");
+    return ArbiterLoaderStats();
+}
+
+void testSingleLoaderGetsPool() {
+    MemoryArbiter arbiter(poolOf(1000, 100));
+    Notices notices;
+    auto member = arbiter.join(0, notices.callback());
+    CHECK(arbiter.getTotalBudget() == 1000);
+    CHECK(arbiter.report(*member, 0, 400) == 1000);
+    // The reporter gets its budget back rather than through the callback
+    CHECK(notices.budgets.empty());
+    arbiter.leave(member);
+    CHECK(arbiter.getLoaderStats().empty());
+}
+
+void testPriorityTakesFromLower() {
+    MemoryArbiter arbiter(poolOf(1000, 100));
+    Notices lowNotices, highNotices;
+    auto low = arbiter.join(0, lowNotices.callback());
+    auto high = arbiter.join(1, highNotices.callback());
+    // Joining splits the pool evenly while nobody has demand
+    CHECK(lowNotices.budgets.size() == 1 && lowNotices.budgets.back() == 500);
+
+    // Low alone wants 800: floor 100 each, low's demand met, 200 slack split evenly
+    CHECK(arbiter.report(*low, 800, 800) == 900);
+    CHECK(highNotices.budgets.size() == 1 && highNotices.budgets.back() == 100);
+    CHECK(!highNotices.evicts.back());
+
+    // High wants 700: met first, low gets the 200 left over its floor
+    CHECK(arbiter.report(*high, 0, 700) == 700);
+    CHECK(lowNotices.budgets.size() == 2 && lowNotices.budgets.back() == 300);
+    CHECK(lowNotices.evicts.back());  // Low holds 800
+    CHECK(statsFor(arbiter, 0).evictionRequests == 1);
+    CHECK(statsFor(arbiter, 1).evictionRequests == 0);
+
+    // A lower budget is not another eviction request while low is still over it
+    CHECK(arbiter.report(*low, 300, 800) == 300);
+    CHECK(statsFor(arbiter, 0).evictionRequests == 1);
+
+    // High leaving returns the pool to low
+    arbiter.leave(high);
+    CHECK(lowNotices.budgets.back() == 1000);
+    CHECK(!lowNotices.evicts.back());
+    size_t highCalls = highNotices.budgets.size();
+    CHECK(arbiter.report(*low, 300, 800) == 1000);
+    CHECK(highNotices.budgets.size() == highCalls);  // No callbacks after leave()
+    arbiter.leave(low);
+}
+
+void testFloorProtectsLowPriority() {
+    MemoryArbiter arbiter(poolOf(1000, 100));
+    auto high = arbiter.join(2, nullptr);
+    auto lowA = arbiter.join(0, nullptr);
+    auto lowB = arbiter.join(0, nullptr);
+    arbiter.report(*lowA, 0, 500);
+    arbiter.report(*lowB, 0, 500);
+    // High's demand exceeds the pool, but each low keeps its floor
+    CHECK(arbiter.report(*high, 0, 2000) == 800);
+    CHECK(statsFor(arbiter, 1).budget == 100);
+    CHECK(statsFor(arbiter, 2).budget == 100);
+
+    // A floor never exceeds demand; the unused part is slack
+    arbiter.report(*lowB, 0, 0);  // Demand decays by an eighth per report, not at once
+    CHECK(statsFor(arbiter, 2).demand == 500 - 500 / 8);
+    arbiter.leave(high);
+    arbiter.leave(lowA);
+    arbiter.leave(lowB);
+}
+
+void testProportionalSplit() {
+    MemoryArbiter arbiter(poolOf(1000, 0));
+    auto a = arbiter.join(0, nullptr);
+    auto b = arbiter.join(0, nullptr);
+    arbiter.report(*a, 0, 600);
+    // Same priority, 2000 wanted of 1000: split 3:7 by demand
+    CHECK(arbiter.report(*b, 0, 1400) == 700);
+    CHECK(statsFor(arbiter, 0).budget == 300);
+    CHECK(arbiter.getTotalBudget() == 1000);
+    arbiter.leave(a);
+    arbiter.leave(b);
+}
+
+void testSlackSharedEvenly() {
+    MemoryArbiter arbiter(poolOf(1000, 0));
+    auto a = arbiter.join(5, nullptr);
+    auto b = arbiter.join(0, nullptr);
+    arbiter.report(*a, 0, 100);
+    CHECK(arbiter.report(*b, 0, 300) == 300 + 300);
+    CHECK(statsFor(arbiter, 0).budget == 100 + 300);
+
+    // A loader with no demand still gets a nonzero budget (0 would mean unlimited)
+    MemoryArbiter tiny(poolOf(1, 0));
+    auto x = tiny.join(0, nullptr);
+    auto y = tiny.join(0, nullptr);
+    CHECK(tiny.report(*x, 0, 0) == 1);
+    CHECK(tiny.report(*y, 0, 0) == 1);
+    tiny.leave(x);
+    tiny.leave(y);
+    arbiter.leave(a);
+    arbiter.leave(b);
+}
+
+} // namespace
+
+int main() {
+    testSingleLoaderGetsPool();
+    testPriorityTakesFromLower();
+    testFloorProtectsLowPriority();
+    testProportionalSplit();
+    testSlackSharedEvenly();
+    return hip_demand_test::finish("test_memory_arbiter");
+}
@@ -0,0 +1,174 @@
+// RequestTraceWriter/Reader round trip, version handling and truncated files.
+
+#include "DemandLoading/RequestTrace.h"
+#include "TestCheck.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace hip_demand;
+
+namespace {
+
+const char* kTracePath = "test_request_trace.tmp";
+
+std::vector<char> readAll(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeAll(const std::string& path, const std::vector<char>& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+void writeSampleTrace() {
+    RequestTraceWriter writer;
+    CHECK(writer.open(kTracePath));
+    writer.writeBudget(0, 1ull << 33);
+    writer.writeTexture(0, 7, 1024, 512, 4, 2796202, "textures/brick.png");
+    writer.writeRequests(1, {7, 300, 70000});
+    writer.writeLoad(1, 7, 2796160, 1234, true);
+    writer.writeLatency(2, 7, 2796202, 1, 250, 1500);
+    writer.writeLoad(2, 300, 0, 10, false);
+    writer.writeEvict(3, 7, 2796160);
+    CHECK(writer.good());
+    CHECK(writer.getEventCount() == 7);
+}
+
+void testRoundTrip() {
+    writeSampleTrace();
+
+    RequestTraceReader reader;
+    CHECK(reader.open(kTracePath));
+    TraceEvent e;
+
+    CHECK(reader.next(e));
+    CHECK(e.type == TraceEventType::Budget);
+    CHECK(e.bytes == (1ull << 33));
+
+    CHECK(reader.next(e));
+    CHECK(e.type == TraceEventType::Texture);
+    CHECK(e.textureId == 7);
+    CHECK(e.width == 1024 && e.height == 512 && e.channels == 4);
+    CHECK(e.bytes == 2796202);
+    CHECK(e.filename == "textures/brick.png");
+
+    CHECK(reader.next(e));
+    CHECK(e.type == TraceEventType::Requests);
+    CHECK(e.frame == 1);
+    CHECK((e.textureIds == std::vector<uint32_t>{7, 300, 70000}));
+
+    CHECK(reader.next(e));
+    CHECK(e.type == TraceEventType::Load);
+    CHECK(e.textureId == 7 && e.bytes == 2796160 && e.micros == 1234 && e.success);
+
+    CHECK(reader.next(e));
+    CHECK(e.type == TraceEventType::Latency);
+    CHECK(e.frame == 2);
+    CHECK(e.textureId == 7);
+    CHECK(e.bytes == 2796202);
+    CHECK(e.missFrame == 1);
+    CHECK(e.queueMicros == 250);
+    CHECK(e.micros == 1500);
+
+    CHECK(reader.next(e));
+    CHECK(e.type == TraceEventType::Load);
+    CHECK(e.textureId == 300 && !e.success);
+
+    CHECK(reader.next(e));
+    CHECK(e.type == TraceEventType::Evict);
+    CHECK(e.frame == 3 && e.bytes == 2796160);
+
+    CHECK(!reader.next(e));
+    CHECK(!reader.hadError());
+}
+
+void testTruncated() {
+    writeSampleTrace();
+    std::vector<char> bytes = readAll(kTracePath);
+    // Cut the last record (Evict) in half
+    bytes.resize(bytes.size() - 3);
+    writeAll(kTracePath, bytes);
+
+    RequestTraceReader reader;
+    CHECK(reader.open(kTracePath));
+    TraceEvent e;
+    int records = 0;
+    while (reader.next(e)) {
+        records++;
+    }
+    CHECK(records == 6);
+    CHECK(reader.hadError());
+    // Stays stopped after an error
+    CHECK(!reader.next(e));
+}
+
+void testVersions() {
+    // A version 1 header is still accepted
+    std::vector<char> v1 = {'H', 'D', 'T', 'R', 'A', 'C', 'E', '\0', 1,
+                            static_cast<char>(TraceEventType::Evict), 5, 9, 100};
+    writeAll(kTracePath, v1);
+    RequestTraceReader reader;
+    CHECK(reader.open(kTracePath));
+    TraceEvent e;
+    CHECK(reader.next(e));
+    CHECK(e.type == TraceEventType::Evict && e.frame == 5 && e.textureId == 9 && e.bytes == 100);
+    CHECK(!reader.next(e));
+    CHECK(!reader.hadError());
+
+    // Newer versions and bad magic are rejected up front
+    std::vector<char> v3 = v1;
+    v3[8] = 3;
+    writeAll(kTracePath, v3);
+    RequestTraceReader newer;
+    CHECK(!newer.open(kTracePath));
+
+    std::vector<char> badMagic = v1;
+    badMagic[0] = 'X';
+    writeAll(kTracePath, badMagic);
+    RequestTraceReader bad;
+    CHECK(!bad.open(kTracePath));
+
+    RequestTraceReader missing;
+    CHECK(!missing.open("test_request_trace_missing.tmp"));
+}
+
+void testUnknownRecordType() {
+    std::vector<char> bytes = {'H', 'D', 'T', 'R', 'A', 'C', 'E', '\0', 2, 42, 0};
+    writeAll(kTracePath, bytes);
+    RequestTraceReader reader;
+    CHECK(reader.open(kTracePath));
+    TraceEvent e;
+    CHECK(!reader.next(e));
+    CHECK(reader.hadError());
+}
+
+void testOversizedLengths() {
+    // A Requests record claiming 2^35 ids must fail instead of allocating
+    std::vector<char> bytes = {'H', 'D', 'T', 'R', 'A', 'C', 'E', '\0', 2,
+                               static_cast<char>(TraceEventType::Requests), 0,
+                               static_cast<char>(0x80), static_cast<char>(0x80), static_cast<char>(0x80),
+                               static_cast<char>(0x80), static_cast<char>(0x80), 1};
+    writeAll(kTracePath, bytes);
+    RequestTraceReader reader;
+    CHECK(reader.open(kTracePath));
+    TraceEvent e;
+    CHECK(!reader.next(e));
+    CHECK(reader.hadError());
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip();
+    testTruncated();
+    testVersions();
+    testUnknownRecordType();
+    testOversizedLengths();
+    std::remove(kTracePath);
+    return hip_demand_test::finish("test_request_trace");
+}
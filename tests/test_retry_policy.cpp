@@ -0,0 +1,120 @@
+// Failure classification and retry backoff: the policy functions, and a CPU
+// backend loader with missing and corrupt files.
+
+#include "DemandLoading/CpuTextureSampling.h"
+#include "DemandLoading/DemandTextureLoader.h"
+#include "DemandLoading/RetryPolicy.h"
+#include "TestCheck.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace hip_demand;
+
+namespace {
+
+const char* kMissingPath = "test_retry_missing.ppm";
+const char* kCorruptPath = "test_retry_corrupt.ppm";
+const char* kGoodPath = "test_retry_good.ppm";
+
+void writePpm(const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "P6\n4 4\n255\n";
+    for (int i = 0; i < 4 * 4 * 3; ++i) {
+        out.put(static_cast<char>(i * 5));
+    }
+}
+
+void testClassification() {
+    CHECK(isPermanentFailure(LoaderError::FileNotFound));
+    CHECK(isPermanentFailure(LoaderError::ImageLoadFailed));
+    CHECK(isPermanentFailure(LoaderError::InvalidParameter));
+    CHECK(!isPermanentFailure(LoaderError::OutOfMemory));
+    CHECK(!isPermanentFailure(LoaderError::HipError));
+    CHECK(!isPermanentFailure(LoaderError::Success));
+}
+
+void testBackoff() {
+    // Doubles per consecutive failure up to the cap
+    CHECK(retryBackoffFrames(1, 2, 8) == 2);
+    CHECK(retryBackoffFrames(2, 2, 8) == 4);
+    CHECK(retryBackoffFrames(3, 2, 8) == 8);
+    CHECK(retryBackoffFrames(4, 2, 8) == 8);
+    // Zero options mean one frame; huge failure counts do not overflow the shift
+    CHECK(retryBackoffFrames(1, 0, 0) == 1);
+    CHECK(retryBackoffFrames(0, 3, 100) == 3);
+    CHECK(retryBackoffFrames(1000, 1, 256) == 256);
+    CHECK(retryBackoffFrames(40, 0xffffffffu, 0xffffffffu) == 0xffffffffu);
+}
+
+// One frame: request every id that is not resident, then process
+void frame(DemandTextureLoader& loader, const std::vector<uint32_t>& ids) {
+    loader.launchPrepare();
+    CpuDemandTextureContext ctx = loader.getCpuContext();
+    for (uint32_t id : ids) {
+        if (!isTextureResident(ctx, id)) {
+            recordTextureRequest(ctx, id);
+        }
+    }
+    loader.processRequests();
+}
+
+void testLoaderFailures() {
+    std::remove(kMissingPath);
+    {
+        std::ofstream out(kCorruptPath, std::ios::binary | std::ios::trunc);
+        out << "P6\nnot an image";
+    }
+    writePpm(kGoodPath);
+
+    LoaderOptions options;
+    options.backend = TextureBackend::Cpu;
+    options.maxTextures = 16;
+    options.retryBackoffFrames = 2;
+    options.maxRetryBackoffFrames = 8;
+    DemandTextureLoader loader(options);
+    uint32_t missing = loader.createTexture(kMissingPath).id;
+    uint32_t corrupt = loader.createTexture(kCorruptPath).id;
+    uint32_t good = loader.createTexture(kGoodPath).id;
+    std::vector<uint32_t> ids = {missing, corrupt, good};
+
+    frame(loader, ids);
+    CHECK(loader.getTextureError(missing) == LoaderError::FileNotFound);
+    CHECK(loader.getTextureError(corrupt) == LoaderError::ImageLoadFailed);
+    CHECK(loader.getTextureError(good) == LoaderError::Success);
+    CHECK(loader.getTextureError(1000) == LoaderError::InvalidTextureId);
+    CHECK(loader.getFailedTextureCount() == 2);
+    CHECK(loader.getResidentTextureCount() == 1);
+
+    // Permanent failures are never retried; every later request is suppressed
+    for (int i = 0; i < 5; ++i) {
+        frame(loader, ids);
+    }
+    CHECK(loader.getSuppressedRetryCount() == 10);
+    CHECK(loader.getFailedTextureCount() == 2);
+    CHECK(loader.getTextureError(missing) == LoaderError::FileNotFound);
+
+    // Once the asset exists, retryFailedTextures() lets it load
+    writePpm(kMissingPath);
+    loader.retryFailedTextures();
+    CHECK(loader.getFailedTextureCount() == 0);
+    frame(loader, ids);
+    CHECK(loader.getTextureError(missing) == LoaderError::Success);
+    CHECK(loader.getTextureError(corrupt) == LoaderError::ImageLoadFailed);
+    CHECK(loader.getFailedTextureCount() == 1);
+    CHECK(loader.getResidentTextureCount() == 2);
+}
+
+} // namespace
+
+int main() {
+    testClassification();
+    testBackoff();
+    testLoaderFailures();
+    std::remove(kMissingPath);
+    std::remove(kCorruptPath);
+    std::remove(kGoodPath);
+    return hip_demand_test::finish("test_retry_policy");
+}
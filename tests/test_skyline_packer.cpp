@@ -0,0 +1,131 @@
+// SkylinePacker placement, alignment and rejection.
+
+#include "DemandLoading/SkylinePacker.h"
+#include "TestCheck.h"
+
+#include <cstdint>
+#include <vector>
+
+using namespace hip_demand;
+
+namespace {
+
+struct Rect {
+    uint32_t x, y, w, h;
+};
+
+bool overlaps(const Rect& a, const Rect& b) {
+    return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+void testBottomLeft() {
+    SkylinePacker packer;
+    packer.reset(64, 64, 1);
+    uint32_t x = 0, y = 0;
+    CHECK(packer.insert(32, 32, x, y) && x == 0 && y == 0);
+    CHECK(packer.insert(32, 32, x, y) && x == 32 && y == 0);
+    CHECK(packer.insert(64, 16, x, y) && x == 0 && y == 32);
+    CHECK(packer.usedWidth() == 64 && packer.usedHeight() == 48);
+
+    // A lower spot to the right beats stacking on a taller neighbour
+    packer.reset(64, 64, 1);
+    CHECK(packer.insert(48, 8, x, y) && x == 0 && y == 0);
+    CHECK(packer.insert(16, 16, x, y) && x == 48 && y == 0);
+    CHECK(packer.insert(16, 4, x, y) && x == 0 && y == 8);
+    CHECK(packer.usedHeight() == 16);
+}
+
+void testExactFill() {
+    SkylinePacker packer;
+    packer.reset(64, 64, 1);
+    uint32_t x = 0, y = 0;
+    for (int i = 0; i < 16; ++i) {
+        CHECK(packer.insert(16, 16, x, y));
+        CHECK(x % 16 == 0 && y % 16 == 0);
+    }
+    CHECK(packer.placedArea() == 64 * 64);
+    CHECK(!packer.insert(1, 1, x, y));
+}
+
+void testNoFit() {
+    SkylinePacker packer;
+    packer.reset(64, 32, 1);
+    uint32_t x = 7, y = 7;
+    CHECK(!packer.insert(65, 1, x, y));
+    CHECK(!packer.insert(1, 33, x, y));
+    CHECK(x == 7 && y == 7);  // Untouched on failure
+    CHECK(packer.insert(64, 20, x, y));
+    CHECK(!packer.insert(10, 20, x, y));  // Only 12 rows left
+    CHECK(packer.insert(10, 12, x, y) && y == 20);
+    CHECK(packer.placedArea() == 64 * 20 + 10 * 12);
+
+    // reset() forgets everything placed
+    packer.reset(64, 32, 1);
+    CHECK(packer.placedArea() == 0 && packer.usedWidth() == 0 && packer.usedHeight() == 0);
+    CHECK(packer.insert(64, 32, x, y) && x == 0 && y == 0);
+}
+
+void testAlignment() {
+    SkylinePacker packer;
+    packer.reset(30, 30, 4);  // Rounded down to 28 x 28
+    CHECK(packer.width() == 28 && packer.height() == 28);
+    uint32_t x = 0, y = 0;
+    CHECK(packer.insert(3, 5, x, y) && x == 0 && y == 0);
+    CHECK(packer.placedArea() == 4 * 8);  // Sizes round up to 4
+    CHECK(packer.insert(1, 1, x, y) && x == 4 && y == 0);
+    CHECK(packer.insert(0, 0, x, y) && x % 4 == 0 && y % 4 == 0);  // Empty rects still take one cell
+    CHECK(!packer.insert(29, 1, x, y));
+    CHECK(packer.usedWidth() % 4 == 0 && packer.usedHeight() % 4 == 0);
+
+    // Alignment 0 behaves like 1
+    packer.reset(10, 10, 0);
+    CHECK(packer.insert(10, 10, x, y) && x == 0 && y == 0);
+}
+
+void testRandomNoOverlap() {
+    SkylinePacker packer;
+    const uint32_t alignment = 4;
+    packer.reset(512, 512, alignment);
+    std::vector<Rect> placed;
+    uint64_t area = 0;
+    uint32_t state = 12345;
+    auto next = [&state](uint32_t range) {
+        state = state * 1664525u + 1013904223u;
+        return 1 + (state >> 8) % range;
+    };
+    int failures = 0;
+    for (int i = 0; i < 2000 && failures < 50; ++i) {
+        uint32_t w = next(60), h = next(60);
+        uint32_t x = 0, y = 0;
+        if (!packer.insert(w, h, x, y)) {
+            failures++;
+            continue;
+        }
+        Rect r{x, y, (w + alignment - 1) / alignment * alignment, (h + alignment - 1) / alignment * alignment};
+        CHECK(x % alignment == 0 && y % alignment == 0);
+        CHECK(r.x + r.w <= 512 && r.y + r.h <= 512);
+        for (const Rect& other : placed) {
+            if (overlaps(r, other)) {
+                CHECK(!"rectangles overlap");
+                break;
+            }
+        }
+        CHECK(r.x + r.w <= packer.usedWidth() && r.y + r.h <= packer.usedHeight());
+        placed.push_back(r);
+        area += static_cast<uint64_t>(r.w) * r.h;
+    }
+    CHECK(packer.placedArea() == area);
+    // Bottom-left packing of small rectangles should fill most of the page before giving up
+    CHECK(area > 512ull * 512 * 6 / 10);
+}
+
+} // namespace
+
+int main() {
+    testBottomLeft();
+    testExactFill();
+    testNoFit();
+    testAlignment();
+    testRandomNoOverlap();
+    return hip_demand_test::finish("test_skyline_packer");
+}
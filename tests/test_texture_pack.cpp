@@ -0,0 +1,225 @@
+// TexturePack round trip and rejection of malformed packs.
+
+#include "ImageSource/TexturePack.h"
+#include "TestCheck.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace hip_demand;
+
+namespace {
+
+const char* kPackPath = "test_texture_pack.hdpack";
+const char* kBadPath = "test_texture_pack_bad.hdpack";
+
+// Header field offsets (see TexturePack.h)
+const size_t kCountField = 12;
+const size_t kIndexOffsetField = 16;
+const size_t kIndexSizeField = 24;
+const size_t kFileSizeField = 32;
+
+std::vector<unsigned char> readAll(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void writeAll(const std::string& path, const std::vector<unsigned char>& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+uint64_t getField(const std::vector<unsigned char>& bytes, size_t offset, int size) {
+    uint64_t value = 0;
+    for (int i = size - 1; i >= 0; --i) value = (value << 8) | bytes[offset + i];
+    return value;
+}
+
+void setField(std::vector<unsigned char>& bytes, size_t offset, uint64_t value, int size) {
+    for (int i = 0; i < size; ++i) {
+        bytes[offset + i] = static_cast<unsigned char>(value & 0xff);
+        value >>= 8;
+    }
+}
+
+// Opens a modified copy of the good pack; returns the error, or "" if it opened
+std::string openPatched(const std::vector<unsigned char>& bytes) {
+    writeAll(kBadPath, bytes);
+    std::string error;
+    std::shared_ptr<TexturePack> pack = TexturePack::open(kBadPath, &error);
+    if (pack) return "";
+    CHECK(!error.empty());
+    return error;
+}
+
+bool contains(const std::string& s, const char* what) {
+    return s.find(what) != std::string::npos;
+}
+
+void writeGoodPack() {
+    // 2x2 RGBA with two levels: 16 + 4 bytes
+    unsigned char levels[20];
+    for (int i = 0; i < 20; ++i) levels[i] = static_cast<unsigned char>(i);
+    const char encoded[] = "not really a png";
+
+    TexturePackWriter writer;
+    CHECK(writer.open(kPackPath));
+    CHECK(writer.addDecoded("decoded", levels, sizeof(levels), 2, 2, 4, 2));
+    CHECK(writer.addEncoded("dir/encoded#1", encoded, sizeof(encoded), 8, 4, 3));
+
+    // The writer refuses entries the reader would reject
+    CHECK(!writer.addDecoded("decoded", levels, sizeof(levels), 2, 2, 4, 2));   // Duplicate name
+    CHECK(!writer.addDecoded("short", levels, sizeof(levels) - 1, 2, 2, 4, 2)); // Size does not match the chain
+    CHECK(!writer.addDecoded("channels", levels, 20, 2, 2, 5, 1));
+    CHECK(!writer.addEncoded("empty", encoded, 0, 8, 4, 3));
+    CHECK(!writer.addEncoded("zero", encoded, sizeof(encoded), 0, 4, 3));
+    CHECK(!writer.addEncoded("", encoded, sizeof(encoded), 8, 4, 3));
+    CHECK(writer.getEntryCount() == 2);
+    CHECK(writer.finish());
+    CHECK(!writer.addEncoded("late", encoded, sizeof(encoded), 8, 4, 3));
+}
+
+void testRoundTrip() {
+    std::string error;
+    std::shared_ptr<TexturePack> pack = TexturePack::open(kPackPath, &error);
+    CHECK(pack != nullptr);
+    if (!pack) return;
+    CHECK(pack->getEntryCount() == 2);
+
+    long long d = pack->findEntry("decoded");
+    long long e = pack->findEntry("dir/encoded#1");
+    CHECK(d == 0 && e == 1);
+    CHECK(pack->findEntry("missing") == -1);
+
+    const PackEntry& decoded = pack->getEntry(static_cast<size_t>(d));
+    CHECK(decoded.kind == PackEntryKind::Decoded);
+    CHECK(decoded.width == 2 && decoded.height == 2 && decoded.numChannels == 4 && decoded.numMipLevels == 2);
+    CHECK(decoded.offset % kPackAlignment == 0);
+    CHECK(decoded.size == 20);
+    CHECK(pack->getPayload(decoded)[19] == 19);
+
+    const PackEntry& encoded = pack->getEntry(static_cast<size_t>(e));
+    CHECK(encoded.kind == PackEntryKind::Encoded);
+    CHECK(encoded.offset % kPackAlignment == 0);
+    CHECK(std::memcmp(pack->getPayload(encoded), "not really", 10) == 0);
+
+    TextureInfo info = TexturePack::getTextureInfo(encoded);
+    CHECK(info.isValid && info.width == 8 && info.height == 4 && info.numChannels == 3);
+
+    // Shared opens map the pack once
+    std::shared_ptr<TexturePack> a = TexturePack::openShared(kPackPath);
+    std::shared_ptr<TexturePack> b = TexturePack::openShared(kPackPath);
+    CHECK(a != nullptr && a == b);
+}
+
+void testEntryPaths() {
+    std::string packPath, entryName;
+    std::string path = TexturePack::makeEntryPath("a/b.hdpack", "dir/encoded#1");
+    CHECK(TexturePack::splitEntryPath(path, packPath, entryName));
+    CHECK(packPath == "a/b.hdpack" && entryName == "dir/encoded#1");
+    CHECK(!TexturePack::splitEntryPath("plain.png", packPath, entryName));
+    CHECK(!TexturePack::splitEntryPath("#entry", packPath, entryName));
+}
+
+void testMalformed() {
+    const std::vector<unsigned char> good = readAll(kPackPath);
+    CHECK(openPatched(good).empty());
+    const uint64_t indexOffset = getField(good, kIndexOffsetField, 8);
+    const uint64_t indexSize = getField(good, kIndexSizeField, 8);
+    CHECK(indexOffset + indexSize == good.size());
+
+    std::string error;
+    CHECK(TexturePack::open("test_texture_pack_missing.hdpack", &error) == nullptr);
+    CHECK(contains(error, "Cannot open"));
+    CHECK(contains(openPatched({}), "Empty"));
+    CHECK(contains(openPatched(std::vector<unsigned char>(good.begin(), good.begin() + 20)), "Not a texture pack"));
+
+    std::vector<unsigned char> bytes = good;
+    bytes[0] = 'X';
+    CHECK(contains(openPatched(bytes), "Not a texture pack"));
+
+    bytes = good;
+    setField(bytes, 8, 2, 4);
+    CHECK(contains(openPatched(bytes), "version"));
+
+    // File cut short: the recorded size no longer matches
+    bytes.assign(good.begin(), good.end() - 5);
+    CHECK(contains(openPatched(bytes), "Truncated"));
+
+    // Recorded size differs from the file
+    bytes = good;
+    setField(bytes, kFileSizeField, good.size() + 4096, 8);
+    CHECK(contains(openPatched(bytes), "Truncated"));
+
+    // Index past the end, including sizes that would wrap around
+    bytes = good;
+    setField(bytes, kIndexOffsetField, good.size() + 1, 8);
+    CHECK(contains(openPatched(bytes), "Truncated"));
+    bytes = good;
+    setField(bytes, kIndexSizeField, UINT64_MAX - 10, 8);
+    CHECK(contains(openPatched(bytes), "Truncated"));
+
+    // More entries claimed than the index holds
+    bytes = good;
+    setField(bytes, kCountField, 3, 4);
+    CHECK(contains(openPatched(bytes), "index"));
+
+    // Name length running past the index
+    bytes = good;
+    setField(bytes, static_cast<size_t>(indexOffset) + 30, 0xffff, 2);
+    CHECK(contains(openPatched(bytes), "index"));
+
+    const size_t entry0 = static_cast<size_t>(indexOffset);
+    // Payload reaching into the index
+    bytes = good;
+    setField(bytes, entry0 + 8, indexOffset, 8);
+    CHECK(contains(openPatched(bytes), "Corrupt entry 'decoded'"));
+    // Offset past the payload area, with a size that would wrap
+    bytes = good;
+    setField(bytes, entry0, indexOffset + 4096, 8);
+    CHECK(contains(openPatched(bytes), "Corrupt entry"));
+    bytes = good;
+    setField(bytes, entry0 + 8, UINT64_MAX, 8);
+    CHECK(contains(openPatched(bytes), "Corrupt entry"));
+    // Decoded payload too small for the claimed mip chain
+    bytes = good;
+    setField(bytes, entry0 + 26, 3, 2);
+    CHECK(contains(openPatched(bytes), "Corrupt entry"));
+    bytes = good;
+    setField(bytes, entry0 + 16, 1000, 4);
+    CHECK(contains(openPatched(bytes), "Corrupt entry"));
+    // Zero size, bad channel count, unknown kind
+    bytes = good;
+    setField(bytes, entry0 + 20, 0, 4);
+    CHECK(contains(openPatched(bytes), "Corrupt entry"));
+    bytes = good;
+    setField(bytes, entry0 + 24, 5, 2);
+    CHECK(contains(openPatched(bytes), "Corrupt entry"));
+    bytes = good;
+    bytes[entry0 + 28] = 7;
+    CHECK(contains(openPatched(bytes), "Corrupt entry"));
+
+    // Entries beyond the count are ignored
+    bytes = good;
+    setField(bytes, kCountField, 1, 4);
+    writeAll(kBadPath, bytes);
+    std::shared_ptr<TexturePack> pack = TexturePack::open(kBadPath);
+    CHECK(pack && pack->getEntryCount() == 1);
+}
+
+} // namespace
+
+int main() {
+    writeGoodPack();
+    testRoundTrip();
+    testEntryPaths();
+    testMalformed();
+    std::remove(kPackPath);
+    std::remove(kBadPath);
+    return hip_demand_test::finish("test_texture_pack");
+}
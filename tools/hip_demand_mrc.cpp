@@ -0,0 +1,326 @@
+// Computes the miss ratio curve (miss ratio and load bytes vs. texture memory
+// budget) of a loader trace (DemandTextureLoader::startTrace) in one pass.
+//
+// Uses size-aware Mattson stack distances: an access hits under an LRU budget B
+// iff the bytes of distinct textures touched since the previous access to the
+// same texture, plus its own size, fit in B. Distances come from a Fenwick tree
+// over access positions, so each access costs O(log n). For very long traces
+// SHARDS spatial sampling (--sample-rate) keeps only textures whose hashed id
+// falls under the rate and scales distances and counts back up.
+//
+// The curve reflects the access stream in the trace; record with
+// LoaderOptions::trackUsage enabled so resident hits are included.
+
+#include "DemandLoading/RequestTrace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace hip_demand;
+
+struct MrcOptions {
+    std::string tracePath;
+    double sampleRate = 1.0;   // SHARDS rate in (0, 1]
+    unsigned int points = 24;  // Budgets reported in the table
+    uint64_t maxBudget = 0;    // 0 = up to the largest observed distance
+    bool csv = false;
+};
+
+static const int kBucketsPerOctave = 32;  // ~2% budget resolution
+static const uint64_t kShardsModulus = 1u << 24;
+
+struct Histogram {
+    std::vector<uint64_t> count;
+    std::vector<uint64_t> bytes;
+
+    static int bucketOf(uint64_t distance) {
+        return distance <= 1 ? 0 : static_cast<int>(std::log2(static_cast<double>(distance)) * kBucketsPerOctave) + 1;
+    }
+    // Largest distance that falls in bucket i
+    static double upperBound(int i) {
+        return i == 0 ? 1.0 : std::exp2(static_cast<double>(i) / kBucketsPerOctave);
+    }
+
+    void add(uint64_t distance, uint64_t size) {
+        size_t i = static_cast<size_t>(bucketOf(distance));
+        if (i >= count.size()) {
+            count.resize(i + 1, 0);
+            bytes.resize(i + 1, 0);
+        }
+        count[i]++;
+        bytes[i] += size;
+    }
+};
+
+class FenwickTree {
+public:
+    explicit FenwickTree(size_t n) : tree_(n + 1, 0) {}
+
+    void add(size_t pos, int64_t delta) {
+        for (; pos < tree_.size(); pos += pos & (~pos + 1)) tree_[pos] += delta;
+    }
+    int64_t prefix(size_t pos) const {
+        int64_t sum = 0;
+        for (; pos > 0; pos -= pos & (~pos + 1)) sum += tree_[pos];
+        return sum;
+    }
+
+private:
+    std::vector<int64_t> tree_;
+};
+
+struct TraceSummary {
+    std::unordered_map<uint32_t, uint64_t> sizes;  // Device bytes per texture
+    uint64_t accesses = 0;
+    uint64_t sampledAccesses = 0;
+    uint64_t unloadableAccesses = 0;  // Textures with no known size (never loaded)
+    bool hasRecordedBudget = false;
+    uint64_t recordedBudget = 0;
+    uint64_t recordedLoads = 0;
+    uint64_t recordedLoadBytes = 0;
+};
+
+struct CurvePoint {
+    double budget = 0.0;
+    double missRatio = 0.0;
+    double misses = 0.0;
+    double loadBytes = 0.0;    // All misses, including first loads
+    double reloadBytes = 0.0;  // Misses on textures loaded before
+};
+
+static void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " <trace> [options]\n"
+              << "  --sample-rate R    SHARDS sampling rate in (0,1] (default 1 = exact)\n"
+              << "  --points N         Budgets in the table (default 24)\n"
+              << "  --max-budget-mb M  Largest budget in the table (default: largest reuse distance)\n"
+              << "  --csv              Print the curve as CSV\n";
+}
+
+static bool parseArgs(int argc, char** argv, MrcOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--sample-rate" && hasValue) {
+            opts.sampleRate = std::strtod(argv[++i], nullptr);
+            if (!(opts.sampleRate > 0.0 && opts.sampleRate <= 1.0)) return false;
+        } else if (arg == "--points" && hasValue) {
+            opts.points = std::max(2ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--max-budget-mb" && hasValue) {
+            opts.maxBudget = static_cast<uint64_t>(std::strtod(argv[++i], nullptr) * 1024.0 * 1024.0);
+        } else if (arg == "--csv") {
+            opts.csv = true;
+        } else if (!arg.empty() && arg[0] != '-' && opts.tracePath.empty()) {
+            opts.tracePath = arg;
+        } else {
+            return false;
+        }
+    }
+    return !opts.tracePath.empty();
+}
+
+// SHARDS spatial filter: a fixed pseudo-random subset of texture ids
+static bool isSampled(uint32_t id, uint64_t threshold) {
+    uint64_t h = id;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (h % kShardsModulus) < threshold;
+}
+
+// First pass: texture sizes (actual device bytes once loaded) and access counts
+static bool summarize(const MrcOptions& opts, uint64_t threshold, TraceSummary& summary) {
+    RequestTraceReader reader;
+    if (!reader.open(opts.tracePath)) {
+        std::cerr << "Cannot open trace: " << opts.tracePath << std::endl;
+        return false;
+    }
+    std::unordered_map<uint32_t, bool> measured;
+    TraceEvent e;
+    while (reader.next(e)) {
+        switch (e.type) {
+            case TraceEventType::Texture:
+                if (!measured[e.textureId]) summary.sizes[e.textureId] = e.bytes;
+                break;
+            case TraceEventType::Load:
+                if (e.success) {
+                    summary.sizes[e.textureId] = e.bytes;
+                    measured[e.textureId] = true;
+                    summary.recordedLoads++;
+                    summary.recordedLoadBytes += e.bytes;
+                }
+                break;
+            case TraceEventType::Requests:
+                for (uint32_t id : e.textureIds) {
+                    summary.accesses++;
+                    if (isSampled(id, threshold)) summary.sampledAccesses++;
+                }
+                break;
+            case TraceEventType::Budget:
+                if (!summary.hasRecordedBudget) {
+                    summary.hasRecordedBudget = true;
+                    summary.recordedBudget = e.bytes;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    if (reader.hadError()) {
+        std::cerr << "Warning: trace is truncated or malformed; using the readable prefix" << std::endl;
+    }
+
+    // Textures that never had a size (failed loads) cannot occupy the budget
+    for (auto it = summary.sizes.begin(); it != summary.sizes.end();) {
+        it = (it->second == 0) ? summary.sizes.erase(it) : std::next(it);
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    MrcOptions opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const uint64_t threshold = static_cast<uint64_t>(opts.sampleRate * kShardsModulus);
+    const double scale = 1.0 / opts.sampleRate;
+
+    TraceSummary summary;
+    if (!summarize(opts, threshold, summary)) {
+        return 1;
+    }
+
+    // Second pass: stack distances of sampled accesses
+    Histogram hist;
+    FenwickTree tree(summary.sampledAccesses);
+    std::unordered_map<uint32_t, size_t> lastPos;
+    uint64_t coldMisses = 0, coldBytes = 0, footprint = 0;
+    size_t pos = 0;
+
+    RequestTraceReader reader;
+    reader.open(opts.tracePath);
+    TraceEvent e;
+    while (reader.next(e)) {
+        if (e.type != TraceEventType::Requests) continue;
+        for (uint32_t id : e.textureIds) {
+            if (!isSampled(id, threshold)) continue;
+            auto sizeIt = summary.sizes.find(id);
+            if (sizeIt == summary.sizes.end()) {
+                summary.unloadableAccesses++;
+                continue;
+            }
+            uint64_t size = sizeIt->second;
+            pos++;
+            size_t& last = lastPos[id];
+            if (last == 0) {
+                coldMisses++;
+                coldBytes += size;
+                footprint += size;
+            } else {
+                int64_t between = tree.prefix(pos - 1) - tree.prefix(last);
+                uint64_t distance = static_cast<uint64_t>(std::llround((between + size) * scale));
+                hist.add(distance, size);
+                tree.add(last, -static_cast<int64_t>(size));
+            }
+            tree.add(pos, static_cast<int64_t>(size));
+            last = pos;
+        }
+    }
+
+    const double total = static_cast<double>(pos) * scale;
+    if (pos == 0) {
+        std::cerr << "No accesses in trace (or none sampled)" << std::endl;
+        return 1;
+    }
+
+    // Cumulative hits by bucket, so any budget is a binary search away
+    std::vector<double> cumHits(hist.count.size() + 1, 0.0), cumHitBytes(hist.count.size() + 1, 0.0);
+    uint64_t reuseBytes = 0;
+    for (size_t i = 0; i < hist.count.size(); ++i) {
+        cumHits[i + 1] = cumHits[i] + hist.count[i] * scale;
+        cumHitBytes[i + 1] = cumHitBytes[i] + hist.bytes[i] * scale;
+        reuseBytes += hist.bytes[i];
+    }
+    auto evaluate = [&](double budget) {
+        // Buckets entirely below the budget hit
+        size_t n = 0;
+        while (n < hist.count.size() && Histogram::upperBound(static_cast<int>(n)) <= budget) n++;
+        CurvePoint p;
+        p.budget = budget;
+        double hits = cumHits[n];
+        p.misses = total - hits;
+        p.missRatio = p.misses / total;
+        p.reloadBytes = reuseBytes * scale - cumHitBytes[n];
+        p.loadBytes = p.reloadBytes + coldBytes * scale;
+        return p;
+    };
+
+    // Log-spaced budgets from the smallest texture to the largest distance
+    uint64_t minSize = UINT64_MAX;
+    for (const auto& [id, size] : summary.sizes) {
+        if (size > 0) minSize = std::min(minSize, size);
+    }
+    if (minSize == UINT64_MAX) minSize = 1;
+    double largest = hist.count.empty() ? 0.0 : Histogram::upperBound(static_cast<int>(hist.count.size()) - 1);
+    double hi = opts.maxBudget ? static_cast<double>(opts.maxBudget) : std::max(largest, 2.0 * minSize);
+    double lo = static_cast<double>(std::min<uint64_t>(minSize, static_cast<uint64_t>(hi / 2)));
+    std::vector<CurvePoint> curve;
+    for (unsigned int i = 0; i < opts.points; ++i) {
+        double t = static_cast<double>(i) / (opts.points - 1);
+        curve.push_back(evaluate(lo * std::pow(hi / lo, t)));
+    }
+
+    // Knee: smallest budget within one point of the compulsory-miss floor
+    const double floorRatio = coldMisses * scale / total;
+    CurvePoint knee = evaluate(hi);
+    for (int i = 0; i <= static_cast<int>(hist.count.size()); ++i) {
+        CurvePoint p = evaluate(Histogram::upperBound(i));
+        if (p.missRatio <= floorRatio + 0.01) {
+            knee = p;
+            break;
+        }
+    }
+
+    const double MB = 1024.0 * 1024.0;
+    if (opts.csv) {
+        std::printf("budget_mb,miss_ratio,misses,load_mb,reload_mb\n");
+        for (const CurvePoint& p : curve) {
+            std::printf("%.3f,%.6f,%.0f,%.3f,%.3f\n", p.budget / MB, p.missRatio, p.misses, p.loadBytes / MB,
+                        p.reloadBytes / MB);
+        }
+        return 0;
+    }
+
+    std::printf("Trace:        %s\n", opts.tracePath.c_str());
+    std::printf("Accesses:     %llu (%llu sampled at rate %.4f, %llu to textures that never loaded)\n",
+                (unsigned long long)summary.accesses, (unsigned long long)summary.sampledAccesses, opts.sampleRate,
+                (unsigned long long)summary.unloadableAccesses);
+    std::printf("Footprint:    %.0f textures, %.2f MB\n", lastPos.size() * scale, footprint * scale / MB);
+    std::printf("Cold misses:  %.0f (%.2f%% floor)\n", coldMisses * scale, 100.0 * floorRatio);
+    std::printf("\n%14s %12s %14s %12s %12s\n", "budget (MB)", "miss ratio", "misses", "load MB", "reload MB");
+    for (const CurvePoint& p : curve) {
+        std::printf("%14.2f %11.2f%% %14.0f %12.2f %12.2f\n", p.budget / MB, 100.0 * p.missRatio, p.misses,
+                    p.loadBytes / MB, p.reloadBytes / MB);
+    }
+    std::printf("\nKnee:         %.2f MB (miss ratio %.2f%%)\n", knee.budget / MB, 100.0 * knee.missRatio);
+
+    if (summary.hasRecordedBudget) {
+        double budget = summary.recordedBudget ? static_cast<double>(summary.recordedBudget) : hi;
+        CurvePoint p = evaluate(budget);
+        std::printf("Recorded:     budget %.2f MB -> predicted %.0f loads (%.2f MB), loader did %llu loads (%.2f MB)\n",
+                    budget / MB, p.misses, p.loadBytes / MB, (unsigned long long)summary.recordedLoads,
+                    summary.recordedLoadBytes / MB);
+    }
+    return 0;
+}
@@ -0,0 +1,205 @@
+// Builds a texture pack (see ImageSource/TexturePack.h) from image files and
+// directories, or lists the entries of an existing pack.
+//
+// Entries are named by their path relative to the directory given on the
+// command line (files given directly are named by their file name). By default
+// files stb_image can decode are stored as is and decoded at load time; other
+// formats, and every file with --decoded, are stored as 8-bit pixels with the
+// full mip chain so loading is a copy out of the mapping.
+//
+// Load a pack with DemandTextureLoader::createTexturesFromPack().
+
+#include "ImageSource/ImageSource.h"
+#include "ImageSource/ImageSourceRegistry.h"
+#include "ImageSource/TextureInfo.h"
+#include "ImageSource/TexturePack.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace hip_demand;
+namespace fs = std::filesystem;
+
+struct PackOptions {
+    std::string outputPath;
+    std::string listPath;
+    std::vector<std::string> inputs;
+    bool decoded = false;
+};
+
+static void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " <output.hdpack> [options] <image or directory>...\n"
+              << "       " << argv0 << " --list <pack>\n"
+              << "  --decoded   Store pixels and mip chains instead of the encoded files\n"
+              << "  --list P    Print the entries of pack P\n";
+}
+
+static bool parseArgs(int argc, char** argv, PackOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--decoded") {
+            opts.decoded = true;
+        } else if (arg == "--list" && hasValue) {
+            opts.listPath = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-') {
+            if (opts.outputPath.empty() && opts.listPath.empty()) {
+                opts.outputPath = arg;
+            } else {
+                opts.inputs.push_back(arg);
+            }
+        } else {
+            return false;
+        }
+    }
+    if (!opts.listPath.empty()) return opts.outputPath.empty() && opts.inputs.empty();
+    return !opts.outputPath.empty() && !opts.inputs.empty();
+}
+
+// (entry name, file path) for every regular file under the inputs, in a stable order
+static std::vector<std::pair<std::string, std::string>> collectInputs(const std::vector<std::string>& inputs) {
+    std::vector<std::pair<std::string, std::string>> files;
+    for (const std::string& input : inputs) {
+        fs::path root(input);
+        std::error_code ec;
+        if (fs::is_directory(root, ec)) {
+            std::vector<std::pair<std::string, std::string>> dirFiles;
+            for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+                if (it->is_regular_file(ec)) {
+                    dirFiles.emplace_back(fs::relative(it->path(), root, ec).generic_string(), it->path().string());
+                }
+            }
+            std::sort(dirFiles.begin(), dirFiles.end());
+            std::move(dirFiles.begin(), dirFiles.end(), std::back_inserter(files));
+        } else {
+            files.emplace_back(root.filename().generic_string(), input);
+        }
+    }
+    return files;
+}
+
+static bool readWholeFile(const std::string& path, std::vector<char>& data) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+// Open a file with the best reader that accepts it
+static std::unique_ptr<ImageSource> openImage(const std::string& path, const ImageSourceSniff& sniff,
+                                              std::string& readerName, TextureInfo& info) {
+    for (const std::string& reader : sniff.readers) {
+        try {
+            std::unique_ptr<ImageSource> source = createImageSource(path, reader);
+            if (!source) continue;
+            source->open(&info);
+            if (source->isOpen() && info.isValid && info.numChannels > 0) {
+                readerName = reader;
+                return source;
+            }
+        } catch (const std::exception&) {
+        }
+    }
+    return nullptr;
+}
+
+// Every mip level as 8-bit pixels, level 0 first
+static bool readMipChain(ImageSource& source, const TextureInfo& info, std::vector<char>& levels) {
+    levels.clear();
+    for (unsigned int level = 0; level < info.numMipLevels; ++level) {
+        unsigned int w = getMipLevelDimension(info.width, level);
+        unsigned int h = getMipLevelDimension(info.height, level);
+        size_t offset = levels.size();
+        levels.resize(offset + static_cast<size_t>(w) * h * info.numChannels);
+        if (!source.readMipLevel(levels.data() + offset, level, w, h)) return false;
+    }
+    return true;
+}
+
+static int listPack(const std::string& path) {
+    std::string error;
+    std::shared_ptr<TexturePack> pack = TexturePack::open(path, &error);
+    if (!pack) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    uint64_t payloadBytes = 0;
+    for (size_t i = 0; i < pack->getEntryCount(); ++i) {
+        const PackEntry& e = pack->getEntry(i);
+        payloadBytes += e.size;
+        std::cout << std::setw(10) << e.size << "  " << std::setw(5) << e.width << "x" << std::left
+                  << std::setw(5) << e.height << std::right << "  ch=" << e.numChannels
+                  << (e.kind == PackEntryKind::Encoded ? "  encoded   " : "  decoded   ")
+                  << "mips=" << std::setw(2) << e.numMipLevels << "  " << e.name << "\n";
+    }
+    std::cout << pack->getEntryCount() << " entries, " << payloadBytes << " payload bytes" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    PackOptions opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!opts.listPath.empty()) {
+        return listPack(opts.listPath);
+    }
+
+    TexturePackWriter writer;
+    if (!writer.open(opts.outputPath)) {
+        std::cerr << "Cannot create pack: " << opts.outputPath << std::endl;
+        return 1;
+    }
+
+    size_t skipped = 0, encoded = 0, decoded = 0;
+    uint64_t inputBytes = 0;
+    std::vector<char> data;
+    for (const auto& [name, path] : collectInputs(opts.inputs)) {
+        ImageSourceSniff sniff = sniffImageSource(path);
+        std::string readerName;
+        TextureInfo info;
+        std::unique_ptr<ImageSource> source = sniff.readable ? openImage(path, sniff, readerName, info) : nullptr;
+        if (!source) {
+            std::cerr << "Skipping " << path << ": not a readable image" << std::endl;
+            skipped++;
+            continue;
+        }
+
+        bool ok = false;
+        if (!opts.decoded && readerName == "stb" && readWholeFile(path, data)) {
+            ok = writer.addEncoded(name, data.data(), data.size(), info.width, info.height, info.numChannels);
+            encoded += ok ? 1 : 0;
+        } else if (readMipChain(*source, info, data)) {
+            ok = writer.addDecoded(name, data.data(), data.size(), info.width, info.height, info.numChannels,
+                                   info.numMipLevels);
+            decoded += ok ? 1 : 0;
+        }
+        source->close();
+        if (!ok) {
+            std::cerr << "Cannot add " << path << " as '" << name << "' (decode failed or duplicate name)" << std::endl;
+            return 1;
+        }
+        std::error_code ec;
+        inputBytes += fs::file_size(path, ec);
+    }
+
+    if (!writer.finish()) {
+        std::cerr << "Failed writing pack: " << opts.outputPath << std::endl;
+        return 1;
+    }
+    std::error_code ec;
+    std::cout << "Packed " << writer.getEntryCount() << " images (" << encoded << " encoded, " << decoded
+              << " decoded, " << skipped << " skipped) from " << inputBytes << " bytes into "
+              << fs::file_size(opts.outputPath, ec) << " bytes: " << opts.outputPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,357 @@
+// Replays a loader trace (DemandTextureLoader::startTrace) against a host-side
+// model of the loader's residency policy: same request deduplication, budget
+// check and LRU eviction, with loads spread over a worker pool. No GPU needed.
+//
+// Image I/O is either simulated from the load times recorded in the trace, or
+// real (files are decoded again through ImageSource). Reports load counts,
+// bytes, stall time and miss rates for the chosen configuration.
+
+#include "DemandLoading/RequestTrace.h"
+#include "ImageSource/ImageSource.h"
+#include "ImageSource/ImageSourceRegistry.h"
+#include "ImageSource/TextureInfo.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace hip_demand;
+
+struct ReplayOptions {
+    std::string tracePath;
+    size_t budgetBytes = 2ULL * 1024 * 1024 * 1024;  // LoaderOptions default
+    bool budgetSet = false;                          // Otherwise the recorded budget is used
+    unsigned int threads = 0;                        // 0 = auto
+    bool enableEviction = true;
+    bool realIO = false;
+    bool csv = false;
+    double costMicrosPerMB = 0.0;  // Load cost when the trace has no recorded loads to scale from
+};
+
+struct TextureModel {
+    std::string filename;
+    uint64_t bytes = 0;        // Device bytes when resident
+    uint64_t loadMicros = 0;   // Sum of recorded successful load times
+    uint32_t loadCount = 0;    // Recorded successful loads
+    uint32_t failCount = 0;    // Recorded failed loads
+    bool resident = false;
+    bool everLoaded = false;
+    uint32_t lastUsedFrame = 0;
+};
+
+struct ReplayStats {
+    uint64_t frames = 0;          // Frames with at least one request
+    uint64_t requests = 0;        // Unique texture requests summed over frames
+    uint64_t misses = 0;
+    uint64_t loads = 0;
+    uint64_t failedLoads = 0;
+    uint64_t reloads = 0;         // Loads of textures evicted earlier in the replay
+    uint64_t bytesLoaded = 0;
+    uint64_t evictions = 0;
+    uint64_t bytesEvicted = 0;
+    uint64_t peakMemory = 0;
+    double stallMs = 0.0;
+    double maxFrameStallMs = 0.0;
+
+    // Production run, as recorded in the trace
+    uint64_t recordedLoads = 0;
+    uint64_t recordedBytesLoaded = 0;
+    uint64_t recordedEvictions = 0;
+    double recordedLoadMs = 0.0;
+    bool hasRecordedBudget = false;
+    uint64_t recordedBudget = 0;  // First budget in the trace
+};
+
+static void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " <trace> [options]\n"
+              << "  --budget-mb N    Texture memory budget in MB (0 = unlimited, default: as recorded)\n"
+              << "  --threads N      Load worker threads (0 = auto, default)\n"
+              << "  --no-eviction    Disable eviction\n"
+              << "  --io sim|real    Simulate loads from recorded times (default) or decode files\n"
+              << "  --cost-us-per-mb X  Simulated load cost if the trace has no recorded loads (e.g. synthetic)\n"
+              << "  --csv            Print one CSV line instead of a report\n";
+}
+
+static bool parseArgs(int argc, char** argv, ReplayOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--budget-mb" && hasValue) {
+            opts.budgetBytes = static_cast<size_t>(std::strtod(argv[++i], nullptr) * 1024.0 * 1024.0);
+            opts.budgetSet = true;
+        } else if (arg == "--threads" && hasValue) {
+            opts.threads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--no-eviction") {
+            opts.enableEviction = false;
+        } else if (arg == "--io" && hasValue) {
+            std::string mode = argv[++i];
+            if (mode != "sim" && mode != "real") return false;
+            opts.realIO = (mode == "real");
+        } else if (arg == "--cost-us-per-mb" && hasValue) {
+            opts.costMicrosPerMB = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--csv") {
+            opts.csv = true;
+        } else if (!arg.empty() && arg[0] != '-' && opts.tracePath.empty()) {
+            opts.tracePath = arg;
+        } else {
+            return false;
+        }
+    }
+    if (opts.threads == 0) {
+        opts.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return !opts.tracePath.empty();
+}
+
+// First pass: texture sizes and recorded load costs
+static bool buildModel(const std::string& path, std::unordered_map<uint32_t, TextureModel>& textures,
+                       ReplayStats& stats) {
+    RequestTraceReader reader;
+    if (!reader.open(path)) {
+        std::cerr << "Cannot open trace: " << path << std::endl;
+        return false;
+    }
+    TraceEvent e;
+    while (reader.next(e)) {
+        if (e.type == TraceEventType::Texture) {
+            TextureModel& t = textures[e.textureId];
+            t.filename = e.filename;
+            if (t.loadCount == 0) t.bytes = e.bytes;
+        } else if (e.type == TraceEventType::Load) {
+            TextureModel& t = textures[e.textureId];
+            if (e.success) {
+                t.bytes = e.bytes;  // Actual device size beats the estimate
+                t.loadMicros += e.micros;
+                t.loadCount++;
+                stats.recordedLoads++;
+                stats.recordedBytesLoaded += e.bytes;
+            } else {
+                t.failCount++;
+            }
+            stats.recordedLoadMs += e.micros / 1000.0;
+        } else if (e.type == TraceEventType::Evict) {
+            stats.recordedEvictions++;
+        } else if (e.type == TraceEventType::Budget && !stats.hasRecordedBudget) {
+            stats.hasRecordedBudget = true;
+            stats.recordedBudget = e.bytes;
+        }
+    }
+    if (reader.hadError()) {
+        std::cerr << "Warning: trace is truncated or malformed; replaying the readable prefix" << std::endl;
+    }
+    return true;
+}
+
+// Decode level 0 of a file the way the loader does; unreadable files cost only the failed open
+static void decodeFile(const std::string& filename) {
+    try {
+        std::unique_ptr<ImageSource> src = createImageSource(filename);
+        if (!src) return;
+        TextureInfo info;
+        src->open(&info);
+        if (!info.isValid) return;
+        std::vector<char> pixels(static_cast<size_t>(info.width) * info.height * info.numChannels *
+                                 getBytesPerChannel(info.format));
+        src->readMipLevel(pixels.data(), 0, info.width, info.height);
+    } catch (const std::exception&) {
+    }
+}
+
+class ResidencyModel {
+public:
+    ResidencyModel(const ReplayOptions& opts, std::unordered_map<uint32_t, TextureModel>& textures)
+        : opts_(opts), textures_(textures) {
+        uint64_t micros = 0, bytes = 0;
+        for (const auto& [id, t] : textures_) {
+            if (t.loadCount > 0) {
+                micros += t.loadMicros;
+                bytes += t.bytes * t.loadCount;
+            }
+        }
+        // Cost of textures never loaded in the recorded run, scaled by size
+        microsPerByte_ = bytes > 0 ? static_cast<double>(micros) / bytes : opts_.costMicrosPerMB / (1024.0 * 1024.0);
+    }
+
+    void replayFrame(uint32_t frame, const std::vector<uint32_t>& requested, ReplayStats& stats) {
+        std::vector<uint32_t> toLoad;
+        uint64_t required = 0;
+        std::unordered_set<uint32_t> seen;
+        for (uint32_t id : requested) {
+            auto it = textures_.find(id);
+            if (it == textures_.end() || !seen.insert(id).second) continue;
+            stats.requests++;
+            TextureModel& t = it->second;
+            if (t.resident) {
+                // Sampled while resident: refresh LRU age as the loader does with usage tracking
+                lru_.erase({t.lastUsedFrame, id});
+                t.lastUsedFrame = frame;
+                lru_.insert({frame, id});
+                continue;
+            }
+            stats.misses++;
+            toLoad.push_back(id);
+            required += t.bytes;
+        }
+        stats.frames++;
+        if (toLoad.empty()) return;
+
+        if (opts_.enableEviction && opts_.budgetBytes > 0 && required > 0) {
+            evictIfNeeded(required, stats);
+        }
+
+        double frameMs = opts_.realIO ? loadReal(toLoad) : loadSimulated(toLoad);
+        for (uint32_t id : toLoad) {
+            TextureModel& t = textures_[id];
+            if (t.loadCount == 0 && t.failCount > 0) {
+                stats.failedLoads++;
+                continue;
+            }
+            if (t.everLoaded) stats.reloads++;
+            t.resident = true;
+            t.everLoaded = true;
+            t.lastUsedFrame = frame;
+            lru_.insert({frame, id});
+            memory_ += t.bytes;
+            stats.loads++;
+            stats.bytesLoaded += t.bytes;
+        }
+        stats.peakMemory = std::max(stats.peakMemory, memory_);
+        stats.stallMs += frameMs;
+        stats.maxFrameStallMs = std::max(stats.maxFrameStallMs, frameMs);
+    }
+
+private:
+    void evictIfNeeded(uint64_t required, ReplayStats& stats) {
+        if (memory_ + required <= opts_.budgetBytes) return;
+        uint64_t target = required < opts_.budgetBytes ? opts_.budgetBytes - required : 0;
+        while (memory_ > target && !lru_.empty()) {
+            uint32_t id = lru_.begin()->second;
+            lru_.erase(lru_.begin());
+            TextureModel& t = textures_[id];
+            t.resident = false;
+            memory_ -= t.bytes;
+            stats.evictions++;
+            stats.bytesEvicted += t.bytes;
+        }
+    }
+
+    double costMs(const TextureModel& t) const {
+        if (t.loadCount > 0) return t.loadMicros / (1000.0 * t.loadCount);
+        return t.bytes * microsPerByte_ / 1000.0;
+    }
+
+    // Loads are taken in order by whichever worker frees up first, as with the loader's pool
+    double loadSimulated(const std::vector<uint32_t>& toLoad) const {
+        std::priority_queue<double, std::vector<double>, std::greater<double>> workers;
+        for (unsigned int i = 0; i < opts_.threads; ++i) workers.push(0.0);
+        double makespan = 0.0;
+        for (uint32_t id : toLoad) {
+            double finish = workers.top() + costMs(textures_.at(id));
+            workers.pop();
+            workers.push(finish);
+            makespan = std::max(makespan, finish);
+        }
+        return makespan;
+    }
+
+    double loadReal(const std::vector<uint32_t>& toLoad) const {
+        auto start = std::chrono::steady_clock::now();
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i; (i = next.fetch_add(1)) < toLoad.size();) {
+                const TextureModel& t = textures_.at(toLoad[i]);
+                if (!t.filename.empty()) decodeFile(t.filename);
+            }
+        };
+        std::vector<std::thread> pool;
+        size_t helpers = std::min<size_t>(opts_.threads, toLoad.size()) - 1;
+        for (size_t i = 0; i < helpers; ++i) pool.emplace_back(worker);
+        worker();
+        for (std::thread& th : pool) th.join();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const ReplayOptions& opts_;
+    std::unordered_map<uint32_t, TextureModel>& textures_;
+    std::set<std::pair<uint32_t, uint32_t>> lru_;  // (lastUsedFrame, id) of resident textures
+    uint64_t memory_ = 0;
+    double microsPerByte_ = 0.0;
+};
+
+static double toMB(uint64_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+static void printReport(const ReplayOptions& opts, size_t textureCount, const ReplayStats& s) {
+    double missRate = s.requests ? 100.0 * s.misses / s.requests : 0.0;
+    if (opts.csv) {
+        std::printf("budget_mb,threads,eviction,io,frames,requests,misses,miss_rate,loads,failed,reloads,"
+                    "mb_loaded,evictions,mb_evicted,peak_mb,stall_ms,max_frame_stall_ms\n");
+        std::printf("%.2f,%u,%d,%s,%llu,%llu,%llu,%.4f,%llu,%llu,%llu,%.2f,%llu,%.2f,%.2f,%.3f,%.3f\n",
+                    toMB(opts.budgetBytes), opts.threads, opts.enableEviction ? 1 : 0, opts.realIO ? "real" : "sim",
+                    (unsigned long long)s.frames, (unsigned long long)s.requests, (unsigned long long)s.misses,
+                    missRate / 100.0, (unsigned long long)s.loads, (unsigned long long)s.failedLoads,
+                    (unsigned long long)s.reloads, toMB(s.bytesLoaded), (unsigned long long)s.evictions,
+                    toMB(s.bytesEvicted), toMB(s.peakMemory), s.stallMs, s.maxFrameStallMs);
+        return;
+    }
+
+    std::printf("Trace:        %s (%zu textures, %llu frames with requests)\n", opts.tracePath.c_str(),
+                textureCount, (unsigned long long)s.frames);
+    char budget[32] = "unlimited";
+    if (opts.budgetBytes) std::snprintf(budget, sizeof(budget), "%.2f MB", toMB(opts.budgetBytes));
+    std::printf("Config:       budget %s, %u threads, eviction %s, %s I/O\n", budget, opts.threads, opts.enableEviction ? "on" : "off", opts.realIO ? "real" : "simulated");
+    std::printf("Requests:     %llu unique per frame, %llu misses (%.2f%% miss rate)\n",
+                (unsigned long long)s.requests, (unsigned long long)s.misses, missRate);
+    std::printf("Loads:        %llu (%llu failed, %llu reloads), %.2f MB\n", (unsigned long long)s.loads,
+                (unsigned long long)s.failedLoads, (unsigned long long)s.reloads, toMB(s.bytesLoaded));
+    std::printf("Evictions:    %llu, %.2f MB\n", (unsigned long long)s.evictions, toMB(s.bytesEvicted));
+    std::printf("Peak memory:  %.2f MB\n", toMB(s.peakMemory));
+    std::printf("Stall:        %.2f ms total, %.3f ms/frame mean, %.3f ms max\n", s.stallMs,
+                s.frames ? s.stallMs / s.frames : 0.0, s.maxFrameStallMs);
+    std::printf("Recorded:     %llu loads, %.2f MB, %llu evictions, %.2f ms load time\n",
+                (unsigned long long)s.recordedLoads, toMB(s.recordedBytesLoaded),
+                (unsigned long long)s.recordedEvictions, s.recordedLoadMs);
+}
+
+int main(int argc, char** argv) {
+    ReplayOptions opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::unordered_map<uint32_t, TextureModel> textures;
+    ReplayStats stats;
+    if (!buildModel(opts.tracePath, textures, stats)) {
+        return 1;
+    }
+    if (!opts.budgetSet && stats.hasRecordedBudget) {
+        opts.budgetBytes = stats.recordedBudget;
+    }
+
+    ResidencyModel model(opts, textures);
+    RequestTraceReader reader;
+    reader.open(opts.tracePath);
+    TraceEvent e;
+    while (reader.next(e)) {
+        if (e.type == TraceEventType::Requests) {
+            model.replayFrame(e.frame, e.textureIds, stats);
+        }
+    }
+
+    printReport(opts, textures.size(), stats);
+    return 0;
+}
@@ -0,0 +1,159 @@
+// Measures what launchPrepare() uploads per frame with the two-level residency
+// bitmap, against the flat upload of every flag word and texture object, as
+// maxTextures grows.
+//
+// Drives the loader's ResidencyBitmap directly, so no GPU is needed: each
+// frame loads and evicts a few random textures, then takes the changed blocks
+// the way launchPrepare() does (at most 16 coalesced runs) and counts the
+// bytes of their flag words, summary words and texture objects.
+
+#include "DemandLoading/ResidencyBitmap.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace hip_demand;
+
+struct BenchOptions {
+    std::vector<size_t> maxTextures = {4096, 65536, 1048576, 4194304};
+    size_t created = 262144;         // Textures the application creates; ids are [0, created)
+    double residentFraction = 0.01;  // Of the created textures
+    unsigned int changes = 64;       // Residency changes per frame, half loads, half evictions
+    unsigned int frames = 200;
+    unsigned int seed = 1;
+};
+
+static const size_t kMaxTransferRuns = 16;  // As in DemandTextureLoader
+static const size_t kTextureObjectBytes = 8;
+
+static void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options]\n"
+              << "  --max-textures a,b,...  Table sizes to measure (default 4096,65536,1048576,4194304)\n"
+              << "  --created N             Textures created, capped by each size (default 262144)\n"
+              << "  --resident F            Resident fraction of the created textures (default 0.01)\n"
+              << "  --changes N             Loads plus evictions per frame (default 64)\n"
+              << "  --frames N              (default 200)\n"
+              << "  --seed N                (default 1)\n";
+}
+
+static bool parseArgs(int argc, char** argv, BenchOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--max-textures" && hasValue) {
+            opts.maxTextures.clear();
+            std::string list = argv[++i];
+            for (size_t pos = 0; pos < list.size();) {
+                size_t end = list.find(',', pos);
+                if (end == std::string::npos) end = list.size();
+                size_t n = std::strtoull(list.substr(pos, end - pos).c_str(), nullptr, 10);
+                if (n == 0) return false;
+                opts.maxTextures.push_back(n);
+                pos = end + 1;
+            }
+        } else if (arg == "--created" && hasValue) {
+            opts.created = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--resident" && hasValue) {
+            opts.residentFraction = std::strtod(argv[++i], nullptr);
+            if (!(opts.residentFraction > 0.0 && opts.residentFraction < 1.0)) return false;
+        } else if (arg == "--changes" && hasValue) {
+            opts.changes = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--frames" && hasValue) {
+            opts.frames = std::max(1u, static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10)));
+        } else if (arg == "--seed" && hasValue) {
+            opts.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            return false;
+        }
+    }
+    return !opts.maxTextures.empty() && opts.created > 0;
+}
+
+// Bytes launchPrepare() copies for one run: flag words, summary words, texture objects
+static size_t runBytes(const ResidencyBitmap& bitmap, const ResidencyBitmap::Run& run, size_t maxTextures) {
+    size_t words = std::min(run.blockCount * 32, bitmap.wordCount() - run.firstBlock * 32);
+    size_t firstTex = run.firstBlock * ResidencyBitmap::kTexturesPerBlock;
+    size_t texCount = std::min(run.blockCount * ResidencyBitmap::kTexturesPerBlock, maxTextures - firstTex);
+    return words * sizeof(uint32_t) + run.blockCount * sizeof(uint32_t) + texCount * kTextureObjectBytes;
+}
+
+static void measure(size_t maxTextures, const BenchOptions& opts) {
+    using Clock = std::chrono::steady_clock;
+    std::mt19937 rng(opts.seed);
+    size_t created = std::min(opts.created, maxTextures);
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(created - 1));
+
+    std::vector<uint32_t> words(ResidencyBitmap::wordCountFor(maxTextures));
+    std::vector<uint32_t> summary(ResidencyBitmap::summaryCountFor(maxTextures));
+    ResidencyBitmap bitmap;
+    bitmap.attach(words.data(), summary.data(), maxTextures);
+
+    // Warm up to the resident fraction; the first upload covers it
+    std::vector<uint32_t> resident;
+    size_t target = std::max<size_t>(1, static_cast<size_t>(created * opts.residentFraction));
+    while (bitmap.count() < target) {
+        uint32_t id = pick(rng);
+        if (!(words[id >> 5] & (1u << (id & 31)))) {
+            bitmap.set(id);
+            resident.push_back(id);
+        }
+    }
+    std::vector<ResidencyBitmap::Run> runs;
+    bitmap.takeDirtyRuns(runs, kMaxTransferRuns);
+
+    size_t bytes = 0;
+    size_t copies = 0;
+    double takeMs = 0.0;
+    for (unsigned int f = 0; f < opts.frames; ++f) {
+        for (unsigned int c = 0; c < opts.changes; ++c) {
+            if (c % 2 == 0 || resident.empty()) {
+                uint32_t id = pick(rng);
+                while (words[id >> 5] & (1u << (id & 31))) id = pick(rng);
+                bitmap.set(id);
+                resident.push_back(id);
+            } else {
+                size_t i = rng() % resident.size();
+                bitmap.clear(resident[i]);
+                resident[i] = resident.back();
+                resident.pop_back();
+            }
+        }
+        auto start = Clock::now();
+        bitmap.takeDirtyRuns(runs, kMaxTransferRuns);
+        takeMs += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        for (const ResidencyBitmap::Run& run : runs) {
+            bytes += runBytes(bitmap, run, maxTextures);
+        }
+        copies += runs.size() * 3;
+    }
+
+    size_t enumerated = 0;
+    auto start = Clock::now();
+    bitmap.forEach([&](uint32_t) { enumerated++; });
+    double enumMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    size_t flat = words.size() * sizeof(uint32_t) + maxTextures * kTextureObjectBytes;
+    std::printf("%12zu %10zu %14.1f %12.1f %12.1f %12.4f %12.4f\n", maxTextures, enumerated,
+                static_cast<double>(bytes) / 1024.0 / opts.frames, static_cast<double>(flat) / 1024.0,
+                static_cast<double>(copies) / opts.frames, takeMs / opts.frames, enumMs);
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::printf("%12s %10s %14s %12s %12s %12s %12s\n", "maxTextures", "resident", "upload KB/fr",
+                "flat KB/fr", "copies/fr", "plan ms/fr", "enum ms");
+    for (size_t n : opts.maxTextures) {
+        measure(n, opts);
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Generates a synthetic texture corpus and access stream for load testing.
+//
+// Writes the image files (optional), a manifest listing the textures in id
+// order, and a request trace that hip_demand_replay and hip_demand_mrc accept.
+// An application that creates the manifest's textures in order gets the same
+// ids as the trace.
+
+#include "Workload/WorkloadGenerator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace hip_demand;
+
+struct WorkloadOptions {
+    CorpusSpec corpus;
+    AccessSpec access;
+    std::string tracePath = "workload.trace";
+    std::string manifestPath = "workload.manifest";
+    bool writeImages = true;
+    unsigned int threads = 0;
+};
+
+static void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options]\n"
+              << "Corpus:\n"
+              << "  --textures N         Number of textures (default 10000)\n"
+              << "  --sizes fixed|loguniform|weighted\n"
+              << "  --min-size N         Smallest edge, power of two (default 64)\n"
+              << "  --max-size N         Largest edge, power of two (default 2048)\n"
+              << "  --size-weights a,b,c Weights per octave from min-size up (implies --sizes weighted)\n"
+              << "  --wide F             Fraction of 2:1 textures (default 0.1)\n"
+              << "  --channels 1,3,4     Channel counts to pick from (default 3,4)\n"
+              << "  --format png|tga|bmp|jpg\n"
+              << "  --files-per-class K  Share K files per size/channel class (default 0 = one per texture)\n"
+              << "  --tiles-per-asset N  UDIM tiles per asset (default 10)\n"
+              << "  --dir PATH           Output directory for images (default synthetic)\n"
+              << "  --no-images          Only write the manifest and trace\n"
+              << "Access stream:\n"
+              << "  --pattern uniform|zipf|flythrough|udim\n"
+              << "  --frames N           (default 1000)\n"
+              << "  --accesses N         Draws per frame before dedup (default 256)\n"
+              << "  --zipf S             Zipf exponent (default 1.0)\n"
+              << "  --shot-length N      Frames per shot, 0 = no cuts (default 0)\n"
+              << "  --view-radius R      Flythrough visible radius (default 0.05)\n"
+              << "  --camera-speed V     Flythrough speed per frame (default 0.002)\n"
+              << "Output:\n"
+              << "  --trace PATH         (default workload.trace)\n"
+              << "  --manifest PATH      (default workload.manifest)\n"
+              << "  --seed N             Seed for corpus and stream (default 1)\n"
+              << "  --threads N          Image writer threads (default auto)\n";
+}
+
+template <typename T>
+static std::vector<T> parseList(const std::string& text) {
+    std::vector<T> values;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) values.push_back(static_cast<T>(std::strtod(item.c_str(), nullptr)));
+    }
+    return values;
+}
+
+static bool parseArgs(int argc, char** argv, WorkloadOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        std::string value = hasValue ? argv[i + 1] : "";
+        auto u32 = [&]() { ++i; return static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10)); };
+        auto f64 = [&]() { ++i; return std::strtod(value.c_str(), nullptr); };
+
+        if (arg == "--no-images") {
+            opts.writeImages = false;
+        } else if (!hasValue) {
+            return false;
+        } else if (arg == "--textures") {
+            opts.corpus.textureCount = u32();
+        } else if (arg == "--sizes") {
+            ++i;
+            if (value == "fixed") opts.corpus.sizeDistribution = SizeDistribution::Fixed;
+            else if (value == "loguniform") opts.corpus.sizeDistribution = SizeDistribution::LogUniform;
+            else if (value == "weighted") opts.corpus.sizeDistribution = SizeDistribution::Weighted;
+            else return false;
+        } else if (arg == "--min-size") {
+            opts.corpus.minSize = u32();
+        } else if (arg == "--max-size") {
+            opts.corpus.maxSize = u32();
+        } else if (arg == "--size-weights") {
+            ++i;
+            opts.corpus.sizeWeights = parseList<double>(value);
+            opts.corpus.sizeDistribution = SizeDistribution::Weighted;
+        } else if (arg == "--wide") {
+            opts.corpus.wideFraction = f64();
+        } else if (arg == "--channels") {
+            ++i;
+            opts.corpus.channels = parseList<uint32_t>(value);
+            for (uint32_t c : opts.corpus.channels) {
+                if (c < 1 || c > 4) return false;
+            }
+        } else if (arg == "--format") {
+            ++i;
+            if (value == "png") opts.corpus.format = SyntheticImageFormat::PNG;
+            else if (value == "tga") opts.corpus.format = SyntheticImageFormat::TGA;
+            else if (value == "bmp") opts.corpus.format = SyntheticImageFormat::BMP;
+            else if (value == "jpg") opts.corpus.format = SyntheticImageFormat::JPG;
+            else return false;
+        } else if (arg == "--files-per-class") {
+            opts.corpus.filesPerClass = u32();
+        } else if (arg == "--tiles-per-asset") {
+            opts.corpus.tilesPerAsset = u32();
+        } else if (arg == "--dir") {
+            ++i;
+            opts.corpus.directory = value;
+        } else if (arg == "--pattern") {
+            ++i;
+            if (value == "uniform") opts.access.pattern = AccessPattern::Uniform;
+            else if (value == "zipf") opts.access.pattern = AccessPattern::Zipf;
+            else if (value == "flythrough") opts.access.pattern = AccessPattern::Flythrough;
+            else if (value == "udim") opts.access.pattern = AccessPattern::Udim;
+            else return false;
+        } else if (arg == "--frames") {
+            opts.access.frames = u32();
+        } else if (arg == "--accesses") {
+            opts.access.accessesPerFrame = u32();
+        } else if (arg == "--zipf") {
+            opts.access.zipfExponent = f64();
+        } else if (arg == "--shot-length") {
+            opts.access.shotLength = u32();
+        } else if (arg == "--view-radius") {
+            opts.access.viewRadius = f64();
+        } else if (arg == "--camera-speed") {
+            opts.access.cameraSpeed = f64();
+        } else if (arg == "--trace") {
+            ++i;
+            opts.tracePath = value;
+        } else if (arg == "--manifest") {
+            ++i;
+            opts.manifestPath = value;
+        } else if (arg == "--seed") {
+            ++i;
+            opts.corpus.seed = opts.access.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--threads") {
+            opts.threads = u32();
+        } else {
+            return false;
+        }
+    }
+    return opts.corpus.textureCount > 0;
+}
+
+int main(int argc, char** argv) {
+    WorkloadOptions opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SyntheticTexture> corpus = generateCorpus(opts.corpus);
+
+    uint64_t totalBytes = 0;
+    for (const SyntheticTexture& tex : corpus) {
+        totalBytes += estimateTextureBytes(tex.width, tex.height);
+    }
+    std::printf("Corpus:    %zu textures, %.2f MB on device if all resident\n", corpus.size(),
+                totalBytes / (1024.0 * 1024.0));
+
+    if (opts.writeImages) {
+        std::string error;
+        size_t written = writeCorpusImages(corpus, opts.corpus.format, opts.threads, &error);
+        std::printf("Images:    %zu files written to %s\n", written, opts.corpus.directory.c_str());
+        if (!error.empty()) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    if (!writeCorpusManifest(opts.manifestPath, corpus)) {
+        std::cerr << "Cannot write manifest: " << opts.manifestPath << std::endl;
+        return 1;
+    }
+    std::printf("Manifest:  %s\n", opts.manifestPath.c_str());
+
+    AccessGenerator access(opts.access, corpus);
+    if (!writeWorkloadTrace(opts.tracePath, corpus, access)) {
+        std::cerr << "Cannot write trace: " << opts.tracePath << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("Trace:     %s (%u frames)\n", opts.tracePath.c_str(), access.getFrame());
+    std::printf("Done in %.2f s\n", seconds);
+    return 0;
+}